@@ -1,119 +1,325 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "graph.h"
-#define MAX_READ_LINE 10000
 
-typedef int t_bool;
+/*
+  Composantes fortement connexes d'un graphe (module graph.c, graph_scc)
 
-// Variables globales
-int order[MAX_READ_LINE]; 
-int step;
+  Compilation :
+    gcc -Wall -Wextra -std=c11 -O2 -pthread CFC_graphe.c graph.c -o CFC_graphe
 
-// Prototypes : la signature a changé car "graph.h" "renvoie" un graphe de type t_graph* et non plus comme dans l'énoncé 
-int Kosaraju_1_recur(t_graph *g, int x, t_bool marking[], int order[], int step);
-void Kosaraju_1(t_graph *g);
-int Kosaraju_2_recur(t_graph *g, int x, t_bool marking[]);
-void Kosaraju_2(t_graph *g, int order[]);
-void enum_cfc_kosaraju(t_graph *g);
+  Les CFC sont calculées par graph_scc (Kosaraju itératif, numéros dans l'ordre
+  topologique du graphe des composantes) puis écrites par graph_write_scc.
 
-int main(){
-    // Lecture du graphe depuis fichier
-    t_graph *g = graph_read_format1(".txt", 0); // Changer le chemin du fichier selon l'emplacement. Changer la valeur: 1 matrice d'adjacence et 0 liste d'adjacence
+  Cache : pour un fichier d'entrée unique, le résultat est enregistré dans
+  <fichier>.scc (ou dans le dossier -cache-dir), avec l'empreinte du contenu.
+  Si le fichier n'a pas changé, les lancements suivants reprennent les CFC du
+  cache sans relire ni recalculer le graphe.
 
-    enum_cfc_kosaraju(g);
-    return 0;
-}
-
-// Fonction principale Kosaraju
-void enum_cfc_kosaraju(t_graph *g){
-    int n = graph_size(g);
-    Kosaraju_1(g);
-
-    // Construction du graphe transposé
-    t_graph *gi = graph_new(n, 0, 1); 
-    for(int i=0;i<n;i++){
-        for(int j=0;j<n;j++){
-            if(graph_has_edge(g,i,j)==1){
-                graph_add_edge(gi,j,i); 
-            }
-        }
-    }
-    Kosaraju_2(gi, order);
+  Mode externe (-external, -mem) : les arêtes sont triées sur disque dans un
+  fichier binaire, puis graph_scc_external calcule les CFC par passes
+  séquentielles sur ce fichier, avec seulement O(V) en mémoire. Les CFC sont
+  alors numérotées dans l'ordre de leur plus petit sommet ; -verify les compare
+  au calcul en mémoire. Le nombre de passes croît avec la profondeur du graphe
+  des CFC : au-delà de -max-passes, le calcul s'arrête avec un message.
 
+  Instrumentation (optionnelle) : ajouter -DGRAPH_STATS puis lancer avec GRAPH_STATS=1
+*/
 
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-i <fichier>]... [-f 1|2|bin] [-j n] [-repr list|matrix|csr|auto] [-o <sortie>] [-format text|csv|json|bin] [-top k] [-hist]\n"
+            "       [-cache-dir <dossier>] [-no-cache] [-clear-cache] [-external] [-mem <taille>] [-edges <fichier>] [-verify]\n"
+            "       [-max-passes n]\n"
+            "  -i <fichier>     : graphe en entree (defaut: stdin) ; au format 1, -i peut etre\n"
+            "                     repete : les fichiers sont lus en parallele et reunis\n"
+            "  -f 1|2|bin       : format du graphe, numeros, noms ou binaire (defaut: 1)\n"
+            "  -j n             : fils de lecture pour plusieurs -i (defaut: un par processeur)\n"
+            "  -repr <r>        : representation interne, list, matrix, csr ou auto (defaut: auto)\n"
+            "  -o <sortie>      : fichier des CFC (defaut: stdout)\n"
+            "  -format ...      : text (une CFC par ligne, avec les noms), csv (vertex,component),\n"
+            "                     json, bin (tableau brut d'int32 : numero de CFC de chaque sommet)\n"
+            "  -top k           : seulement les k plus grandes CFC\n"
+            "  -hist            : histogramme des tailles sur stderr\n"
+            "  -cache-dir <d>   : dossier du cache (defaut: <fichier>.scc a cote de l'entree)\n"
+            "  -no-cache        : ni lecture ni ecriture du cache\n"
+            "  -clear-cache     : supprime le cache de cette entree et recalcule sans cache\n"
+            "  -external        : mode externe, aretes triees sur disque et CFC par passes sur le fichier\n"
+            "  -mem <taille>    : memoire du tri et des blocs lus (suffixes k, M, G), implique -external\n"
+            "                     (defaut: la moitie de GRAPH_MEMORY_BUDGET)\n"
+            "  -edges <fichier> : fichier des aretes triees, conserve (defaut: <fichier>.edges, supprime)\n"
+            "  -verify          : compare la partition du mode externe au calcul en memoire, implique -external\n"
+            "  -max-passes n    : lectures du fichier trie au plus, 0 sans limite (defaut: 1000), implique -external\n",
+            prog);
 }
 
-// Parcours en profondeur pour l'ordre de fin
-void Kosaraju_1(t_graph *g){
-    int n = graph_size(g);
-    t_bool marking[n];
-    step=0;
-    int x; 
-    int i;
-
-    for(i=0;i<n;i++)
-        marking[i]=0;
-    for(x=0; x<n; x++){
-        step = Kosaraju_1_recur(g, x, marking, order, step);
-    }
+static t_graph *read_graph(const char *in_path, const char *graph_format, int repr) {
+    if (strcmp(graph_format, "1") == 0) return graph_read_format1(in_path, repr);
+    if (strcmp(graph_format, "2") == 0) return graph_read_format2(in_path, repr);
+    return graph_read_binary(in_path, repr);
 }
 
-int Kosaraju_1_recur(t_graph *g, int x, t_bool marking[], int order[], int step){
-    int n = graph_size(g);
-    int y;
+// Vrai si le budget mémoire a remplacé les listes demandées par le CSR (le budget
+// ne fait que se replier sur le CSR). Matrice et CSR parcourent les successeurs
+// dans le même ordre et numérotent les CFC de la même façon ; seules les listes
+// diffèrent : ce résultat ne doit pas être rejoué sous la clé des listes.
+static int budget_forced_csr(const t_graph *g, int repr) {
+    return repr == GRAPH_LIST && graph_representation(g) == GRAPH_CSR;
+}
 
-    if(marking[x]==0){
-        marking[x] = 1;
-        for(y=0; y<n; y++){
-            if(graph_has_edge(g,x,y)==1){
-                step = Kosaraju_1_recur(g, y, marking, order, step);
-            }
+// Même partition que le calcul en mémoire : chaque CFC du mode externe est
+// contenue dans une seule CFC de graph_scc, et elles sont en même nombre
+static int verify_scc(const char *in_path, const char *graph_format, int repr, const int *comp, int nb_scc) {
+    if (in_path == NULL || strcmp(in_path, "-") == 0) {
+        fprintf(stderr, "Vérification impossible sur stdin\n");
+        return 0;
+    }
+    t_graph *g = read_graph(in_path, graph_format, repr);
+    int n = g != NULL ? graph_size(g) : 0;
+    int *ref = malloc((size_t)(n > 0 ? n : 1) * sizeof(int));
+    int *map = malloc((size_t)(nb_scc > 0 ? nb_scc : 1) * sizeof(int));
+    int ok = g != NULL && ref != NULL && map != NULL;
+    if (!ok) fprintf(stderr, "Vérification : lecture du graphe impossible\n");
+    int nb_ref = ok ? graph_scc(g, ref) : 0;
+    if (ok && nb_ref != nb_scc) {
+        fprintf(stderr, "Vérification : %d CFC en mémoire, %d en mode externe\n", nb_ref, nb_scc);
+        ok = 0;
+    }
+    for (int c = 0; ok && c < nb_scc; c++) map[c] = -1;
+    for (int v = 0; ok && v < n; v++) {
+        if (map[comp[v]] < 0) map[comp[v]] = ref[v];
+        else if (map[comp[v]] != ref[v]) {
+            fprintf(stderr, "Vérification : le sommet %d n'est pas dans la même CFC qu'en mémoire\n", v);
+            ok = 0;
         }
-        order[x] = step;
-        step++;
     }
-    return step;
+    if (ok) fprintf(stderr, "Vérification : même partition qu'en mémoire\n");
+    free(map);
+    free(ref);
+    graph_free(g);
+    return ok;
 }
 
-// Deuxième DFS sur le graphe transposé
-void Kosaraju_2(t_graph *g, int order[]){
-    int n = graph_size(g);
-    t_bool marking[n];
-    int inv_order[n];
-    int nb_scc = 0;
-    int i;
-    int x;
-
-    for(i=0;i<n;i++)
-        marking[i] = 0;
-        
-    for(x=0;x<n;x++)
-        inv_order[n-1-order[x]] = x;
-
-    for(x=0;x<n;x++){
-        if(Kosaraju_2_recur(g,inv_order[x],marking)==1){
-            nb_scc++;
-            printf("\n");
+int main(int argc, char **argv) {
+    const char **in_paths = malloc((size_t)argc * sizeof(*in_paths));
+    int nb_in = 0;
+    int nb_threads = 0;
+    const char *out_path = NULL;
+    const char *graph_format = "1";
+    t_scc_format format = GRAPH_SCC_TEXT;
+    int repr = GRAPH_AUTO;
+    t_bool hist = 0;
+    int top = 0;
+    const char *cache_dir = NULL;
+    t_bool use_cache = 1;
+    t_bool clear_cache = 0;
+    t_bool external = 0, verify = 0;
+    size_t mem = 0;
+    int max_passes = GRAPH_EXTERNAL_MAX_PASSES;
+    const char *edges_path = NULL;
+    if (in_paths == NULL) return 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            in_paths[nb_in++] = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            graph_format = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            long v = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || v < 1 || v > 1000000000L) {
+                usage(argv[0]);
+                return 1;
+            }
+            nb_threads = (int)v;
+        } else if (strcmp(argv[i], "-repr") == 0 && i + 1 < argc) {
+            repr = graph_representation_from_name(argv[++i]);
+            if (repr == GRAPH_REPR_INVALID) { usage(argv[0]); return 1; }
+        } else if (strcmp(argv[i], "-format") == 0 && i + 1 < argc) {
+            const char *f = argv[++i];
+            if (strcmp(f, "text") == 0) format = GRAPH_SCC_TEXT;
+            else if (strcmp(f, "csv") == 0) format = GRAPH_SCC_CSV;
+            else if (strcmp(f, "json") == 0) format = GRAPH_SCC_JSON;
+            else if (strcmp(f, "bin") == 0) format = GRAPH_SCC_BINARY;
+            else { usage(argv[0]); return 1; }
+        } else if (strcmp(argv[i], "-top") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            long v = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || v < 1 || v > 1000000000L) {
+                usage(argv[0]);
+                return 1;
+            }
+            top = (int)v;
+        } else if (strcmp(argv[i], "-hist") == 0) {
+            hist = 1;
+        } else if (strcmp(argv[i], "-cache-dir") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "-no-cache") == 0) {
+            use_cache = 0;
+        } else if (strcmp(argv[i], "-clear-cache") == 0) {
+            clear_cache = 1;
+        } else if (strcmp(argv[i], "-external") == 0) {
+            external = 1;
+        } else if (strcmp(argv[i], "-mem") == 0 && i + 1 < argc) {
+            long long bytes = graph_parse_bytes(argv[++i]);
+            if (bytes <= 0) { usage(argv[0]); return 1; }
+            mem = (size_t)bytes;
+            external = 1;
+        } else if (strcmp(argv[i], "-edges") == 0 && i + 1 < argc) {
+            edges_path = argv[++i];
+        } else if (strcmp(argv[i], "-verify") == 0) {
+            verify = external = 1;
+        } else if (strcmp(argv[i], "-max-passes") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            long v = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || v < 0 || v > 1000000000L) {
+                usage(argv[0]);
+                return 1;
+            }
+            max_passes = (int)v;
+            graph_set_external_max_passes(max_passes);
+            external = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
         }
     }
 
-    printf("%d composantes fortement connexes trouvées\n", nb_scc);
-}
+    // Cache : un seul fichier d'entrée (pas stdin) ; la clé mêle l'empreinte du
+    // contenu au format et à la représentation demandée, dont dépend la numérotation
+    const char *in_path = nb_in > 0 ? in_paths[0] : NULL;
+    if (nb_in > 1 && (strcmp(graph_format, "1") != 0 || external)) { usage(argv[0]); return 1; }
+    if (strcmp(graph_format, "1") != 0 && strcmp(graph_format, "2") != 0 && strcmp(graph_format, "bin") != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    // Le cache garde le graphe des CFC, que le mode externe ne construit pas
+    if (external) use_cache = 0;
+    char *cache_path = NULL;
+    unsigned long long key = 0;
+    if ((use_cache || clear_cache) && nb_in == 1 && strcmp(in_path, "-") != 0
+        && graph_file_digest(in_path, &key)) {
+        key ^= ((unsigned long long)(repr + 2) << 56) ^ (unsigned char)graph_format[0];
+        size_t len = strlen(cache_dir != NULL ? cache_dir : in_path) + 32;
+        cache_path = malloc(len);
+        if (cache_path != NULL && cache_dir != NULL) snprintf(cache_path, len, "%s/%016llx.scc", cache_dir, key);
+        else if (cache_path != NULL) snprintf(cache_path, len, "%s.scc", in_path);
+    }
+    if (cache_path != NULL && clear_cache) {
+        if (remove(cache_path) == 0) fprintf(stderr, "Cache supprimé : %s\n", cache_path);
+        use_cache = 0;
+    }
+    t_scc_cache *cache = (cache_path != NULL && use_cache) ? graph_scc_cache_open(cache_path, key) : NULL;
 
-int Kosaraju_2_recur(t_graph *g, int x, t_bool marking[]){
-    int n = graph_size(g);
-    int y;
+    t_graph *g = NULL;
+    int *comp = NULL;
+    const int *result;
+    int n, nb_scc;
+    if (cache != NULL) {
+        fprintf(stderr, "CFC reprises du cache %s\n", cache_path);
+        n = graph_scc_cache_size(cache);
+        nb_scc = graph_scc_cache_nb_comp(cache);
+        result = graph_scc_cache_comp(cache);
+    } else if (external) {
+        // Arêtes triées sur disque, puis CFC par passes sur ce fichier
+        char *default_edges = NULL;
+        if (edges_path == NULL) {
+            const char *base = (in_path != NULL && strcmp(in_path, "-") != 0) ? in_path : "CFC_graphe";
+            default_edges = malloc(strlen(base) + 7);
+            if (default_edges == NULL) return 1;
+            sprintf(default_edges, "%s.edges", base);
+        }
+        const char *path = edges_path != NULL ? edges_path : default_edges;
+        int fmt = strcmp(graph_format, "bin") == 0 ? 3 : graph_format[0] - '0';
+        g = graph_external_sort(in_path, fmt, path, mem);
+        n = g != NULL ? graph_size(g) : 0;
+        comp = g != NULL ? malloc((size_t)n * sizeof(int)) : NULL;
+        int passes = 0;
+        graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+        nb_scc = comp != NULL ? graph_scc_external(path, n, comp, mem, &passes) : -1;
+        graph_stats_phase_end(GRAPH_PHASE_ALGO);
+        if (g != NULL && default_edges != NULL) remove(default_edges);
+        free(default_edges);
+        if (nb_scc < 0) {
+            fprintf(stderr, "Erreur: CFC en mode externe impossibles.\n");
+            if (max_passes > 0 && passes >= max_passes) {
+                fprintf(stderr, "Augmenter -max-passes (%d) ou calculer en mémoire, sans -external.\n", max_passes);
+            }
+            free(comp);
+            free(in_paths);
+            graph_free(g);
+            return 1;
+        }
+        fprintf(stderr, "Mode externe : %d passes sur les arêtes\n", passes);
+        result = comp;
+        if (verify && !verify_scc(in_path, graph_format, repr, comp, nb_scc)) {
+            free(comp);
+            free(in_paths);
+            graph_free(g);
+            return 1;
+        }
+    } else {
+        // Lecture du graphe
+        if (nb_in > 1) g = graph_read_format1_files(in_paths, nb_in, repr, nb_threads);
+        else g = read_graph(in_path, graph_format, repr);
+        if (g == NULL) {
+            fprintf(stderr, "Erreur: lecture du graphe impossible.\n");
+            return 1;
+        }
+        if (repr == GRAPH_AUTO) {
+            fprintf(stderr, "Representation choisie : %s\n", graph_representation_name(graph_representation(g)));
+        }
 
-    if(marking[x]==1) 
-        return 0;
+        n = graph_size(g);
+        comp = malloc((size_t)n * sizeof(int));
+        if (comp == NULL) {
+            fprintf(stderr, "Erreur: mémoire insuffisante.\n");
+            graph_free(g);
+            return 1;
+        }
+        graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+        nb_scc = graph_scc(g, comp);
+        graph_stats_phase_end(GRAPH_PHASE_ALGO);
+        result = comp;
+        if (cache_path != NULL && use_cache && budget_forced_csr(g, repr)) {
+            fprintf(stderr, "Avertissement : cache non enregistré, csr imposé par le budget mémoire (%s)\n", cache_path);
+        } else if (cache_path != NULL && use_cache && !graph_scc_cache_save(cache_path, key, g, comp, nb_scc)) {
+            fprintf(stderr, "Avertissement : cache non enregistré (%s)\n", cache_path);
+        }
+    }
 
-    marking[x] = 1;
-    printf("%d ", x);
-    for(y=0; y<n; y++){
-        if(graph_has_edge(g,x,y)==1){
-            Kosaraju_2_recur(g,y,marking);
+    FILE *out = stdout;
+    if (out_path != NULL) {
+        out = fopen(out_path, format == GRAPH_SCC_BINARY ? "wb" : "w");
+        if (out == NULL) {
+            perror("fopen -o");
+            graph_scc_cache_close(cache);
+            free(cache_path);
+            free(comp);
+            graph_free(g);
+            return 1;
         }
     }
-    return 1;
-}
 
+    int ret = 0;
+    t_bool written = cache != NULL ? graph_scc_cache_write(out, cache, format, top)
+                                   : graph_write_scc(out, g, comp, nb_scc, format, top);
+    if (!written) {
+        fprintf(stderr, "Erreur: écriture des CFC impossible.\n");
+        ret = 1;
+    }
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "%d composantes fortement connexes trouvées\n", nb_scc);
+    if (hist) graph_write_scc_histogram(stderr, result, n, nb_scc);
+
+    graph_scc_cache_close(cache);
+    free(cache_path);
+    free(comp);
+    free(in_paths);
+    graph_free(g);
+    return ret;
+}
@@ -0,0 +1,665 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "graph.h"
+
+/*
+  Banc d'essai de bout en bout du module graph.c
+
+  Pour chaque graphe de Fichiers/graphes/numeros et Fichiers/graphes/noms, et
+  pour chaque représentation, mesure :
+    - le chargement (graph_read_format1 / graph_read_format2),
+    - graph_reverse,
+    - l'élagage des CFC triviales (graph_trim) et la part des sommets retirés,
+    - le calcul complet des CFC (graph_scc),
+    - les composantes faiblement connexes (graph_wcc) sur un fil puis sur tous
+      les processeurs, dont les partitions doivent coïncider,
+    - PageRank (graph_pagerank sur le transposé, tous les processeurs) : temps
+      et débit en arcs par seconde d'une itération,
+    - le mode externe (graph_external_sort puis graph_scc_external) avec la
+      plus petite mémoire, dont la partition doit coïncider avec graph_scc,
+    - l'export DOT (même sortie que fil_rouge_1, écrite dans /dev/null),
+    - un jeu fixe de recherches de chemin (parcours en largeur),
+    - la mémoire du graphe chargé (graph_memory_usage : arêtes, index, noms).
+
+  Chaque couple (graphe, représentation) est mesuré dans un processus fils :
+  le pic de mémoire (ru_maxrss) est donc propre à la mesure.
+
+  Compilation :
+    gcc -Wall -Wextra -std=c11 -O2 bench_graph.c graph.c -o bench_graph
+*/
+
+#define PATH_SZ 4096
+#define NB_QUERIES 16
+#define MAX_DIRS 16
+#define MAX_REPEAT 1000
+#define PR_MAX_ITER 100
+/* Nombres de fils forcés pour la vérification de graph_wcc (en plus de 1 et de
+   tous les processeurs) ; graph_wcc les borne au nombre de tranches de sommets */
+static const int WCC_CHECK_THREADS[] = { 2, 3, 4, 8 };
+#define NB_WCC_CHECKS ((int)(sizeof(WCC_CHECK_THREADS) / sizeof(WCC_CHECK_THREADS[0])))
+
+/* =========================
+   Représentations mesurées
+   ========================= */
+
+struct backend {
+  const char *name;
+  int repr;
+};
+
+static const struct backend BACKENDS[] = {
+  { "list",   GRAPH_LIST },
+  { "matrix", GRAPH_MATRIX },
+  { "csr",    GRAPH_CSR },
+  { "auto",   GRAPH_AUTO },
+};
+#define NB_BACKENDS ((int)(sizeof(BACKENDS) / sizeof(BACKENDS[0])))
+
+/* =========================
+   Résultats
+   ========================= */
+
+enum { RES_OK = 0, RES_SKIPPED = 1, RES_FAILED = 2 };
+
+struct bench_result {
+  int status;
+  int format;
+  int chosen;  /* représentation effective (auto : celle choisie au chargement) */
+  int vertices;
+  long edges;
+  double load_s, reverse_s, trim_s, scc_s, wcc_seq_s, wcc_s, dot_s, paths_s;
+  int trim_sources, trim_sinks;  /* CFC triviales retirées par graph_trim */
+  int components;
+  int wcc_components;
+  int wcc_mismatch;    /* partitions de graph_wcc différentes (signalé par le parent) */
+  double ext_s;        /* tri externe et graph_scc_external, première répétition */
+  int ext_passes;      /* lectures du fichier trié, -1 si le mode externe échoue */
+  int ext_mismatch;    /* partition du mode externe différente de graph_scc */
+  double pagerank_s;   /* temps d'une itération (calcul complet / itérations) */
+  int pagerank_iters;  /* -1 : seuil non atteint en PR_MAX_ITER itérations */
+  int paths_found;
+  t_graph_memory mem;  /* graph_memory_usage après chargement */
+  long peak_rss_kb;
+};
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-d <dossier>]... [-f csv|json] [-o <fichier>] [-b <repr>] [-r <n>] [-matrix-max <n>]\n"
+          "  -d <dossier>     : dossier de graphes (defaut: Fichiers/graphes/numeros et noms)\n"
+          "  -f csv|json      : format du rapport (defaut: csv)\n"
+          "  -o <fichier>     : fichier du rapport (defaut: stdout)\n"
+          "  -b <repr>        : ne mesurer que cette representation (list, matrix, csr, auto)\n"
+          "  -r <n>           : nombre de repetitions, on garde le minimum (defaut: 1)\n"
+          "  -matrix-max <n>  : pas de matrice au-dela de n sommets (defaut: 8192)\n",
+          prog);
+}
+
+/* =========================
+   Chronométrage
+   ========================= */
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void keep_min(double *best, double t, int first) {
+  if (first || t < *best) *best = t;
+}
+
+/* =========================
+   Détection du format
+   ========================= */
+
+/* Lit l'en-tête : retourne 2 pour "N n", 1 pour "N", 0 si illisible ; *n reçoit N */
+static int detect_format(const char *path, int *n) {
+  FILE *f = fopen(path, "r");
+  if (!f) return 0;
+  char line[512];
+  int fmt = 0;
+  while (fgets(line, (int)sizeof(line), f)) {
+    char *p = line;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (*p == '\0') continue;
+    char tag = '\0';
+    int r = sscanf(p, "%d %c", n, &tag);
+    if (r >= 1) fmt = (r >= 2 && (tag == 'n' || tag == 'N')) ? 2 : 1;
+    break;
+  }
+  fclose(f);
+  return fmt;
+}
+
+/* =========================
+   Opérations mesurées
+   ========================= */
+
+static void count_cb(t_vertex v, void *ctx) {
+  (void)v;
+  (*(long *)ctx)++;
+}
+
+static long count_edges(const t_graph *g) {
+  long m = 0;
+  for (t_vertex u = 0; u < graph_size(g); u++) graph_for_each_succ(g, u, count_cb, &m);
+  return m;
+}
+
+/* Export DOT identique à fil_rouge_1 */
+static void dot_print_escaped(FILE *out, const char *s) {
+  fputc('"', out);
+  for (const char *p = s; *p; p++) {
+    if (*p == '"' || *p == '\\') fputc('\\', out);
+    fputc(*p, out);
+  }
+  fputc('"', out);
+}
+
+struct dot_ctx {
+  FILE *out;
+  const t_graph *g;
+  t_vertex from;
+};
+
+static void dot_succ_cb(t_vertex to, void *ctx_void) {
+  struct dot_ctx *ctx = (struct dot_ctx *)ctx_void;
+  if (graph_has_names(ctx->g)) {
+    const char *a = graph_vertex_name(ctx->g, ctx->from);
+    const char *b = graph_vertex_name(ctx->g, to);
+    fputs("  ", ctx->out);
+    dot_print_escaped(ctx->out, a ? a : "");
+    fputs(" -> ", ctx->out);
+    dot_print_escaped(ctx->out, b ? b : "");
+    fputs(";\n", ctx->out);
+  } else {
+    fprintf(ctx->out, "  %d -> %d;\n", ctx->from, to);
+  }
+}
+
+static void write_dot(FILE *out, const t_graph *g) {
+  fprintf(out, "digraph nom_du_graphe {\n");
+  struct dot_ctx ctx = { out, g, 0 };
+  for (t_vertex u = 0; u < graph_size(g); u++) {
+    ctx.from = u;
+    graph_for_each_succ(g, u, dot_succ_cb, &ctx);
+  }
+  fprintf(out, "}\n");
+}
+
+/* Recherche de chemin par parcours en largeur (file dans un tableau) */
+struct bfs_ctx {
+  int *parent;
+  t_vertex *queue;
+  int tail;
+  t_vertex from;
+};
+
+static void bfs_cb(t_vertex v, void *p) {
+  struct bfs_ctx *ctx = (struct bfs_ctx *)p;
+  if (ctx->parent[v] == -1) {
+    ctx->parent[v] = ctx->from;
+    ctx->queue[ctx->tail++] = v;
+  }
+}
+
+static int path_exists(const t_graph *g, t_vertex s, t_vertex t, int *parent, t_vertex *queue) {
+  int n = graph_size(g);
+  for (int i = 0; i < n; i++) parent[i] = -1;
+  struct bfs_ctx ctx = { parent, queue, 0, s };
+  parent[s] = s;
+  queue[ctx.tail++] = s;
+  for (int head = 0; head < ctx.tail; head++) {
+    t_vertex u = queue[head];
+    if (u == t) return 1;
+    ctx.from = u;
+    graph_for_each_succ(g, u, bfs_cb, &ctx);
+  }
+  return 0;
+}
+
+/* Composantes faiblement connexes de référence, indépendantes de graph_wcc :
+   parcours en largeur séquentiel sur les successeurs de g et de son transposé,
+   lancés dans l'ordre croissant des sommets, donc numérotés comme graph_wcc
+   (ordre du plus petit sommet). Retourne le nombre de composantes, -1 si la
+   mémoire manque. */
+static int wcc_reference(const t_graph *g, int *comp) {
+  int n = graph_size(g);
+  t_graph *rev = graph_reverse(g);
+  t_vertex *queue = malloc((size_t)(n > 0 ? n : 1) * sizeof(*queue));
+  if (!rev || !queue) { free(queue); graph_free(rev); return -1; }
+  for (int v = 0; v < n; v++) comp[v] = -1;
+  int nb = 0;
+  for (t_vertex s = 0; s < n; s++) {
+    if (comp[s] >= 0) continue;
+    int tail = 0;
+    comp[s] = nb;
+    queue[tail++] = s;
+    for (int head = 0; head < tail; head++) {
+      t_vertex u = queue[head], v;
+      for (int side = 0; side < 2; side++) {
+        const t_graph *h = side == 0 ? g : rev;
+        t_graph_cursor c;
+        graph_cursor_init(h, u, &c);
+        while (graph_cursor_next(h, u, &c, &v)) {
+          if (comp[v] < 0) {
+            comp[v] = nb;
+            queue[tail++] = v;
+          }
+        }
+      }
+    }
+    nb++;
+  }
+  free(queue);
+  graph_free(rev);
+  return nb;
+}
+
+/* CFC du mode externe avec la plus petite mémoire (blocs de 64 Ko, séries de
+   tri minimales, donc plusieurs blocs et séries dès les graphes fournis), sur un
+   fichier trié temporaire. Retourne 1 si la partition est celle de comp (nb_comp
+   CFC de graph_scc), 0 si elle diffère, -1 si le mode externe échoue. */
+static int external_check(const char *path, int fmt, const int *comp, int nb_comp, int *passes) {
+  char edges[PATH_SZ];
+  const char *dir = getenv("TMPDIR");
+  snprintf(edges, sizeof(edges), "%s/bench_graph.XXXXXX", dir ? dir : "/tmp");
+  int fd = mkstemp(edges);
+  if (fd < 0) return -1;
+  close(fd);
+  t_graph *g = graph_external_sort(path, fmt, edges, 1);
+  int n = g ? graph_size(g) : 0;
+  int *ext = g ? malloc((size_t)n * sizeof(*ext)) : NULL;
+  int *map = malloc((size_t)(nb_comp > 0 ? nb_comp : 1) * sizeof(*map));
+  int nb = ext && map ? graph_scc_external(edges, n, ext, 1, passes) : -1;
+  remove(edges);
+  int same = nb < 0 ? -1 : nb == nb_comp;
+  for (int c = 0; same == 1 && c < nb_comp; c++) map[c] = -1;
+  for (int v = 0; same == 1 && v < n; v++) {
+    if (map[comp[v]] < 0) map[comp[v]] = ext[v];
+    else if (map[comp[v]] != ext[v]) same = 0;
+  }
+  free(map);
+  free(ext);
+  graph_free(g);
+  return same;
+}
+
+/* Jeu de requêtes fixe : générateur congruentiel à graine constante */
+static int run_queries(const t_graph *g) {
+  int n = graph_size(g);
+  int *parent = malloc((size_t)n * sizeof(*parent));
+  t_vertex *queue = malloc((size_t)n * sizeof(*queue));
+  if (!parent || !queue) { free(parent); free(queue); return -1; }
+  unsigned long seed = 12345;
+  int found = 0;
+  for (int q = 0; q < NB_QUERIES; q++) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    t_vertex s = (t_vertex)((seed >> 33) % (unsigned long)n);
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    t_vertex t = (t_vertex)((seed >> 33) % (unsigned long)n);
+    found += path_exists(g, s, t, parent, queue);
+  }
+  free(queue);
+  free(parent);
+  return found;
+}
+
+/* Mesure complète d'un graphe pour une représentation (exécutée dans le fils) */
+static void measure(const char *path, int fmt, const struct backend *b, int repeat,
+                    struct bench_result *res) {
+  FILE *null_out = fopen("/dev/null", "w");
+  if (!null_out) { res->status = RES_FAILED; return; }
+
+  for (int r = 0; r < repeat; r++) {
+    int first = (r == 0);
+    double t0 = now_s();
+    t_graph *g = (fmt == 2) ? graph_read_format2(path, b->repr)
+                            : graph_read_format1(path, b->repr);
+    double t1 = now_s();
+    if (!g) { res->status = RES_FAILED; break; }
+    keep_min(&res->load_s, t1 - t0, first);
+    res->chosen = graph_representation(g);
+    res->vertices = graph_size(g);
+    res->edges = count_edges(g);
+    res->mem = graph_memory_usage(g);
+
+    t0 = now_s();
+    t_graph *rev = graph_reverse(g);
+    t1 = now_s();
+    keep_min(&res->reverse_s, t1 - t0, first);
+
+    int *comp = malloc((size_t)graph_size(g) * sizeof(*comp));
+    t_vertex *core = malloc((size_t)graph_size(g) * sizeof(*core));
+    if (!comp || !core) {
+      free(comp); free(core); graph_free(rev); graph_free(g);
+      res->status = RES_FAILED;
+      break;
+    }
+    t0 = now_s();
+    t_trim trim = graph_trim(g, rev, comp, core);
+    t1 = now_s();
+    keep_min(&res->trim_s, t1 - t0, first);
+    res->trim_sources = trim.nb_sources;
+    res->trim_sinks = trim.nb_sinks;
+    free(core);
+
+    double *rank = malloc((size_t)graph_size(g) * sizeof(*rank));
+    if (!rank) { free(comp); graph_free(rev); graph_free(g); res->status = RES_FAILED; break; }
+    t0 = now_s();
+    res->pagerank_iters = graph_pagerank(g, rev, 0.85, 1e-9, PR_MAX_ITER, 0, rank);
+    t1 = now_s();
+    int done = res->pagerank_iters < 0 ? PR_MAX_ITER : res->pagerank_iters;
+    keep_min(&res->pagerank_s, done > 0 ? (t1 - t0) / done : 0.0, first);
+    free(rank);
+    graph_free(rev);
+
+    t0 = now_s();
+    res->components = graph_scc(g, comp);
+    t1 = now_s();
+    keep_min(&res->scc_s, t1 - t0, first);
+
+    if (first) {
+      t0 = now_s();
+      int same = external_check(path, fmt, comp, res->components, &res->ext_passes);
+      t1 = now_s();
+      res->ext_s = t1 - t0;
+      if (same < 0) res->ext_passes = -1;
+      if (same != 1) {
+        res->ext_mismatch = 1;
+        res->status = RES_FAILED;
+      }
+    }
+
+    /* Composantes faiblement connexes : un fil, puis tous les processeurs, puis
+       (première répétition) les nombres de fils de WCC_CHECK_THREADS ; chaque
+       résultat doit être identique au parcours séquentiel de wcc_reference */
+    size_t comp_bytes = (size_t)graph_size(g) * sizeof(*comp);
+    int *wcomp = malloc(comp_bytes);
+    int *ref = first ? malloc(comp_bytes) : NULL;
+    int nb_ref = ref ? wcc_reference(g, ref) : -1;
+    if (!wcomp || (first && nb_ref < 0)) {
+      free(wcomp); free(ref); free(comp); graph_free(g); res->status = RES_FAILED; break;
+    }
+    t0 = now_s();
+    res->wcc_components = graph_wcc(g, comp, NULL, 1);
+    t1 = now_s();
+    keep_min(&res->wcc_seq_s, t1 - t0, first);
+    t0 = now_s();
+    int nb_wcc = graph_wcc(g, wcomp, NULL, 0);
+    t1 = now_s();
+    keep_min(&res->wcc_s, t1 - t0, first);
+    if (nb_wcc != res->wcc_components || memcmp(comp, wcomp, comp_bytes) != 0) {
+      res->wcc_mismatch = 1;
+    }
+    if (ref) {
+      if (res->wcc_components != nb_ref || memcmp(comp, ref, comp_bytes) != 0) res->wcc_mismatch = 1;
+      for (int i = 0; i < NB_WCC_CHECKS; i++) {
+        if (graph_wcc(g, wcomp, NULL, WCC_CHECK_THREADS[i]) != nb_ref || memcmp(wcomp, ref, comp_bytes) != 0) {
+          res->wcc_mismatch = 1;
+        }
+      }
+    }
+    if (res->wcc_mismatch) res->status = RES_FAILED;
+    free(ref);
+    free(wcomp);
+    free(comp);
+
+    t0 = now_s();
+    write_dot(null_out, g);
+    fflush(null_out);
+    t1 = now_s();
+    keep_min(&res->dot_s, t1 - t0, first);
+
+    t0 = now_s();
+    res->paths_found = run_queries(g);
+    t1 = now_s();
+    keep_min(&res->paths_s, t1 - t0, first);
+
+    graph_free(g);
+  }
+  fclose(null_out);
+
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == 0) res->peak_rss_kb = ru.ru_maxrss;
+}
+
+/* Lance la mesure dans un fils et récupère le résultat par un tube */
+static void measure_isolated(const char *path, int fmt, const struct backend *b, int repeat,
+                             struct bench_result *res) {
+  int fds[2];
+  if (pipe(fds) != 0) { res->status = RES_FAILED; return; }
+  fflush(NULL);
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    res->status = RES_FAILED;
+    return;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    /* Les diagnostics de lecture ne doivent pas polluer le rapport */
+    if (!freopen("/dev/null", "w", stderr)) _exit(1);
+    measure(path, fmt, b, repeat, res);
+    ssize_t w = write(fds[1], res, sizeof(*res));
+    _exit(w == (ssize_t)sizeof(*res) ? 0 : 1);
+  }
+  close(fds[1]);
+  struct bench_result child;
+  ssize_t r = read(fds[0], &child, sizeof(child));
+  close(fds[0]);
+  int wstatus = 0;
+  waitpid(pid, &wstatus, 0);
+  if (r == (ssize_t)sizeof(child)) *res = child;
+  else res->status = RES_FAILED;
+}
+
+/* =========================
+   Rapport CSV / JSON
+   ========================= */
+
+static const char *status_str(int status) {
+  return status == RES_OK ? "ok" : (status == RES_SKIPPED ? "skipped" : "failed");
+}
+
+/* Représentation effective ; pour auto non mesuré, "auto" */
+static const char *repr_str(const struct backend *b, const struct bench_result *r) {
+  return graph_representation_name(r->status == RES_OK ? r->chosen : b->repr);
+}
+
+static double per_s(double count, double t) {
+  return t > 0 ? count / t : 0.0;
+}
+
+static void report_header(FILE *out, int json) {
+  if (json) {
+    fprintf(out, "[\n");
+  } else {
+    fprintf(out, "file,format,backend,repr,status,vertices,edges,load_s,load_edges_per_s,"
+                 "reverse_s,trim_s,trimmed,trimmed_frac,scc_s,components,ext_s,ext_passes,wcc_seq_s,wcc_s,wcc_components,pagerank_iters,pagerank_s,pagerank_edges_per_s,dot_s,paths_s,paths_found,"
+                 "adjacency_bytes,index_bytes,names_bytes,graph_bytes,peak_rss_kb\n");
+  }
+}
+
+/* Chaîne JSON : guillemets, barres obliques inverses et caractères de contrôle échappés */
+static void json_print_string(FILE *out, const char *s) {
+  fputc('"', out);
+  for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+    if (*p == '"' || *p == '\\') fprintf(out, "\\%c", *p);
+    else if (*p < 0x20) fprintf(out, "\\u%04x", *p);
+    else fputc(*p, out);
+  }
+  fputc('"', out);
+}
+
+/* Champ CSV : entre guillemets s'il contient une virgule, un guillemet ou une fin de
+   ligne, les guillemets internes étant doublés */
+static void csv_print_field(FILE *out, const char *s) {
+  if (!strpbrk(s, ",\"\r\n")) { fputs(s, out); return; }
+  fputc('"', out);
+  for (const char *p = s; *p; p++) {
+    if (*p == '"') fputc('"', out);
+    fputc(*p, out);
+  }
+  fputc('"', out);
+}
+
+static void report_row(FILE *out, int json, int first, const char *path,
+                       const struct backend *b, const struct bench_result *r) {
+  int trimmed = r->trim_sources + r->trim_sinks;
+  if (json) {
+    fprintf(out, "%s  {\"file\": ", first ? "" : ",\n");
+    json_print_string(out, path);
+    fprintf(out,
+            ", \"format\": %d, \"backend\": \"%s\", \"repr\": \"%s\", \"status\": \"%s\", "
+            "\"vertices\": %d, \"edges\": %ld, \"load_s\": %.6f, \"load_edges_per_s\": %.0f, "
+            "\"reverse_s\": %.6f, \"trim_s\": %.6f, \"trimmed\": %d, \"trimmed_frac\": %.4f, \"scc_s\": %.6f, \"components\": %d, "
+            "\"ext_s\": %.6f, \"ext_passes\": %d, "
+            "\"wcc_seq_s\": %.6f, \"wcc_s\": %.6f, \"wcc_components\": %d, "
+            "\"pagerank_iters\": %d, \"pagerank_s\": %.6f, \"pagerank_edges_per_s\": %.0f, \"dot_s\": %.6f, "
+            "\"paths_s\": %.6f, \"paths_found\": %d, \"adjacency_bytes\": %zu, \"index_bytes\": %zu, "
+            "\"names_bytes\": %zu, \"graph_bytes\": %zu, \"peak_rss_kb\": %ld}",
+            r->format, b->name, repr_str(b, r), status_str(r->status),
+            r->vertices, r->edges, r->load_s, per_s((double)r->edges, r->load_s),
+            r->reverse_s, r->trim_s, trimmed, per_s(trimmed, r->vertices), r->scc_s, r->components,
+            r->ext_s, r->ext_passes,
+            r->wcc_seq_s, r->wcc_s, r->wcc_components,
+            r->pagerank_iters, r->pagerank_s, per_s((double)r->edges, r->pagerank_s), r->dot_s,
+            r->paths_s, r->paths_found,
+            r->mem.adjacency, r->mem.index, r->mem.names, r->mem.total, r->peak_rss_kb);
+  } else {
+    csv_print_field(out, path);
+    fprintf(out, ",%d,%s,%s,%s,%d,%ld,%.6f,%.0f,%.6f,%.6f,%d,%.4f,%.6f,%d,%.6f,%d,%.6f,%.6f,%d,%d,%.6f,%.0f,%.6f,%.6f,%d,%zu,%zu,%zu,%zu,%ld\n",
+            r->format, b->name, repr_str(b, r), status_str(r->status),
+            r->vertices, r->edges, r->load_s, per_s((double)r->edges, r->load_s),
+            r->reverse_s, r->trim_s, trimmed, per_s(trimmed, r->vertices), r->scc_s, r->components,
+            r->ext_s, r->ext_passes,
+            r->wcc_seq_s, r->wcc_s, r->wcc_components,
+            r->pagerank_iters, r->pagerank_s, per_s((double)r->edges, r->pagerank_s), r->dot_s,
+            r->paths_s, r->paths_found,
+            r->mem.adjacency, r->mem.index, r->mem.names, r->mem.total, r->peak_rss_kb);
+  }
+  fflush(out);
+}
+
+static void report_footer(FILE *out, int json) {
+  if (json) fprintf(out, "\n]\n");
+}
+
+/* =========================
+   Parcours des dossiers
+   ========================= */
+
+static int is_txt(const struct dirent *e) {
+  size_t L = strlen(e->d_name);
+  return L > 4 && strcmp(e->d_name + L - 4, ".txt") == 0;
+}
+
+/* =========================
+   Main
+   ========================= */
+
+/* Entier décimal dans [min, max], sans caractère en trop */
+static int parse_int(const char *s, long min, long max, int *out) {
+  char *end = NULL;
+  errno = 0;
+  long v = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || errno != 0 || v < min || v > max) return 0;
+  *out = (int)v;
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  const char *dirs[MAX_DIRS];
+  int nb_dirs = 0;
+  const char *out_path = NULL;
+  const char *only = NULL;
+  int json = 0;
+  int repeat = 1;
+  int matrix_max = 8192;
+
+  for (int i = 1; i < argc; i++) {
+    int ok = 1;
+    if (!strcmp(argv[i], "-d") && i + 1 < argc && nb_dirs < MAX_DIRS) dirs[nb_dirs++] = argv[++i];
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc) out_path = argv[++i];
+    else if (!strcmp(argv[i], "-b") && i + 1 < argc) only = argv[++i];
+    else if (!strcmp(argv[i], "-r") && i + 1 < argc) ok = parse_int(argv[++i], 1, MAX_REPEAT, &repeat);
+    else if (!strcmp(argv[i], "-matrix-max") && i + 1 < argc) ok = parse_int(argv[++i], 0, 100000000L, &matrix_max);
+    else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      const char *f = argv[++i];
+      if (!strcmp(f, "json")) json = 1;
+      else if (!strcmp(f, "csv")) json = 0;
+      else ok = 0;
+    } else ok = 0;
+    if (!ok) { usage(argv[0]); return 1; }
+  }
+  if (nb_dirs == 0) {
+    dirs[nb_dirs++] = "Fichiers/graphes/numeros";
+    dirs[nb_dirs++] = "Fichiers/graphes/noms";
+  }
+
+  FILE *out = stdout;
+  if (out_path) {
+    out = fopen(out_path, "w");
+    if (!out) { perror("fopen -o"); return 1; }
+  }
+
+  report_header(out, json);
+  int first = 1;
+  for (int d = 0; d < nb_dirs; d++) {
+    struct dirent **entries = NULL;
+    int nb = scandir(dirs[d], &entries, is_txt, alphasort);
+    if (nb < 0) {
+      fprintf(stderr, "Impossible de lire le dossier %s\n", dirs[d]);
+      continue;
+    }
+    for (int e = 0; e < nb; e++) {
+      char path[PATH_SZ];
+      snprintf(path, sizeof(path), "%s/%s", dirs[d], entries[e]->d_name);
+      free(entries[e]);
+
+      int n = 0;
+      int fmt = detect_format(path, &n);
+      if (fmt == 0) continue;
+
+      for (int k = 0; k < NB_BACKENDS; k++) {
+        const struct backend *b = &BACKENDS[k];
+        if (only && strcmp(only, b->name) != 0) continue;
+        struct bench_result res;
+        memset(&res, 0, sizeof(res));
+        if (b->repr == GRAPH_MATRIX && n > matrix_max) {
+          res.status = RES_SKIPPED;
+          res.vertices = n;
+        } else {
+          measure_isolated(path, fmt, b, repeat, &res);
+          /* Le fils écrit ses diagnostics dans /dev/null : les incohérences sont signalées ici */
+          if (res.wcc_mismatch) fprintf(stderr, "%s (%s) : composantes faiblement connexes incohérentes\n", path, b->name);
+          if (res.ext_mismatch) {
+            fprintf(stderr, "%s (%s) : %s\n", path, b->name,
+                    res.ext_passes < 0 ? "échec du mode externe" : "CFC du mode externe différentes de graph_scc");
+          }
+        }
+        res.format = fmt;
+        report_row(out, json, first, path, b, &res);
+        first = 0;
+      }
+    }
+    free(entries);
+  }
+  report_footer(out, json);
+
+  if (out != stdout) fclose(out);
+  return 0;
+}
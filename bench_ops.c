@@ -0,0 +1,879 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+/*
+  Micro-bancs d'essai des opérations du module graph.c
+
+  Pour chaque nombre de sommets, chaque distribution des degrés et chaque
+  représentation (list, matrix, csr), un graphe aléatoire est généré puis chaque
+  opération est chronométrée séparément :
+    graph_new, graph_add_edge, graph_add_weighted_edge, graph_has_edge (arêtes
+    présentes, couples au hasard), graph_for_each_succ,
+    graph_for_each_succ_weighted, graph_cursor_next, graph_reverse,
+    graph_remove_edge, graph_compact, graph_vertex_name,
+    graph_vertex_from_name, graph_vertices_with_prefix (réserve et
+    dictionnaire), graph_compress_names, graph_scc, graph_trim, graph_wcc,
+    graph_toposort, graph_transitive_closure, graph_pagerank,
+    graph_shortest_path, graph_ms_bfs, graph_khop, graph_induced_subgraph,
+    graph_write_binary, graph_read_binary, graph_free.
+  Les lectures des formats texte, le mode externe et le cache sont mesurés par
+  bench_graph et CFC_graphe sur des fichiers réels, pas ici (voir README).
+  Chaque mesure commence par des essais d'échauffement non comptés, puis garde
+  la médiane (et les extrêmes en CSV) de plusieurs essais ; le graphe nécessaire
+  à l'opération est reconstruit hors chronométrage avant chaque essai. Les temps
+  sont donnés par opération élémentaire (arête, requête ou appel), en
+  nanosecondes et en cycles du compteur d'horodatage (rdtsc, x86 seulement).
+
+  Distributions (degré moyen -deg) :
+    uniforme  : extrémités tirées uniformément (Erdős–Rényi)
+    puissance : R-MAT (0.57, 0.19, 0.19, 0.05), quelques sommets très chargés
+
+  Compilation :
+    gcc -Wall -Wextra -std=c11 -O2 -pthread bench_ops.c graph.c -o bench_ops
+*/
+
+#define MAX_SIZES 16
+#define MAX_TRIALS 1000
+#define MAX_DEGREE 1024
+#define MAX_EDGES 2000000000LL  /* arêtes tirées (n × deg) */
+
+/* Requêtes par essai des opérations coûteuses à l'unité */
+#define NB_PATH_QUERIES 256
+#define NB_KHOP_QUERIES 1024
+#define KHOP_HOPS 2
+#define NB_PREFIX_QUERIES 64
+#define MS_BFS_SOURCES 64
+#define MS_BFS_MAX_CELLS (1 << 26) /* distances de graph_ms_bfs : 256 Mo au plus */
+#define NAME_LEN 16
+
+/* =========================
+   Représentations et distributions
+   ========================= */
+
+struct backend {
+  const char *name;
+  int repr;
+};
+
+static const struct backend BACKENDS[] = {
+  { "list",   GRAPH_LIST },
+  { "matrix", GRAPH_MATRIX },
+  { "csr",    GRAPH_CSR },
+};
+#define NB_BACKENDS ((int)(sizeof(BACKENDS) / sizeof(BACKENDS[0])))
+
+enum { DIST_UNIFORM, DIST_RMAT, NB_DISTS };
+static const char *DIST_NAMES[NB_DISTS] = { "uniforme", "puissance" };
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-n n1,n2,...] [-deg d] [-dist uniforme|puissance] [-b <repr>] [-w n] [-r n]\n"
+          "          [-matrix-max n] [-f table|csv] [-o <fichier>] [-seed s]\n"
+          "  -n <liste>       : nombres de sommets (defaut: 1000,4000,16000)\n"
+          "  -deg d           : degre sortant moyen, de 1 a 1024 (defaut: 8)\n"
+          "  -dist <d>        : une seule distribution (defaut: les deux)\n"
+          "  -b <repr>        : une seule representation (list, matrix, csr)\n"
+          "  -w n             : essais d'echauffement, non comptes (defaut: 1)\n"
+          "  -r n             : essais mesures, on garde la mediane (defaut: 5)\n"
+          "  -matrix-max n    : ni matrice ni fermeture transitive au-dela de n sommets (defaut: 8192)\n"
+          "  -f table|csv     : tableau comparatif ou CSV (defaut: table)\n"
+          "  -o <fichier>     : fichier du rapport (defaut: stdout)\n"
+          "  -seed s          : graine des graphes aleatoires (defaut: 1)\n",
+          prog);
+}
+
+/* =========================
+   Chronométrage
+   ========================= */
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t now_cycles(void) {
+#ifdef HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/* Empêche le compilateur d'éliminer les résultats non utilisés */
+static volatile long long sink;
+
+/* =========================
+   Génération des graphes
+   ========================= */
+
+static uint64_t rng_next(uint64_t *s) {
+  /* splitmix64 */
+  uint64_t z = (*s += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static t_vertex rng_vertex(uint64_t *s, int n) {
+  return (t_vertex)(rng_next(s) % (uint64_t)n);
+}
+
+/* Couple R-MAT : on descend dans l'un des quatre quadrants à chaque bit ; les
+   sommets hors de [0, n) sont retirés */
+static void rmat_edge(uint64_t *s, int n, t_vertex *u, t_vertex *v) {
+  int bits = 0;
+  while ((1 << bits) < n) bits++;
+  do {
+    *u = 0;
+    *v = 0;
+    for (int b = 0; b < bits; b++) {
+      double p = (double)(rng_next(s) >> 11) / 9007199254740992.0;
+      int down = p >= 0.57 + 0.19;                     /* quadrants c et d */
+      int right = (p >= 0.57 && !down) || p >= 0.95;   /* quadrants b et d */
+      *u = (*u << 1) | down;
+      *v = (*v << 1) | right;
+    }
+  } while (*u >= n || *v >= n);
+}
+
+/* Charge d'une mesure : arêtes à insérer (doublons possibles, comme dans un
+   fichier), requêtes sur des arêtes présentes et sur des couples au hasard ;
+   le même graphe au format 2 (sommets nommés "s<i>") et au format binaire */
+struct workload {
+  int n;
+  int dist;
+  long long m;
+  t_vertex *from, *to;
+  float *weight;
+  long long nb_hit;
+  t_vertex *hit_from, *hit_to; /* arêtes distinctes, dans un ordre mélangé */
+  t_vertex *rnd_from, *rnd_to;
+  int *comp;
+  char *names;                 /* n noms de NAME_LEN octets */
+  FILE *text;                  /* fichier temporaire au format 2 */
+  char bin_path[64];           /* fichier temporaire au format binaire */
+};
+
+static void workload_free(struct workload *w) {
+  free(w->from);
+  free(w->to);
+  free(w->weight);
+  free(w->hit_from);
+  free(w->hit_to);
+  free(w->rnd_from);
+  free(w->rnd_to);
+  free(w->comp);
+  free(w->names);
+  if (w->text) fclose(w->text);
+  if (w->bin_path[0]) unlink(w->bin_path);
+}
+
+/* Graphe de la charge au format 2 dans un fichier temporaire anonyme, et au
+   format binaire (arêtes distinctes de g) dans bin_path */
+static int workload_files(struct workload *w, const t_graph *g) {
+  w->text = tmpfile();
+  if (!w->text) return 0;
+  fprintf(w->text, "%d n\n\n", w->n);
+  for (int v = 0; v < w->n; v++) fprintf(w->text, "%s\n", w->names + (size_t)v * NAME_LEN);
+  fprintf(w->text, "\n");
+  for (long long i = 0; i < w->m; i++) {
+    fprintf(w->text, "%s\t%s\n", w->names + (size_t)w->from[i] * NAME_LEN, w->names + (size_t)w->to[i] * NAME_LEN);
+  }
+  if (fflush(w->text) != 0) return 0;
+
+  const char *dir = getenv("TMPDIR");
+  snprintf(w->bin_path, sizeof(w->bin_path), "%s/bench_ops.XXXXXX", dir && strlen(dir) < 40 ? dir : "/tmp");
+  int fd = mkstemp(w->bin_path);
+  if (fd < 0) {
+    w->bin_path[0] = '\0';
+    return 0;
+  }
+  close(fd);
+  return graph_write_binary(g, w->bin_path);
+}
+
+static int workload_init(struct workload *w, int n, int deg, int dist, uint64_t seed) {
+  memset(w, 0, sizeof(*w));
+  w->n = n;
+  w->dist = dist;
+  w->m = (long long)n * deg;
+  size_t m = (size_t)w->m;
+  w->from = malloc(m * sizeof(*w->from));
+  w->to = malloc(m * sizeof(*w->to));
+  w->hit_from = malloc(m * sizeof(*w->hit_from));
+  w->hit_to = malloc(m * sizeof(*w->hit_to));
+  w->rnd_from = malloc(m * sizeof(*w->rnd_from));
+  w->rnd_to = malloc(m * sizeof(*w->rnd_to));
+  w->weight = malloc(m * sizeof(*w->weight));
+  w->comp = malloc((size_t)n * sizeof(*w->comp));
+  w->names = malloc((size_t)n * NAME_LEN);
+  if (!w->from || !w->to || !w->weight || !w->hit_from || !w->hit_to || !w->rnd_from || !w->rnd_to || !w->comp ||
+      !w->names) {
+    workload_free(w);
+    return 0;
+  }
+  uint64_t s = seed;
+  for (size_t i = 0; i < m; i++) {
+    if (dist == DIST_RMAT) rmat_edge(&s, n, &w->from[i], &w->to[i]);
+    else {
+      w->from[i] = rng_vertex(&s, n);
+      w->to[i] = rng_vertex(&s, n);
+    }
+    w->rnd_from[i] = rng_vertex(&s, n);
+    w->rnd_to[i] = rng_vertex(&s, n);
+  }
+
+  /* Arêtes distinctes : celles du graphe construit, parcourues puis mélangées */
+  t_graph *g = graph_new(n, 0, GRAPH_CSR);
+  if (!g) { workload_free(w); return 0; }
+  for (size_t i = 0; i < m; i++) graph_add_edge(g, w->from[i], w->to[i]);
+  long long k = 0;
+  for (t_vertex u = 0; u < n; u++) {
+    t_graph_cursor c;
+    t_vertex v;
+    graph_cursor_init(g, u, &c);
+    while (graph_cursor_next(g, u, &c, &v)) {
+      w->hit_from[k] = u;
+      w->hit_to[k] = v;
+      k++;
+    }
+  }
+  w->nb_hit = k;
+  for (int v = 0; v < n; v++) snprintf(w->names + (size_t)v * NAME_LEN, NAME_LEN, "s%d", v);
+  int files = workload_files(w, g);
+  graph_free(g);
+  if (!files) {
+    perror("fichier temporaire");
+    workload_free(w);
+    return 0;
+  }
+  for (long long i = k - 1; i > 0; i--) {
+    long long j = (long long)(rng_next(&s) % (uint64_t)(i + 1));
+    t_vertex a = w->hit_from[i], b = w->hit_to[i];
+    w->hit_from[i] = w->hit_from[j];
+    w->hit_to[i] = w->hit_to[j];
+    w->hit_from[j] = a;
+    w->hit_to[j] = b;
+  }
+  /* Poids dans [1, 10), tirés après le reste pour garder les mêmes graphes */
+  for (size_t i = 0; i < m; i++) w->weight[i] = 1.0f + (float)(rng_next(&s) % 9000) / 1000.0f;
+  return 1;
+}
+
+static t_graph *build(const struct workload *w, int repr) {
+  t_graph *g = graph_new(w->n, 0, repr);
+  if (!g) return NULL;
+  for (long long i = 0; i < w->m; i++) graph_add_edge(g, w->from[i], w->to[i]);
+  return g;
+}
+
+/* =========================
+   Opérations mesurées
+   ========================= */
+
+/* État d'un essai : g est préparé par setup (hors chronométrage), run effectue
+   l'opération et retourne le nombre d'opérations élémentaires (négatif en cas
+   d'échec) ; ce qui reste dans g, extra (transposé, résultat), ws et buf est
+   libéré après l'essai */
+struct trial {
+  const struct workload *w;
+  int repr;
+  t_graph *g;
+  t_graph *extra;
+  t_path_ws *ws;
+  void *buf;
+};
+
+static void trial_clear(struct trial *t) {
+  graph_free(t->extra);
+  graph_free(t->g);
+  graph_path_ws_free(t->ws);
+  free(t->buf);
+  t->g = t->extra = NULL;
+  t->ws = NULL;
+  t->buf = NULL;
+}
+
+static void setup_none(struct trial *t) { (void)t; }
+static void setup_empty(struct trial *t) { t->g = graph_new(t->w->n, 0, t->repr); }
+static void setup_built(struct trial *t) { t->g = build(t->w, t->repr); }
+
+static void setup_weighted(struct trial *t) {
+  t->g = graph_new(t->w->n, 0, t->repr);
+  if (!t->g) return;
+  for (long long i = 0; i < t->w->m; i++) graph_add_weighted_edge(t->g, t->w->from[i], t->w->to[i], t->w->weight[i]);
+}
+
+/* Graphe sans circuit : chaque arête tirée va du plus petit au plus grand numéro */
+static void setup_dag(struct trial *t) {
+  t->g = graph_new(t->w->n, 0, t->repr);
+  if (!t->g) return;
+  for (long long i = 0; i < t->w->m; i++) {
+    t_vertex u = t->w->from[i], v = t->w->to[i];
+    if (u < v) graph_add_edge(t->g, u, v);
+    else if (v < u) graph_add_edge(t->g, v, u);
+  }
+}
+
+/* Graphe construit et fusionné, puis une arête sur deux retirée et remise :
+   en CSR, autant de modifications en attente pour graph_compact */
+static void setup_pending(struct trial *t) {
+  setup_built(t);
+  if (!t->g) return;
+  graph_compact(t->g);
+  for (long long i = 0; i < t->w->nb_hit; i += 2) graph_remove_edge(t->g, t->w->hit_from[i], t->w->hit_to[i]);
+  for (long long i = 0; i < t->w->nb_hit; i += 4) graph_add_edge(t->g, t->w->hit_from[i], t->w->hit_to[i]);
+}
+
+/* Graphe construit et son transposé */
+static void setup_with_rev(struct trial *t) {
+  setup_built(t);
+  if (t->g) t->extra = graph_reverse(t->g);
+  if (!t->extra) trial_clear(t);
+}
+
+/* Graphe (pondéré ou non), espace de travail des chemins et tampon de n sommets */
+static void path_buffers(struct trial *t) {
+  if (!t->g) return;
+  t->ws = graph_path_ws_new(t->w->n);
+  t->buf = malloc((size_t)t->w->n * sizeof(t_vertex));
+  if (!t->ws || !t->buf) trial_clear(t);
+}
+
+static void setup_paths(struct trial *t) {
+  setup_weighted(t);
+  path_buffers(t);
+}
+
+static void setup_khop(struct trial *t) {
+  setup_with_rev(t);
+  path_buffers(t);
+}
+
+static void setup_trim(struct trial *t) {
+  setup_with_rev(t);
+  if (!t->g) return;
+  t->buf = malloc((size_t)t->w->n * sizeof(t_vertex));
+  if (!t->buf) trial_clear(t);
+}
+
+static void setup_topo(struct trial *t) {
+  setup_dag(t);
+  if (!t->g) return;
+  t->buf = malloc((size_t)t->w->n * sizeof(t_vertex));
+  if (!t->buf) trial_clear(t);
+}
+
+static void setup_pagerank(struct trial *t) {
+  setup_with_rev(t);
+  if (!t->g) return;
+  t->buf = malloc((size_t)t->w->n * sizeof(double));
+  if (!t->buf) trial_clear(t);
+}
+
+static int ms_bfs_sources(const struct workload *w) {
+  int k = MS_BFS_MAX_CELLS / w->n;
+  return k < 1 ? 1 : (k > MS_BFS_SOURCES ? MS_BFS_SOURCES : k);
+}
+
+static void setup_ms_bfs(struct trial *t) {
+  setup_built(t);
+  if (!t->g) return;
+  t->buf = malloc((size_t)ms_bfs_sources(t->w) * (size_t)t->w->n * sizeof(int));
+  if (!t->buf) trial_clear(t);
+}
+
+/* Graphe nommé, lu au format 2 (réserve de noms), ou passé au dictionnaire */
+static void setup_named(struct trial *t) {
+  FILE *in = t->w->text;
+  rewind(in);
+  t->g = graph_read_format2_file(in, t->repr);
+}
+
+static void setup_named_dict(struct trial *t) {
+  setup_named(t);
+  if (t->g && !graph_compress_names(t->g)) trial_clear(t);
+}
+
+static long long run_new(struct trial *t) {
+  t->g = graph_new(t->w->n, 0, t->repr);
+  return 1;
+}
+
+static long long run_add(struct trial *t) {
+  for (long long i = 0; i < t->w->m; i++) graph_add_edge(t->g, t->w->from[i], t->w->to[i]);
+  return t->w->m;
+}
+
+static long long run_add_weighted(struct trial *t) {
+  for (long long i = 0; i < t->w->m; i++) graph_add_weighted_edge(t->g, t->w->from[i], t->w->to[i], t->w->weight[i]);
+  return t->w->m;
+}
+
+static long long run_has_hit(struct trial *t) {
+  long long found = 0;
+  for (long long i = 0; i < t->w->nb_hit; i++) found += graph_has_edge(t->g, t->w->hit_from[i], t->w->hit_to[i]);
+  sink = found;
+  return t->w->nb_hit;
+}
+
+static long long run_has_rand(struct trial *t) {
+  long long found = 0;
+  for (long long i = 0; i < t->w->m; i++) found += graph_has_edge(t->g, t->w->rnd_from[i], t->w->rnd_to[i]);
+  sink = found;
+  return t->w->m;
+}
+
+static void sum_cb(t_vertex v, void *ctx) {
+  *(long long *)ctx += v;
+}
+
+static long long run_for_each(struct trial *t) {
+  long long sum = 0;
+  for (t_vertex u = 0; u < t->w->n; u++) graph_for_each_succ(t->g, u, sum_cb, &sum);
+  sink = sum;
+  return t->w->nb_hit;
+}
+
+static void weight_cb(t_vertex v, float w, void *ctx) {
+  *(double *)ctx += v + w;
+}
+
+static long long run_for_each_weighted(struct trial *t) {
+  double sum = 0;
+  for (t_vertex u = 0; u < t->w->n; u++) graph_for_each_succ_weighted(t->g, u, weight_cb, &sum);
+  sink = (long long)sum;
+  return t->w->nb_hit;
+}
+
+static long long run_cursor(struct trial *t) {
+  long long sum = 0;
+  for (t_vertex u = 0; u < t->w->n; u++) {
+    t_graph_cursor c;
+    t_vertex v;
+    graph_cursor_init(t->g, u, &c);
+    while (graph_cursor_next(t->g, u, &c, &v)) sum += v;
+  }
+  sink = sum;
+  return t->w->nb_hit;
+}
+
+static long long run_reverse(struct trial *t) {
+  t->extra = graph_reverse(t->g);
+  return 1;
+}
+
+static long long run_remove(struct trial *t) {
+  long long removed = 0;
+  for (long long i = 0; i < t->w->nb_hit; i++) removed += graph_remove_edge(t->g, t->w->hit_from[i], t->w->hit_to[i]);
+  sink = removed;
+  return t->w->nb_hit;
+}
+
+static long long run_compact(struct trial *t) {
+  graph_compact(t->g);
+  return 1;
+}
+
+/* Noms de n sommets tirés au hasard */
+static long long run_vertex_name(struct trial *t) {
+  long long len = 0;
+  for (int i = 0; i < t->w->n; i++) len += (long long)strlen(graph_vertex_name(t->g, t->w->rnd_from[i]));
+  sink = len;
+  return t->w->n;
+}
+
+static long long run_from_name(struct trial *t) {
+  long long sum = 0;
+  for (int i = 0; i < t->w->n; i++) sum += graph_vertex_from_name(t->g, t->w->names + (size_t)t->w->rnd_from[i] * NAME_LEN);
+  sink = sum;
+  return t->w->n;
+}
+
+/* Préfixes : nom d'un sommet au hasard sans ses deux derniers chiffres ("s12"
+   pour s1234, environ n / 100 réponses) */
+static long long run_prefix(struct trial *t) {
+  long long found = 0;
+  for (int i = 0; i < NB_PREFIX_QUERIES; i++) {
+    char prefix[NAME_LEN];
+    snprintf(prefix, sizeof(prefix), "%s", t->w->names + (size_t)t->w->rnd_from[i % t->w->n] * NAME_LEN);
+    size_t len = strlen(prefix);
+    prefix[len > 3 ? len - 2 : 2] = '\0';
+    found += graph_vertices_with_prefix(t->g, prefix, NULL);
+  }
+  sink = found;
+  return NB_PREFIX_QUERIES;
+}
+
+static long long run_compress_names(struct trial *t) {
+  return graph_compress_names(t->g) ? 1 : -1;
+}
+
+static long long run_scc(struct trial *t) {
+  sink = graph_scc(t->g, t->w->comp);
+  return 1;
+}
+
+static long long run_trim(struct trial *t) {
+  t_trim r = graph_trim(t->g, t->extra, t->w->comp, t->buf);
+  sink = r.nb_core;
+  return 1;
+}
+
+static long long run_wcc(struct trial *t) {
+  sink = graph_wcc(t->g, t->w->comp, NULL, 1);
+  return 1;
+}
+
+static long long run_toposort(struct trial *t) {
+  int len = 0;
+  sink = graph_toposort(t->g, t->buf, &len);
+  return 1;
+}
+
+static long long run_closure(struct trial *t) {
+  t_bitmatrix *bm = graph_transitive_closure(t->g);
+  if (!bm) return -1;
+  sink = bitmatrix_get(bm, 0, t->w->n - 1);
+  bitmatrix_free(bm);
+  return 1;
+}
+
+/* PageRank à un fil, temps par itération */
+static long long run_pagerank(struct trial *t) {
+  int it = graph_pagerank(t->g, t->extra, 0.85, 1e-6, 100, 1, t->buf);
+  return it < 0 ? 100 : it;
+}
+
+static long long run_shortest_path(struct trial *t) {
+  double total = 0;
+  for (int i = 0; i < NB_PATH_QUERIES; i++) {
+    int len = 0;
+    double d = graph_shortest_path(t->g, t->ws, t->w->rnd_from[i % t->w->m], t->w->rnd_to[i % t->w->m], t->buf, &len);
+    if (d > 0) total += d;
+  }
+  sink = (long long)total;
+  return NB_PATH_QUERIES;
+}
+
+/* Temps par source (une requête), jusqu'à MS_BFS_SOURCES sources parcourues ensemble */
+static long long run_ms_bfs(struct trial *t) {
+  int k = ms_bfs_sources(t->w);
+  t_vertex sources[MS_BFS_SOURCES];
+  for (int i = 0; i < k; i++) sources[i] = t->w->rnd_from[i % t->w->m];
+  graph_ms_bfs(t->g, sources, k, t->buf);
+  sink = ((int *)t->buf)[t->w->n - 1];
+  return k;
+}
+
+/* Voisinage à KHOP_HOPS arcs, dans les deux sens */
+static long long run_khop(struct trial *t) {
+  long long reached = 0;
+  for (int i = 0; i < NB_KHOP_QUERIES; i++) {
+    reached += graph_khop(t->g, t->extra, t->ws, t->w->rnd_from[i % t->w->m], KHOP_HOPS, t->buf);
+  }
+  sink = reached;
+  return NB_KHOP_QUERIES;
+}
+
+/* Sous-graphe induit par le voisinage d'un sommet : temps par sommet retenu */
+static long long run_induced(struct trial *t) {
+  int k = graph_khop(t->g, t->extra, t->ws, t->w->rnd_from[0], KHOP_HOPS, t->buf);
+  t_graph *sub = graph_induced_subgraph(t->g, t->ws, t->buf, k);
+  if (!sub) return -1;
+  graph_free(sub);
+  return k;
+}
+
+static long long run_write_binary(struct trial *t) {
+  return graph_write_binary(t->g, t->w->bin_path) ? t->w->nb_hit : -1;
+}
+
+static long long run_read_binary(struct trial *t) {
+  t->g = graph_read_binary(t->w->bin_path, t->repr);
+  return t->g ? t->w->nb_hit : -1;
+}
+
+static long long run_free(struct trial *t) {
+  graph_free(t->g);
+  t->g = NULL;
+  return 1;
+}
+
+struct op {
+  const char *name;
+  const char *unit;  /* opération élémentaire : arete, requete, sommet, iteration, appel */
+  int quadratic;     /* mémoire en O(n²) au pire : pas au-delà de -matrix-max */
+  void (*setup)(struct trial *t);
+  long long (*run)(struct trial *t);
+};
+
+static const struct op OPS[] = {
+  { "graph_new",                       "appel",     0, setup_none,       run_new },
+  { "graph_add_edge",                  "arete",     0, setup_empty,      run_add },
+  { "graph_add_weighted_edge",         "arete",     0, setup_empty,      run_add_weighted },
+  { "graph_has_edge/oui",              "requete",   0, setup_built,      run_has_hit },
+  { "graph_has_edge/alea",             "requete",   0, setup_built,      run_has_rand },
+  { "graph_for_each_succ",             "arete",     0, setup_built,      run_for_each },
+  { "graph_for_each_succ_weighted",    "arete",     0, setup_weighted,   run_for_each_weighted },
+  { "graph_cursor_next",               "arete",     0, setup_built,      run_cursor },
+  { "graph_reverse",                   "appel",     0, setup_built,      run_reverse },
+  { "graph_remove_edge",               "arete",     0, setup_built,      run_remove },
+  { "graph_compact",                   "appel",     0, setup_pending,    run_compact },
+  { "graph_vertex_name",               "requete",   0, setup_named,      run_vertex_name },
+  { "graph_vertex_name/dict",          "requete",   0, setup_named_dict, run_vertex_name },
+  { "graph_vertex_from_name",          "requete",   0, setup_named,      run_from_name },
+  { "graph_vertex_from_name/dict",     "requete",   0, setup_named_dict, run_from_name },
+  { "graph_vertices_with_prefix",      "requete",   0, setup_named,      run_prefix },
+  { "graph_vertices_with_prefix/dict", "requete",   0, setup_named_dict, run_prefix },
+  { "graph_compress_names",            "appel",     0, setup_named,      run_compress_names },
+  { "graph_scc",                       "appel",     0, setup_built,      run_scc },
+  { "graph_trim",                      "appel",     0, setup_trim,       run_trim },
+  { "graph_wcc",                       "appel",     0, setup_built,      run_wcc },
+  { "graph_toposort",                  "appel",     0, setup_topo,       run_toposort },
+  { "graph_transitive_closure",        "appel",     1, setup_built,      run_closure },
+  { "graph_pagerank",                  "iteration", 0, setup_pagerank,   run_pagerank },
+  { "graph_shortest_path",             "requete",   0, setup_paths,      run_shortest_path },
+  { "graph_ms_bfs",                    "requete",   0, setup_ms_bfs,     run_ms_bfs },
+  { "graph_khop",                      "requete",   0, setup_khop,       run_khop },
+  { "graph_induced_subgraph",          "sommet",    0, setup_khop,       run_induced },
+  { "graph_write_binary",              "arete",     0, setup_built,      run_write_binary },
+  { "graph_read_binary",               "arete",     0, setup_none,       run_read_binary },
+  { "graph_free",                      "appel",     0, setup_built,      run_free },
+};
+#define NB_OPS ((int)(sizeof(OPS) / sizeof(OPS[0])))
+
+/* Résultat d'une mesure, par opération élémentaire */
+struct measure {
+  int status; /* 0 : mesuré, 1 : non mesuré (au-delà de -matrix-max), 2 : échec */
+  double ns_min, ns_med, ns_max;
+  double cycles_med;
+};
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static void measure_op(const struct op *op, const struct workload *w, int repr, int warmup, int trials,
+                       struct measure *res) {
+  double ns[MAX_TRIALS], cyc[MAX_TRIALS];
+  memset(res, 0, sizeof(*res));
+  for (int i = 0; i < warmup + trials; i++) {
+    struct trial t = { w, repr, NULL, NULL, NULL, NULL };
+    op->setup(&t);
+    if (op->setup != setup_none && t.g == NULL) { res->status = 2; return; }
+    uint64_t c0 = now_cycles();
+    uint64_t t0 = now_ns();
+    long long count = op->run(&t);
+    uint64_t t1 = now_ns();
+    uint64_t c1 = now_cycles();
+    trial_clear(&t);
+    if (count < 0) { res->status = 2; return; }
+    if (count == 0) count = 1;
+    if (i >= warmup) {
+      ns[i - warmup] = (double)(t1 - t0) / (double)count;
+      cyc[i - warmup] = (double)(c1 - c0) / (double)count;
+    }
+  }
+  qsort(ns, (size_t)trials, sizeof(ns[0]), cmp_double);
+  qsort(cyc, (size_t)trials, sizeof(cyc[0]), cmp_double);
+  res->ns_min = ns[0];
+  res->ns_med = ns[trials / 2];
+  res->ns_max = ns[trials - 1];
+  res->cycles_med = cyc[trials / 2];
+}
+
+/* =========================
+   Rapport
+   ========================= */
+
+/* Temps lisible : ns, us ou ms selon la grandeur */
+static void format_time(char *buf, size_t cap, double ns) {
+  if (ns < 1e3) snprintf(buf, cap, "%.1f ns", ns);
+  else if (ns < 1e6) snprintf(buf, cap, "%.1f us", ns / 1e3);
+  else snprintf(buf, cap, "%.2f ms", ns / 1e6);
+}
+
+static void report_header(FILE *out, int csv, const int *enabled) {
+  if (csv) {
+    fprintf(out, "op,unit,vertices,edges,distribution,backend,status,ns_min,ns_median,ns_max,cycles_median\n");
+    return;
+  }
+  fprintf(out, "%-31s %-9s %7s %-9s", "operation", "unite", "n", "degres");
+  for (int b = 0; b < NB_BACKENDS; b++) {
+    if (enabled[b]) fprintf(out, "  %-26s", BACKENDS[b].name);
+  }
+  fprintf(out, "\n");
+}
+
+/* Une ligne par (opération, taille, distribution) ; en tableau, la représentation
+   la plus rapide est marquée d'une étoile */
+static void report_row(FILE *out, int csv, const struct op *op, const struct workload *w,
+                       const int *enabled, const struct measure *res) {
+  if (csv) {
+    for (int b = 0; b < NB_BACKENDS; b++) {
+      if (!enabled[b]) continue;
+      const struct measure *r = &res[b];
+      fprintf(out, "%s,%s,%d,%lld,%s,%s,%s,%.3f,%.3f,%.3f,%.1f\n", op->name, op->unit, w->n, w->nb_hit,
+              DIST_NAMES[w->dist], BACKENDS[b].name,
+              r->status == 0 ? "ok" : (r->status == 1 ? "skipped" : "failed"),
+              r->ns_min, r->ns_med, r->ns_max, r->cycles_med);
+    }
+    fflush(out);
+    return;
+  }
+  int best = -1;
+  for (int b = 0; b < NB_BACKENDS; b++) {
+    if (enabled[b] && res[b].status == 0 && (best < 0 || res[b].ns_med < res[best].ns_med)) best = b;
+  }
+  fprintf(out, "%-31s %-9s %7d %-9s", op->name, op->unit, w->n, DIST_NAMES[w->dist]);
+  for (int b = 0; b < NB_BACKENDS; b++) {
+    if (!enabled[b]) continue;
+    char cell[64], t[24];
+    if (res[b].status == 1) snprintf(cell, sizeof(cell), "-");
+    else if (res[b].status == 2) snprintf(cell, sizeof(cell), "echec");
+    else {
+      format_time(t, sizeof(t), res[b].ns_med);
+#ifdef HAVE_TSC
+      snprintf(cell, sizeof(cell), "%s%s (%.0f c)", b == best ? "*" : "", t, res[b].cycles_med);
+#else
+      snprintf(cell, sizeof(cell), "%s%s", b == best ? "*" : "", t);
+#endif
+    }
+    fprintf(out, "  %-26s", cell);
+  }
+  fprintf(out, "\n");
+  fflush(out);
+}
+
+/* =========================
+   Main
+   ========================= */
+
+/* Entier décimal dans [min, max], sans caractère en trop */
+static int parse_int(const char *s, long min, long max, int *out) {
+  char *end = NULL;
+  errno = 0;
+  long v = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || errno != 0 || v < min || v > max) return 0;
+  *out = (int)v;
+  return 1;
+}
+
+/* "1000,4000" -> tailles ; retourne leur nombre, 0 si la liste est invalide */
+static int parse_sizes(const char *s, int *sizes) {
+  int nb = 0;
+  while (*s) {
+    char *end = NULL;
+    long v = strtol(s, &end, 10);
+    if (end == s || v < 1 || v > 100000000L || nb == MAX_SIZES) return 0;
+    sizes[nb++] = (int)v;
+    s = end;
+    if (*s == ',') s++;
+    else if (*s != '\0') return 0;
+  }
+  return nb;
+}
+
+int main(int argc, char **argv) {
+  int sizes[MAX_SIZES] = { 1000, 4000, 16000 };
+  int nb_sizes = 3;
+  int deg = 8, warmup = 1, trials = 5, matrix_max = 8192, csv = 0;
+  int only_dist = -1;
+  const char *only = NULL, *out_path = NULL;
+  uint64_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    int ok = 1;
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      nb_sizes = parse_sizes(argv[++i], sizes);
+      if (nb_sizes == 0) { usage(argv[0]); return 1; }
+    } else if (!strcmp(argv[i], "-deg") && i + 1 < argc) ok = parse_int(argv[++i], 1, MAX_DEGREE, &deg);
+    else if (!strcmp(argv[i], "-w") && i + 1 < argc) ok = parse_int(argv[++i], 0, MAX_TRIALS, &warmup);
+    else if (!strcmp(argv[i], "-r") && i + 1 < argc) ok = parse_int(argv[++i], 1, MAX_TRIALS, &trials);
+    else if (!strcmp(argv[i], "-matrix-max") && i + 1 < argc) ok = parse_int(argv[++i], 0, 100000000L, &matrix_max);
+    else if (!strcmp(argv[i], "-b") && i + 1 < argc) only = argv[++i];
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc) out_path = argv[++i];
+    else if (!strcmp(argv[i], "-seed") && i + 1 < argc) {
+      const char *a = argv[++i];
+      char *end = NULL;
+      errno = 0;
+      seed = strtoull(a, &end, 10);
+      ok = end != a && *end == '\0' && errno == 0 && a[0] != '-';
+    }
+    else if (!strcmp(argv[i], "-dist") && i + 1 < argc) {
+      const char *d = argv[++i];
+      for (int k = 0; k < NB_DISTS; k++) if (!strcmp(d, DIST_NAMES[k])) only_dist = k;
+      if (only_dist < 0) { usage(argv[0]); return 1; }
+    } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      const char *f = argv[++i];
+      if (!strcmp(f, "csv")) csv = 1;
+      else if (!strcmp(f, "table")) csv = 0;
+      else { usage(argv[0]); return 1; }
+    } else ok = 0;
+    if (!ok) { usage(argv[0]); return 1; }
+  }
+
+  int enabled[NB_BACKENDS];
+  int nb_enabled = 0;
+  for (int b = 0; b < NB_BACKENDS; b++) {
+    enabled[b] = only == NULL || strcmp(only, BACKENDS[b].name) == 0;
+    nb_enabled += enabled[b];
+  }
+  if (nb_enabled == 0) { usage(argv[0]); return 1; }
+
+  FILE *out = stdout;
+  if (out_path) {
+    out = fopen(out_path, "w");
+    if (!out) { perror("fopen -o"); return 1; }
+  }
+
+  report_header(out, csv, enabled);
+  for (int s = 0; s < nb_sizes; s++) {
+    for (int d = 0; d < NB_DISTS; d++) {
+      if (only_dist >= 0 && d != only_dist) continue;
+      struct workload w;
+      if ((long long)sizes[s] * deg > MAX_EDGES) {
+        fprintf(stderr, "Trop d'aretes pour n = %d : n x deg depasse %lld\n", sizes[s], MAX_EDGES);
+        continue;
+      }
+      if (!workload_init(&w, sizes[s], deg, d, seed)) {
+        fprintf(stderr, "Memoire insuffisante pour n = %d\n", sizes[s]);
+        continue;
+      }
+      for (int o = 0; o < NB_OPS; o++) {
+        struct measure res[NB_BACKENDS];
+        for (int b = 0; b < NB_BACKENDS; b++) {
+          if (!enabled[b]) continue;
+          if ((BACKENDS[b].repr == GRAPH_MATRIX || OPS[o].quadratic) && w.n > matrix_max) {
+            memset(&res[b], 0, sizeof(res[b]));
+            res[b].status = 1;
+            continue;
+          }
+          measure_op(&OPS[o], &w, BACKENDS[b].repr, warmup, trials, &res[b]);
+        }
+        report_row(out, csv, &OPS[o], &w, enabled, res);
+      }
+      workload_free(&w);
+    }
+  }
+
+  if (out != stdout) fclose(out);
+  return 0;
+}
@@ -11,10 +11,19 @@
   Deux versions attendues (représentation interne du graphe) :
     - Matrice d'adjacence  : USE_MATRIX=1
     - Listes d'adjacence   : USE_MATRIX=0
+  L'option -repr list|matrix|csr|auto remplace ce choix à l'exécution ; avec auto,
+  la représentation retenue est indiquée sur stderr.
+  Avec -center <sommet> -hops k, seul le voisinage de ce sommet à au plus k arcs
+  (sortants et entrants) est écrit : graph_khop puis graph_induced_subgraph.
+  Avec -prefix <p> (format 2), seuls les sommets dont le nom commence par p sont
+  écrits, avec les arcs entre eux ; les noms sont alors lus dans le dictionnaire
+  compressé (graph_set_name_dict), qui trouve ces sommets sans parcourir les autres.
 
   Compilation :
-    gcc -Wall -Wextra -std=c11 -O2 fil_rouge_1.c graph.c -DUSE_MATRIX=1 -o fil_rouge_1_matrix
-    gcc -Wall -Wextra -std=c11 -O2 fil_rouge_1.c graph.c -DUSE_MATRIX=0 -o fil_rouge_1_list
+    gcc -Wall -Wextra -std=c11 -O2 -pthread fil_rouge_1.c graph.c -DUSE_MATRIX=1 -o fil_rouge_1_matrix
+    gcc -Wall -Wextra -std=c11 -O2 -pthread fil_rouge_1.c graph.c -DUSE_MATRIX=0 -o fil_rouge_1_list
+
+  Instrumentation (optionnelle) : ajouter -DGRAPH_STATS puis lancer avec GRAPH_STATS=1
 */
 
 #ifndef USE_MATRIX
@@ -29,10 +38,14 @@
 
 static void usage(const char *prog) {
   fprintf(stderr,
-          "Usage: %s [-i <graph_file>] [-o <dot_file>]\n"
+          "Usage: %s [-i <graph_file>] [-o <dot_file>] [-repr list|matrix|csr|auto] [-center <sommet> [-hops k] | -prefix <p>]\n"
           "  -i <graph_file> : fichier de graphe en entree (defaut: stdin)\n"
-          "  -o <dot_file>   : fichier DOT en sortie (defaut: stdout)\n",
-          prog);
+          "  -o <dot_file>   : fichier DOT en sortie (defaut: stdout)\n"
+          "  -repr <r>       : representation interne (defaut: %s)\n"
+          "  -center <s>     : n'ecrire que le voisinage du sommet s (numero ou nom)\n"
+          "  -hops k         : rayon du voisinage en arcs, sortants et entrants (defaut: 1)\n"
+          "  -prefix <p>     : n'ecrire que les sommets dont le nom commence par p (format 2)\n",
+          prog, graph_representation_name(USE_MATRIX ? GRAPH_MATRIX : GRAPH_LIST));
 }
 
 /* =========================
@@ -115,9 +128,15 @@ static void dot_print_escaped(FILE *out, const char *s) {
 struct dot_ctx {
   FILE *out;
   const t_graph *g;
+  const t_vertex *ids; /* numéro d'origine de chaque sommet (sous-graphe), ou NULL */
   t_vertex from;
 };
 
+/* Sommet sans nom : son numéro dans le graphe d'origine */
+static t_vertex dot_id(const struct dot_ctx *ctx, t_vertex v) {
+  return ctx->ids ? ctx->ids[v] : v;
+}
+
 /* Callback appelé pour chaque successeur `to` du sommet `from` */
 static void dot_succ_cb(t_vertex to, void *ctx_void) {
   struct dot_ctx *ctx = (struct dot_ctx*)ctx_void;
@@ -132,17 +151,27 @@ static void dot_succ_cb(t_vertex to, void *ctx_void) {
     dot_print_escaped(ctx->out, b ? b : "");
     fputs(";\n", ctx->out);
   } else {
-    fprintf(ctx->out, "  %d -> %d;\n", ctx->from, to);
+    fprintf(ctx->out, "  %d -> %d;\n", dot_id(ctx, ctx->from), dot_id(ctx, to));
   }
 }
 
-/* Produit le graphe au format DOT */
-static void write_dot(FILE *out, const t_graph *g) {
+/* Produit le graphe au format DOT ; pour un sous-graphe (ids non NULL), les
+   sommets sont aussi déclarés, pour que les sommets isolés apparaissent */
+static void write_dot(FILE *out, const t_graph *g, const t_vertex *ids) {
   fprintf(out, "digraph nom_du_graphe {\n");
 
   struct dot_ctx ctx;
   ctx.out = out;
   ctx.g = g;
+  ctx.ids = ids;
+
+  for (t_vertex u = 0; ids && u < graph_size(g); u++) {
+    const char *name = graph_vertex_name(g, u);
+    fputs("  ", out);
+    if (graph_has_names(g)) dot_print_escaped(out, name ? name : "");
+    else fprintf(out, "%d", ids[u]);
+    fputs(";\n", out);
+  }
 
   for (t_vertex u = 0; u < graph_size(g); u++) {
     ctx.from = u;
@@ -152,6 +181,81 @@ static void write_dot(FILE *out, const t_graph *g) {
   fprintf(out, "}\n");
 }
 
+/* =========================
+   Voisinage d'un sommet
+   ========================= */
+
+/* Sommet donné par son nom (graphe nommé) ou par son numéro */
+static int parse_vertex(const t_graph *g, const char *s, t_vertex *out) {
+  if (graph_has_names(g)) {
+    t_vertex v = graph_vertex_from_name(g, s);
+    if (v >= 0) { *out = v; return 1; }
+  }
+  char *end = NULL;
+  long val = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || val < 0 || val >= graph_size(g)) return 0;
+  *out = (t_vertex)val;
+  return 1;
+}
+
+/* Écrit le sous-graphe induit par les sommets à au plus `hops` arcs de `center` */
+static int write_region(FILE *out, const t_graph *g, const char *center_s, int hops) {
+  t_vertex center;
+  if (!parse_vertex(g, center_s, &center)) {
+    fprintf(stderr, "Sommet central invalide: %s\n", center_s);
+    return 0;
+  }
+  t_graph *rev = graph_reverse(g);
+  t_path_ws *ws = graph_path_ws_new(graph_size(g));
+  t_vertex *region = malloc((size_t)graph_size(g) * sizeof(*region));
+  if (!region) {
+    fprintf(stderr, "Erreur: mémoire insuffisante.\n");
+    graph_path_ws_free(ws);
+    graph_free(rev);
+    return 0;
+  }
+  int n = graph_khop(g, rev, ws, center, hops, region);
+  t_graph *sub = graph_induced_subgraph(g, ws, region, n);
+  write_dot(out, sub, region);
+  fprintf(stderr, "Voisinage a %d arcs : %d sommets\n", hops, n);
+
+  graph_free(sub);
+  free(region);
+  graph_path_ws_free(ws);
+  graph_free(rev);
+  return 1;
+}
+
+/* Écrit le sous-graphe induit par les sommets dont le nom commence par `prefix` */
+static int write_prefix(FILE *out, const t_graph *g, const char *prefix) {
+  if (!graph_has_names(g)) {
+    fprintf(stderr, "Erreur: -prefix demande un graphe au format 2.\n");
+    return 0;
+  }
+  t_path_ws *ws = graph_path_ws_new(graph_size(g));
+  t_vertex *region = malloc((size_t)graph_size(g) * sizeof(*region));
+  if (!region) {
+    fprintf(stderr, "Erreur: mémoire insuffisante.\n");
+    graph_path_ws_free(ws);
+    return 0;
+  }
+  int n = graph_vertices_with_prefix(g, prefix, region);
+  if (n == 0) {
+    fprintf(stderr, "Aucun sommet ne commence par \"%s\"\n", prefix);
+    free(region);
+    graph_path_ws_free(ws);
+    return 0;
+  }
+  t_graph *sub = graph_induced_subgraph(g, ws, region, n);
+  write_dot(out, sub, region);
+  fprintf(stderr, "Prefixe \"%s\" : %d sommets\n", prefix, n);
+
+  graph_free(sub);
+  free(region);
+  graph_path_ws_free(ws);
+  return 1;
+}
+
 /* =========================
    Main
    ========================= */
@@ -159,6 +263,10 @@ static void write_dot(FILE *out, const t_graph *g) {
 int main(int argc, char **argv) {
   const char *in_path = NULL;
   const char *out_path = NULL;
+  const char *center_s = NULL;
+  const char *prefix = NULL;
+  int hops = 1;
+  int repr = USE_MATRIX ? GRAPH_MATRIX : GRAPH_LIST;
 
   /* --- Parsing des arguments --- */
   for (int i = 1; i < argc; i++) {
@@ -168,11 +276,28 @@ int main(int argc, char **argv) {
     } else if (strcmp(argv[i], "-o") == 0) {
       if (i + 1 >= argc) { usage(argv[0]); return 1; }
       out_path = argv[++i];
+    } else if (strcmp(argv[i], "-repr") == 0) {
+      if (i + 1 >= argc) { usage(argv[0]); return 1; }
+      repr = graph_representation_from_name(argv[++i]);
+      if (repr == GRAPH_REPR_INVALID) { usage(argv[0]); return 1; }
+    } else if (strcmp(argv[i], "-center") == 0) {
+      if (i + 1 >= argc) { usage(argv[0]); return 1; }
+      center_s = argv[++i];
+    } else if (strcmp(argv[i], "-hops") == 0) {
+      if (i + 1 >= argc) { usage(argv[0]); return 1; }
+      char *end = NULL;
+      hops = (int)strtol(argv[++i], &end, 10);
+      if (end == argv[i] || *end != '\0' || hops < 0) { usage(argv[0]); return 1; }
+    } else if (strcmp(argv[i], "-prefix") == 0) {
+      if (i + 1 >= argc) { usage(argv[0]); return 1; }
+      prefix = argv[++i];
     } else {
       usage(argv[0]);
       return 1;
     }
   }
+  if (center_s && prefix) { usage(argv[0]); return 1; }
+  if (prefix) graph_set_name_dict(1);
 
   FILE *in = stdin;
   FILE *out = stdout;
@@ -213,16 +338,16 @@ int main(int argc, char **argv) {
     }
 
     g = (fmt == 2)
-        ? graph_read_format2_file(tmp, (t_bool)USE_MATRIX)
-        : graph_read_format1_file(tmp, (t_bool)USE_MATRIX);
+        ? graph_read_format2_file(tmp, repr)
+        : graph_read_format1_file(tmp, repr);
 
     fclose(tmp);
   } else {
     /* Fichier : on peut rewind et relire depuis le début */
     rewind(in);
     g = (fmt == 2)
-        ? graph_read_format2_file(in, (t_bool)USE_MATRIX)
-        : graph_read_format1_file(in, (t_bool)USE_MATRIX);
+        ? graph_read_format2_file(in, repr)
+        : graph_read_format1_file(in, repr);
   }
 
   if (!g) {
@@ -231,14 +356,22 @@ int main(int argc, char **argv) {
     if (out != stdout) fclose(out);
     return 1;
   }
+  if (repr == GRAPH_AUTO) {
+    fprintf(stderr, "Representation choisie : %s\n", graph_representation_name(graph_representation(g)));
+  }
 
   /* --- Écriture DOT --- */
-  write_dot(out, g);
+  int ok = 1;
+  graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+  if (center_s) ok = write_region(out, g, center_s, hops);
+  else if (prefix) ok = write_prefix(out, g, prefix);
+  else write_dot(out, g, NULL);
+  graph_stats_phase_end(GRAPH_PHASE_ALGO);
 
   /* --- Nettoyage --- */
   graph_free(g);
   if (in != stdin) fclose(in);
   if (out != stdout) fclose(out);
 
-  return 0;
+  return ok ? 0 : 1;
 }
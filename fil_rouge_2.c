@@ -11,7 +11,11 @@
 ========================
  Compilation
 ========================
-gcc -Wall -Wextra -std=c11 -O2 fil_rouge_2.c graph.c base_fil_rouge.c \-o fil_rouge_2 -o fil_rouge_2
+gcc -Wall -Wextra -std=c11 -O2 -pthread fil_rouge_2.c graph.c -o fil_rouge_2
+
+La representation (list, matrix, csr, auto) se choisit a l'execution avec -repr.
+
+Instrumentation (optionnelle) : ajouter -DGRAPH_STATS puis lancer avec GRAPH_STATS=1
 */
 
 /*
@@ -19,45 +23,38 @@ gcc -Wall -Wextra -std=c11 -O2 fil_rouge_2.c graph.c base_fil_rouge.c \-o fil_ro
  Utilisation
 ========================
 ./fil_rouge_2 -i <fichier_graphe> -start <sommet> -goal <sommet>
+./fil_rouge_2 -i <fichier_graphe> -multi-start <s1,s2,...> -goal <sommet>
+./fil_rouge_2 -i <fichier_graphe> -prefix <prefixe> -goal <sommet>
 Options:
   -i <fichier_graphe> : fichier du graphe (sinon stdin)
   -o <fichier_sortie> : fichier de sortie (sinon stdout)
   -start <sommet>     : sommet de depart (numero ou nom)
   -goal <sommet>      : sommet d'arrivee (numero ou nom)
+  -multi-start <liste>: plusieurs sommets de depart separes par des virgules ;
+                        affiche la distance de chacun au but (parcours en
+                        largeur multi-sources, graph_ms_bfs)
+  -weighted           : plus court chemin selon les poids des aretes (troisieme
+                        colonne du fichier, 1 si absente), par graph_shortest_path ;
+                        avec -multi-start, une recherche par depart
+  -prefix <p>         : comme -multi-start, avec pour departs tous les sommets
+                        dont le nom commence par p (format 2, dictionnaire de
+                        noms, graph_vertices_with_prefix)
 */
 
-/* ---------- Piles / listes (API prof, définie dans base_fil_rouge.c) ---------- */
-typedef struct node {
-  t_vertex val;
-  struct node *p_next;
-} t_node;
-
-typedef t_node *t_list;
-typedef t_list t_stack;
-
-// Piles
-t_stack *stack_new();
-int stack_is_empty(t_stack *ps);
-void stack_push(t_vertex e, t_stack *ps);
-t_vertex stack_pop(t_stack *ps);
-t_vertex stack_top(t_stack *ps);
-
-// Listes / curseurs
-t_list list_free(t_list l);
-t_node *list_cursor_new(t_list l);
-int list_cursor_at_end(t_node *lc);
-int list_cursor_get_val(t_node *lc);
-t_node *list_cursor_next(t_node *lc);
-
 static void usage(const char *prog) {
   fprintf(stderr,
           "Utilisation:\n"
-          "  %s [-i <fichier_graphe>] [-o <fichier_sortie>] [-start <sommet>] [-goal <sommet>]\n"
+          "  %s [-i <fichier_graphe>] [-o <fichier_sortie>] [-start <sommet> | -multi-start <s1,s2,...> | -prefix <p>] [-goal <sommet>]\n"
+          "     [-repr list|matrix|csr|auto] [-weighted]\n"
           "Options:\n"
           "  -i <fichier_graphe> : fichier du graphe (si omis, stdin)\n"
           "  -o <fichier_sortie> : fichier de sortie (si omis, stdout)\n"
           "  -start <sommet>     : sommet de depart (si omis, stdin)\n"
-          "  -goal <sommet>      : sommet cible (si omis, stdin)\n",
+          "  -multi-start <liste>: sommets de depart separes par des virgules (distances au but)\n"
+          "  -prefix <p>         : departs = sommets dont le nom commence par p (format 2)\n"
+          "  -goal <sommet>      : sommet cible (si omis, stdin)\n"
+          "  -repr <r>           : representation interne, list, matrix, csr ou auto (defaut: list)\n"
+          "  -weighted           : plus court chemin pondere (poids en 3e colonne des aretes)\n",
           prog);
 }
 
@@ -116,145 +113,270 @@ static int parse_vertex(const t_graph *g, const char *s, t_vertex *out) {
   return 0;
 }
 
-/* Recherche de chemin (fonction récursive)
-   Retourne VRAI si un chemin de x vers y existe,
-   et empile le chemin dans stack (de y vers x).
+/* Recherche de chemin en profondeur (itérative)
+   Retourne VRAI si un chemin de x vers y existe, et le place dans path
+   (de x vers y, *len sommets). Pile explicite de sommets, chacun avec son
+   curseur sur ses successeurs : la profondeur ne dépend pas de la pile
+   d'appels, et le parcours s'arrête dès que y est atteint. parent[v] donne
+   le sommet d'où v a été atteint (-1 : pas encore visité).
+   Les tableaux (graph_size(g) cases) sont fournis par l'appelant : aucune
+   allocation pendant la recherche.
 */
-struct rr_ctx {
-  const t_graph *g;
-  t_vertex y;
-  t_bool *marking;
-  t_stack *stack;
-  t_bool found;
-};
-
-static t_bool Recherche_recur_f(const t_graph *g, t_vertex x, t_vertex y,
-                                t_bool *marking, t_stack *stack);
-
-static void rr_succ_cb(t_vertex w, void *p) {
-  struct rr_ctx *ctx = (struct rr_ctx *)p;
-  if (ctx->found) return;
-
-  if (Recherche_recur_f(ctx->g, w, ctx->y, ctx->marking, ctx->stack)) {
-    ctx->found = 1;
-  }
-}
-
-/* Recherche de chemin (récursif) — compatible avec graph_for_each_succ */
-static t_bool Recherche_recur_f(const t_graph *g,
-                                t_vertex x,
-                                t_vertex y,
-                                t_bool *marking,
-                                t_stack *stack) {
-  if (x == y) {                // si x = y
-    stack_push(x, stack);      // empiler x
-    return 1;                  // VRAI
+typedef struct {
+  t_vertex *parent;
+  t_vertex *stack;
+  t_graph_cursor *cursors;
+} t_dfs_ws;
+
+static t_bool Recherche_iter(const t_graph *g, t_vertex x, t_vertex y, const t_dfs_ws *ws,
+                             t_vertex *path, int *len) {
+  int n = graph_size(g);
+  for (int v = 0; v < n; v++) ws->parent[v] = -1;
+  ws->parent[x] = x;
+
+  t_bool found = (x == y);
+  int top = 0;
+  ws->stack[0] = x;
+  graph_cursor_init(g, x, &ws->cursors[0]);
+  while (!found && top >= 0) {
+    t_vertex w;
+    if (!graph_cursor_next(g, ws->stack[top], &ws->cursors[top], &w)) {
+      top--;                               // plus de successeur : retour arrière
+    } else if (ws->parent[w] < 0) {
+      ws->parent[w] = ws->stack[top];      // marquer w
+      found = (w == y);
+      top++;
+      ws->stack[top] = w;
+      graph_cursor_init(g, w, &ws->cursors[top]);
+    }
   }
+  if (!found) return 0;
 
-  if (marking[x]) return 0;    // déjà visité
-  marking[x] = 1;              // marquer x
+  // Remontée de y vers x par parent, écrite depuis la fin de path
+  int k = 1;
+  for (t_vertex v = y; v != x; v = ws->parent[v]) k++;
+  *len = k;
+  for (t_vertex v = y; k > 0; v = ws->parent[v]) path[--k] = v;
+  return 1;
+}
 
-  struct rr_ctx ctx = { g, y, marking, stack, 0 };
 
-  // pour chaque successeur w de x
-  graph_for_each_succ(g, x, rr_succ_cb, &ctx);
+/* ---------- Affichage du chemin ---------- */
+static void print_vertex(FILE *out, const t_graph *g, t_vertex v) {
+  const char *name = graph_vertex_name(g, v);
+  if (name) fprintf(out, "%s", name);
+  else fprintf(out, "%d", v);
+}
 
-  if (ctx.found) {             // si trouvé
-    stack_push(x, stack);      // empiler x (au retour)
-    return 1;
+static void print_path(FILE *out, const t_graph *g, const t_vertex *path, int len) {
+  for (int k = 0; k < len; k++) {
+    if (k > 0) fprintf(out, " -> ");
+    print_vertex(out, g, path[k]);
   }
-
-  return 0;                    // FAUX
+  fprintf(out, "\n");
 }
 
-static t_bool Recherche_recur(const t_graph *g, t_vertex x, t_vertex y, t_stack **out_stack) {
-  int n = graph_size(g);
-  t_bool *marking = calloc((size_t)n, sizeof(*marking));
-  assert(marking);
-
-  t_stack *stack = stack_new();
-  t_bool ok = Recherche_recur_f(g, x, y, marking, stack);
-
-  free(marking);
-
-  if (ok) {
-    *out_stack = stack;
-  } else {
-    *stack = list_free(*stack);
-    free(stack);
-    *out_stack = NULL;
+/* ---------- Départs multiples ---------- */
+
+/* Découpe "s1,s2,..." et convertit chaque sommet. Retourne le nombre de sommets,
+   ou -1 (message sur stderr) si l'un d'eux est invalide. */
+static int parse_vertex_list(const t_graph *g, const char *list, t_vertex **out) {
+  int cap = 1;
+  for (const char *p = list; *p; p++) if (*p == ',') cap++;
+  t_vertex *v = malloc((size_t)cap * sizeof(*v));
+  assert(v);
+
+  int nb = 0;
+  const char *p = list;
+  while (*p) {
+    const char *end = strchr(p, ',');
+    size_t len = end ? (size_t)(end - p) : strlen(p);
+    char tok[TOKEN_MAX];
+    if (len > 0) {
+      if (len >= sizeof tok || (memcpy(tok, p, len), tok[len] = '\0', !parse_vertex(g, tok, &v[nb]))) {
+        fprintf(stderr, "Start invalide: %.*s\n", (int)len, p);
+        free(v);
+        return -1;
+      }
+      nb++;
+    }
+    p += len;
+    if (*p == ',') p++;
   }
-  return ok;
+  *out = v;
+  return nb;
 }
 
+/* Sommets dont le nom commence par prefix. Retourne leur nombre, ou -1 (message
+   sur stderr) s'il n'y en a aucun. */
+static int prefix_vertex_list(const t_graph *g, const char *prefix, t_vertex **out) {
+  if (!graph_has_names(g)) {
+    fprintf(stderr, "Erreur: -prefix demande un graphe au format 2.\n");
+    return -1;
+  }
+  t_vertex *v = malloc((size_t)graph_size(g) * sizeof(*v));
+  assert(v);
+  int nb = graph_vertices_with_prefix(g, prefix, v);
+  if (nb == 0) {
+    fprintf(stderr, "Aucun sommet ne commence par \"%s\"\n", prefix);
+    free(v);
+    return -1;
+  }
+  *out = v;
+  return nb;
+}
 
-/* ---------- Affichage du chemin ---------- */
-static void print_vertex(FILE *out, const t_graph *g, t_vertex v) {
-  const char *name = graph_vertex_name(g, v);
-  if (name) fprintf(out, "%s", name);
-  else fprintf(out, "%d", v);
+/* Distance de chaque départ au but, en un seul parcours multi-sources */
+static void run_multi_start(FILE *out, const t_graph *g, const t_vertex *starts, int nb, t_vertex goal) {
+  int n = graph_size(g);
+  int *dist = malloc((size_t)nb * (size_t)n * sizeof(*dist));
+  assert(dist);
+  graph_ms_bfs(g, starts, nb, dist);
+  for (int i = 0; i < nb; i++) {
+    int d = dist[(size_t)i * (size_t)n + (size_t)goal];
+    print_vertex(out, g, starts[i]);
+    fprintf(out, " -> ");
+    print_vertex(out, g, goal);
+    if (d >= 0) fprintf(out, " : distance %d\n", d);
+    else fprintf(out, " : aucun chemin\n");
+  }
+  free(dist);
 }
 
-static void print_path_stack(FILE *out, const t_graph *g, t_stack *stack) {
-  // La pile contient déjà [start, ..., goal] dans l'ordre (tête -> queue)
-  t_node *lc = list_cursor_new(*stack);
-  int first = 1;
-  while (!list_cursor_at_end(lc)) {
-    t_vertex v = (t_vertex)list_cursor_get_val(lc);
-    if (!first) fprintf(out, " -> ");
-    first = 0;
-    print_vertex(out, g, v);
-    lc = list_cursor_next(lc);
+/* ---------- Chemins pondérés ---------- */
+
+/* Plus court chemin pondéré de chaque départ au but ; l'espace de travail et le
+   tableau du chemin servent à toutes les recherches */
+static void run_weighted(FILE *out, const t_graph *g, const t_vertex *starts, int nb, t_vertex goal,
+                         t_bool show_path) {
+  t_path_ws *ws = graph_path_ws_new(graph_size(g));
+  t_vertex *path = malloc((size_t)graph_size(g) * sizeof(*path));
+  assert(path);
+  for (int i = 0; i < nb; i++) {
+    int len = 0;
+    double d = graph_shortest_path(g, ws, starts[i], goal, path, &len);
+    if (d < 0) {
+      if (show_path) fprintf(out, "Aucun chemin trouve.\n");
+      else {
+        print_vertex(out, g, starts[i]);
+        fprintf(out, " -> ");
+        print_vertex(out, g, goal);
+        fprintf(out, " : aucun chemin\n");
+      }
+      continue;
+    }
+    if (show_path) {
+      print_path(out, g, path, len);
+      fprintf(out, "Longueur : %g\n", d);
+    } else {
+      print_vertex(out, g, starts[i]);
+      fprintf(out, " -> ");
+      print_vertex(out, g, goal);
+      fprintf(out, " : longueur %g (%d aretes)\n", d, len - 1);
+    }
   }
-  fprintf(out, "\n");
+  free(path);
+  graph_path_ws_free(ws);
 }
 
 int main(int argc, char **argv) {
   const char *infile = NULL, *outfile = NULL;
   const char *start_s = NULL, *goal_s = NULL;
+  const char *multi_s = NULL, *prefix = NULL;
+  int repr = GRAPH_LIST;
+  t_bool weighted = 0;
 
   for (int i = 1; i < argc; i++) {
     if      (!strcmp(argv[i], "-i")     && i + 1 < argc) infile  = argv[++i];
     else if (!strcmp(argv[i], "-o")     && i + 1 < argc) outfile = argv[++i];
     else if (!strcmp(argv[i], "-start") && i + 1 < argc) start_s = argv[++i];
     else if (!strcmp(argv[i], "-goal")  && i + 1 < argc) goal_s  = argv[++i];
-    else { usage(argv[0]); return EXIT_FAILURE; }
+    else if (!strcmp(argv[i], "-multi-start") && i + 1 < argc) multi_s = argv[++i];
+    else if (!strcmp(argv[i], "-prefix") && i + 1 < argc) prefix = argv[++i];
+    else if (!strcmp(argv[i], "-weighted")) weighted = 1;
+    else if (!strcmp(argv[i], "-repr") && i + 1 < argc) {
+      repr = graph_representation_from_name(argv[++i]);
+      if (repr == GRAPH_REPR_INVALID) { usage(argv[0]); return EXIT_FAILURE; }
+    } else { usage(argv[0]); return EXIT_FAILURE; }
   }
-
-  t_bool use_matrix = 0;
+  if (multi_s && prefix) { usage(argv[0]); return EXIT_FAILURE; }
+  t_bool multi = multi_s || prefix;
+  if (prefix) graph_set_name_dict(1);
 
   int format = detect_format(infile);
   t_graph *g;
   if (format == 2) {
-    g = graph_read_format2(infile, use_matrix);
+    g = graph_read_format2(infile, repr);
   } else {
-    g = graph_read_format1(infile, use_matrix);
+    g = graph_read_format1(infile, repr);
   }
 
   if (!g) { fprintf(stderr, "Erreur: lecture du graphe impossible.\n"); return EXIT_FAILURE; }
+  if (repr == GRAPH_AUTO) fprintf(stderr, "Representation choisie : %s\n", graph_representation_name(graph_representation(g)));
 
   char buf_start[TOKEN_MAX], buf_goal[TOKEN_MAX];
-  if (!start_s) { if (!read_token_stdin(buf_start, sizeof buf_start)) { fprintf(stderr, "Erreur: lire start.\n"); graph_free(g); return EXIT_FAILURE; } start_s = buf_start; }
+  if (!start_s && !multi) { if (!read_token_stdin(buf_start, sizeof buf_start)) { fprintf(stderr, "Erreur: lire start.\n"); graph_free(g); return EXIT_FAILURE; } start_s = buf_start; }
   if (!goal_s)  { if (!read_token_stdin(buf_goal,  sizeof buf_goal))  { fprintf(stderr, "Erreur: lire goal.\n");  graph_free(g); return EXIT_FAILURE; } goal_s  = buf_goal;  }
 
-  t_vertex start, goal;
-  if (!parse_vertex(g, start_s, &start)) { fprintf(stderr, "Start invalide: %s\n", start_s); graph_free(g); return EXIT_FAILURE; }
-  if (!parse_vertex(g, goal_s,  &goal))  { fprintf(stderr, "Goal invalide: %s\n",  goal_s);  graph_free(g); return EXIT_FAILURE; }
+  t_vertex start = 0, goal;
+  t_vertex *starts = NULL;
+  int nb_starts = 0;
+  if (multi_s) {
+    nb_starts = parse_vertex_list(g, multi_s, &starts);
+    if (nb_starts < 0) { graph_free(g); return EXIT_FAILURE; }
+  } else if (prefix) {
+    nb_starts = prefix_vertex_list(g, prefix, &starts);
+    if (nb_starts < 0) { graph_free(g); return EXIT_FAILURE; }
+  } else if (!parse_vertex(g, start_s, &start)) { fprintf(stderr, "Start invalide: %s\n", start_s); graph_free(g); return EXIT_FAILURE; }
+  if (!parse_vertex(g, goal_s,  &goal))  { fprintf(stderr, "Goal invalide: %s\n",  goal_s);  free(starts); graph_free(g); return EXIT_FAILURE; }
 
   FILE *out = stdout;
   if (outfile && strcmp(outfile, "-") != 0) {
     out = fopen(outfile, "w");
-    if (!out) { fprintf(stderr, "Impossible d'ouvrir %s\n", outfile); graph_free(g); return EXIT_FAILURE; }
+    if (!out) { fprintf(stderr, "Impossible d'ouvrir %s\n", outfile); free(starts); graph_free(g); return EXIT_FAILURE; }
+  }
+
+  if (weighted) {
+    graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+    if (multi) run_weighted(out, g, starts, nb_starts, goal, 0);
+    else run_weighted(out, g, &start, 1, goal, 1);
+    graph_stats_phase_end(GRAPH_PHASE_ALGO);
+    free(starts);
+    if (out != stdout) fclose(out);
+    graph_free(g);
+    return EXIT_SUCCESS;
+  }
+
+  if (multi) {
+    graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+    run_multi_start(out, g, starts, nb_starts, goal);
+    graph_stats_phase_end(GRAPH_PHASE_ALGO);
+    free(starts);
+    if (out != stdout) fclose(out);
+    graph_free(g);
+    return EXIT_SUCCESS;
   }
 
-  t_stack *path = NULL;
-  if (Recherche_recur(g, start, goal, &path)) {
-    print_path_stack(out, g, path);
-    *path = list_free(*path);
-    free(path);
+  size_t n = (size_t)graph_size(g);
+  t_dfs_ws ws;
+  ws.parent = malloc(n * sizeof(*ws.parent));
+  ws.stack = malloc(n * sizeof(*ws.stack));
+  ws.cursors = malloc(n * sizeof(*ws.cursors));
+  t_vertex *path = malloc(n * sizeof(*path));
+  assert(ws.parent && ws.stack && ws.cursors && path);
+  int len = 0;
+  graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+  t_bool found = Recherche_iter(g, start, goal, &ws, path, &len);
+  graph_stats_phase_end(GRAPH_PHASE_ALGO);
+  if (found) {
+    print_path(out, g, path, len);
   } else {
     fprintf(out, "Aucun chemin trouve.\n");
   }
+  free(path);
+  free(ws.cursors);
+  free(ws.stack);
+  free(ws.parent);
 
   if (out != stdout) fclose(out);
   graph_free(g);
@@ -0,0 +1,421 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+/*
+  Générateur de grands graphes synthétiques (tests de passage à l'échelle)
+
+  Modèles :
+    - rmat    : R-MAT / Kronecker (a, b, c, d = 0.57, 0.19, 0.19, 0.05)
+    - er      : Erdős–Rényi G(n, m), arêtes tirées uniformément
+    - chain   : chaîne 0 -> 1 -> ... -> n-1 (option -cycle : reboucle sur 0),
+                pour les cas de récursion profonde
+    - planted : CFC plantées de taille fixe (un cycle par groupe), arêtes
+                supplémentaires internes aux groupes ou vers un groupe d'indice
+                supérieur (les CFC attendues sont exactement les groupes)
+
+  Sorties : format 1 (numéros), format 2 (noms synthétiques) ou binaire
+  (voir graph.h). Les doublons et boucles éventuels sont éliminés à la lecture.
+
+  Déterminisme : les arêtes sont découpées en blocs de taille fixe et chaque
+  bloc a son propre générateur dérivé de (graine, numéro de bloc). Le fichier
+  produit ne dépend donc que de la graine, pas du nombre de threads.
+
+  Compilation :
+    gcc -Wall -Wextra -std=c11 -O2 -pthread gen_graph.c graph.c -o gen_graph
+*/
+
+#define CHUNK_EDGES (1 << 18)
+#define MAX_THREADS 64
+
+enum { MODEL_RMAT, MODEL_ER, MODEL_CHAIN, MODEL_PLANTED };
+enum { OUT_FORMAT1, OUT_FORMAT2, OUT_BINARY };
+
+struct gen_params {
+  int model;
+  int out_format;
+  int64_t n;
+  int64_t m;
+  uint64_t seed;
+  int scc_size;       // planted : taille des CFC
+  double intra;       // planted : proportion d'arêtes internes aux groupes
+  int cycle;          // chain : reboucler la chaîne
+  int rmat_scale;     // rmat : log2 de la taille de la grille
+  const char *prefix; // format 2 : préfixe des noms
+};
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s -model rmat|er|chain|planted -n <sommets> [-m <aretes>] [options]\n"
+          "  -format 1|2|bin : format de sortie (defaut: 1)\n"
+          "  -o <fichier>    : fichier de sortie (defaut: stdout)\n"
+          "  -seed <s>       : graine (defaut: 1)\n"
+          "  -t <threads>    : nombre de threads (defaut: nombre de coeurs)\n"
+          "  -scc <k>        : planted, taille des CFC plantees (defaut: 8)\n"
+          "  -intra <p>      : planted, proportion d'aretes internes, dans [0,1] (defaut: 0.5)\n"
+          "  -cycle          : chain, ajoute l'arete n-1 -> 0\n"
+          "  -prefix <p>     : format 2, prefixe des noms (defaut: v)\n",
+          prog);
+}
+
+/* =========================
+   Générateur pseudo-aléatoire
+   ========================= */
+
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+typedef struct {
+  uint64_t s[4];
+} t_rng;
+
+static void rng_seed(t_rng *r, uint64_t seed, uint64_t stream) {
+  uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+  for (int i = 0; i < 4; i++) r->s[i] = splitmix64(&x);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/* xoshiro256** */
+static uint64_t rng_next(t_rng *r) {
+  uint64_t *s = r->s;
+  uint64_t res = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return res;
+}
+
+/* Entier uniforme dans [0, bound) */
+static int64_t rng_below(t_rng *r, int64_t bound) {
+  return (int64_t)(((rng_next(r) >> 32) * (uint64_t)bound) >> 32);
+}
+
+static double rng_unit(t_rng *r) {
+  return (double)(rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* =========================
+   Modèles
+   ========================= */
+
+/* Mélange bijectif des numéros (R-MAT regroupe sinon les hubs en tête) */
+static int64_t scramble(int64_t v, int scale, uint64_t seed) {
+  uint64_t mask = (scale >= 63) ? ~0ULL : ((1ULL << scale) - 1);
+  uint64_t x = (uint64_t)v;
+  for (int round = 0; round < 2; round++) {
+    x = (x * 0x9E3779B97F4A7C15ULL + seed) & mask;
+    x ^= x >> (scale / 2 + 1);
+    x = (x * 0xBF58476D1CE4E5B9ULL) & mask;
+  }
+  return (int64_t)x;
+}
+
+static void gen_rmat(const struct gen_params *p, t_rng *r, int64_t *u, int64_t *v) {
+  const double a = 0.57, b = 0.19, c = 0.19;
+  for (;;) {
+    int64_t x = 0, y = 0;
+    for (int bit = p->rmat_scale - 1; bit >= 0; bit--) {
+      double q = rng_unit(r);
+      if (q < a) {
+        /* quadrant haut gauche */
+      } else if (q < a + b) {
+        y |= (int64_t)1 << bit;
+      } else if (q < a + b + c) {
+        x |= (int64_t)1 << bit;
+      } else {
+        x |= (int64_t)1 << bit;
+        y |= (int64_t)1 << bit;
+      }
+    }
+    x = scramble(x, p->rmat_scale, p->seed);
+    y = scramble(y, p->rmat_scale, p->seed);
+    if (x < p->n && y < p->n) {
+      *u = x;
+      *v = y;
+      return;
+    }
+  }
+}
+
+/* Arête numéro e du modèle planted : les n premières forment les cycles */
+static void gen_planted(const struct gen_params *p, t_rng *r, int64_t e, int64_t *u, int64_t *v) {
+  int64_t k = p->scc_size;
+  if (e < p->n) {
+    int64_t base = e - e % k;
+    int64_t size = (base + k <= p->n) ? k : p->n - base;
+    *u = e;
+    *v = base + (e - base + 1) % size;
+    return;
+  }
+  int64_t groups = (p->n + k - 1) / k;
+  int64_t g = rng_below(r, groups);
+  int64_t base = g * k;
+  int64_t size = (base + k <= p->n) ? k : p->n - base;
+  if (rng_unit(r) < p->intra || g == groups - 1) {
+    *u = base + rng_below(r, size);
+    *v = base + rng_below(r, size);
+  } else {
+    *u = base + rng_below(r, size);
+    *v = (g + 1) * k + rng_below(r, p->n - (g + 1) * k);
+  }
+}
+
+static void gen_edge(const struct gen_params *p, t_rng *r, int64_t e, int64_t *u, int64_t *v) {
+  switch (p->model) {
+    case MODEL_RMAT:
+      gen_rmat(p, r, u, v);
+      break;
+    case MODEL_ER:
+      *u = rng_below(r, p->n);
+      *v = rng_below(r, p->n);
+      break;
+    case MODEL_CHAIN:
+      *u = e;
+      *v = (e + 1) % p->n;
+      break;
+    default:
+      gen_planted(p, r, e, u, v);
+      break;
+  }
+}
+
+/* =========================
+   Formatage des blocs
+   ========================= */
+
+struct chunk {
+  int64_t first;   // indice de la première arête du bloc
+  int64_t count;   // nombre d'arêtes du bloc
+  char *buf;       // texte ou paires binaires
+  size_t len;
+  size_t cap;
+};
+
+/* Écrit v en décimal à partir de out ; retourne le nombre d'octets */
+static size_t put_int(char *out, int64_t v) {
+  char tmp[24];
+  size_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + v % 10);
+    v /= 10;
+  } while (v > 0);
+  for (size_t i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+  return n;
+}
+
+static void chunk_reserve(struct chunk *c, size_t need) {
+  if (c->cap >= need) return;
+  free(c->buf);
+  c->cap = need;
+  c->buf = malloc(need);
+  if (c->buf == NULL) {
+    fprintf(stderr, "Erreur: memoire insuffisante pour un bloc de %zu octets\n", need);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void fill_chunk(const struct gen_params *p, struct chunk *c) {
+  t_rng r;
+  rng_seed(&r, p->seed, (uint64_t)(c->first / CHUNK_EDGES));
+  size_t prefix_len = strlen(p->prefix);
+  size_t per_edge = (p->out_format == OUT_BINARY) ? 2 * sizeof(int32_t)
+                                                  : 2 * (prefix_len + 21) + 2;
+  chunk_reserve(c, per_edge * (size_t)c->count);
+  char *out = c->buf;
+  for (int64_t i = 0; i < c->count; i++) {
+    int64_t u, v;
+    gen_edge(p, &r, c->first + i, &u, &v);
+    if (p->out_format == OUT_BINARY) {
+      int32_t pair[2] = { (int32_t)u, (int32_t)v };
+      memcpy(out, pair, sizeof(pair));
+      out += sizeof(pair);
+    } else {
+      if (p->out_format == OUT_FORMAT2) { memcpy(out, p->prefix, prefix_len); out += prefix_len; }
+      out += put_int(out, u);
+      *out++ = ' ';
+      if (p->out_format == OUT_FORMAT2) { memcpy(out, p->prefix, prefix_len); out += prefix_len; }
+      out += put_int(out, v);
+      *out++ = '\n';
+    }
+  }
+  c->len = (size_t)(out - c->buf);
+}
+
+/* =========================
+   Threads : un tour = un bloc par thread, écrits ensuite dans l'ordre
+   ========================= */
+
+struct worker {
+  pthread_t tid;
+  int threaded;
+  const struct gen_params *p;
+  struct chunk chunk;
+};
+
+static void *worker_main(void *arg) {
+  struct worker *w = (struct worker *)arg;
+  fill_chunk(w->p, &w->chunk);
+  return NULL;
+}
+
+static int64_t edge_count(const struct gen_params *p) {
+  if (p->model == MODEL_CHAIN) return p->cycle ? p->n : p->n - 1;
+  if (p->model == MODEL_PLANTED && p->m < p->n) return p->n;
+  return p->m;
+}
+
+static int write_header(FILE *out, const struct gen_params *p, int64_t m) {
+  if (p->out_format == OUT_BINARY) {
+    return graph_write_binary_header(out, (int)p->n, m) ? 0 : -1;
+  }
+  if (p->out_format == OUT_FORMAT1) {
+    fprintf(out, "%lld\n", (long long)p->n);
+    return 0;
+  }
+  fprintf(out, "%lld n\n", (long long)p->n);
+  for (int64_t i = 0; i < p->n; i++) fprintf(out, "%s%lld\n", p->prefix, (long long)i);
+  return 0;
+}
+
+static int generate(FILE *out, const struct gen_params *p, int nthreads) {
+  int64_t m = edge_count(p);
+  if (write_header(out, p, m) != 0) return -1;
+
+  struct worker workers[MAX_THREADS];
+  memset(workers, 0, sizeof(workers));
+  int ret = 0;
+  for (int64_t next = 0; next < m && ret == 0;) {
+    int used = 0;
+    for (; used < nthreads && next < m; used++) {
+      struct worker *w = &workers[used];
+      w->p = p;
+      w->chunk.first = next;
+      w->chunk.count = (m - next < CHUNK_EDGES) ? m - next : CHUNK_EDGES;
+      next += w->chunk.count;
+      w->threaded = (nthreads > 1 && pthread_create(&w->tid, NULL, worker_main, w) == 0);
+      if (!w->threaded) fill_chunk(p, &w->chunk);
+    }
+    /* Après un échec d'écriture, on attend quand même tous les fils lancés :
+       ils écrivent dans workers[], sur cette pile */
+    for (int i = 0; i < used; i++) {
+      if (workers[i].threaded) pthread_join(workers[i].tid, NULL);
+      if (ret == 0 && fwrite(workers[i].chunk.buf, 1, workers[i].chunk.len, out) != workers[i].chunk.len) {
+        ret = -1;
+      }
+    }
+  }
+  for (int i = 0; i < MAX_THREADS; i++) free(workers[i].chunk.buf);
+  return ret;
+}
+
+/* =========================
+   Main
+   ========================= */
+
+/* Entier décimal dans [min, max], sans caractère en trop */
+static int parse_int64(const char *s, int64_t min, int64_t max, int64_t *out) {
+  char *end = NULL;
+  errno = 0;
+  long long v = strtoll(s, &end, 10);
+  if (end == s || *end != '\0' || errno != 0 || v < min || v > max) return 0;
+  *out = (int64_t)v;
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  struct gen_params p = { MODEL_ER, OUT_FORMAT1, 0, -1, 1, 8, 0.5, 0, 0, "v" };
+  const char *out_path = NULL;
+  int nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int model_set = 0;
+  int64_t v = 0;
+
+  for (int i = 1; i < argc; i++) {
+    int ok = 1;
+    if (!strcmp(argv[i], "-model") && i + 1 < argc) {
+      const char *m = argv[++i];
+      model_set = 1;
+      if (!strcmp(m, "rmat")) p.model = MODEL_RMAT;
+      else if (!strcmp(m, "er")) p.model = MODEL_ER;
+      else if (!strcmp(m, "chain")) p.model = MODEL_CHAIN;
+      else if (!strcmp(m, "planted")) p.model = MODEL_PLANTED;
+      else { usage(argv[0]); return EXIT_FAILURE; }
+    } else if (!strcmp(argv[i], "-format") && i + 1 < argc) {
+      const char *f = argv[++i];
+      if (!strcmp(f, "1")) p.out_format = OUT_FORMAT1;
+      else if (!strcmp(f, "2")) p.out_format = OUT_FORMAT2;
+      else if (!strcmp(f, "bin")) p.out_format = OUT_BINARY;
+      else { usage(argv[0]); return EXIT_FAILURE; }
+    }
+    else if (!strcmp(argv[i], "-n") && i + 1 < argc) ok = parse_int64(argv[++i], 1, INT32_MAX, &p.n);
+    else if (!strcmp(argv[i], "-m") && i + 1 < argc) ok = parse_int64(argv[++i], 0, INT64_MAX, &p.m);
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc) out_path = argv[++i];
+    else if (!strcmp(argv[i], "-seed") && i + 1 < argc) {
+      const char *a = argv[++i];
+      char *end = NULL;
+      errno = 0;
+      p.seed = strtoull(a, &end, 10);
+      ok = end != a && *end == '\0' && errno == 0 && a[0] != '-';
+    }
+    else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      ok = parse_int64(argv[++i], 1, INT32_MAX, &v);
+      nthreads = (int)v;
+    }
+    else if (!strcmp(argv[i], "-scc") && i + 1 < argc) {
+      ok = parse_int64(argv[++i], 1, INT32_MAX, &v);
+      p.scc_size = (int)v;
+    }
+    else if (!strcmp(argv[i], "-intra") && i + 1 < argc) {
+      const char *a = argv[++i];
+      char *end = NULL;
+      p.intra = strtod(a, &end);
+      ok = end != a && *end == '\0' && p.intra >= 0.0 && p.intra <= 1.0; // rejette aussi NaN
+    }
+    else if (!strcmp(argv[i], "-prefix") && i + 1 < argc) p.prefix = argv[++i];
+    else if (!strcmp(argv[i], "-cycle")) p.cycle = 1;
+    else ok = 0;
+    if (!ok) { usage(argv[0]); return EXIT_FAILURE; }
+  }
+
+  if (!model_set || p.n <= 0 || p.n > INT32_MAX || p.scc_size <= 0) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (p.m < 0) p.m = (p.model == MODEL_CHAIN) ? p.n - 1 : 16 * p.n;
+  if (nthreads < 1) nthreads = 1;
+  if (nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+  while (p.model == MODEL_RMAT && ((int64_t)1 << p.rmat_scale) < p.n) p.rmat_scale++;
+
+  FILE *out = stdout;
+  if (out_path && strcmp(out_path, "-") != 0) {
+    out = fopen(out_path, p.out_format == OUT_BINARY ? "wb" : "w");
+    if (!out) { perror("fopen -o"); return EXIT_FAILURE; }
+  }
+
+  int rc = generate(out, &p, nthreads);
+  if (fflush(out) != 0) rc = -1;
+  if (out != stdout) fclose(out);
+  if (rc != 0) {
+    fprintf(stderr, "Erreur: ecriture de la sortie impossible.\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,23 +1,146 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "graph.h"
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef GRAPH_NO_THREADS
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPH_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define MAX_READ_LINE GRAPH_NAME_MAX
+#define BINARY_MAGIC "GRB1"
+#define BINARY_BLOCK 4096
+
+// Instrumentation (compilée seulement avec -DGRAPH_STATS, active si GRAPH_STATS=1)
+#ifdef GRAPH_STATS
+static struct {
+  int state;                  // -1 : pas encore lu, 0 : inactive, 1 : active
+  unsigned long long edges_scanned;
+  unsigned long long name_lookups;
+  unsigned long long name_compares;
+  unsigned long long dedup_checks;
+  unsigned long long dedup_probes;
+  unsigned long long nodes_allocated;
+  long long bytes_live;
+  long long bytes_peak;
+  long long phase_ns[GRAPH_NB_PHASES];
+} stats = { -1, 0, 0, 0, 0, 0, 0, 0, 0, { 0 } };
+
+static void stats_report_at_exit(void) {
+  graph_stats_report(stderr);
+}
+
+static t_bool stats_on(void) {
+  if (stats.state < 0) {
+    const char * env = getenv("GRAPH_STATS");
+    stats.state = (env != NULL && env[0] != '\0' && strcmp(env, "0") != 0);
+    if (stats.state) atexit(stats_report_at_exit);
+  }
+  return stats.state;
+}
+
+static double stats_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Les compteurs peuvent être mis à jour par plusieurs fils (chargement en
+// pipeline, construction concurrente) : additions atomiques, et début de phase
+// propre à chaque fil ; les temps des fils s'additionnent
+#ifdef __GNUC__
+#define STAT_ATOMIC_ADD(x, n) __atomic_add_fetch(&(x), (n), __ATOMIC_RELAXED)
+#else
+#define STAT_ATOMIC_ADD(x, n) ((x) += (n))
+#endif
+static _Thread_local double phase_start[GRAPH_NB_PHASES];
+
+static void stats_bytes(long long delta) {
+  long long live = STAT_ATOMIC_ADD(stats.bytes_live, delta);
+#ifdef __GNUC__
+  long long peak = __atomic_load_n(&stats.bytes_peak, __ATOMIC_RELAXED);
+  while (live > peak && !__atomic_compare_exchange_n(&stats.bytes_peak, &peak, live, 1,
+                                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+#else
+  if (live > stats.bytes_peak) stats.bytes_peak = live;
+#endif
+}
+
+void graph_stats_phase_begin(t_graph_phase p) {
+  if (stats_on()) phase_start[p] = stats_now();
+}
+
+void graph_stats_phase_end(t_graph_phase p) {
+  if (!stats_on()) return;
+  long long ns = (long long)((stats_now() - phase_start[p]) * 1e9);
+  STAT_ATOMIC_ADD(stats.phase_ns[p], ns);
+}
+
+void graph_stats_report(FILE * out) {
+  static const char * phase_names[GRAPH_NB_PHASES] = {
+    "lecture (fgets/sscanf)", "recherche de noms", "construction", "transposition", "algorithme"
+  };
+  if (!stats_on()) return;
+  fprintf(out, "=== Statistiques graph.c ===\n");
+  fprintf(out, "arêtes lues             : %llu\n", stats.edges_scanned);
+  fprintf(out, "recherches de nom       : %llu (%llu comparaisons)\n", stats.name_lookups, stats.name_compares);
+  fprintf(out, "tests de doublon        : %llu (%llu maillons examinés)\n", stats.dedup_checks, stats.dedup_probes);
+  fprintf(out, "maillons alloués        : %llu\n", stats.nodes_allocated);
+  fprintf(out, "mémoire (actuelle/pic)  : %lld / %lld octets\n", stats.bytes_live, stats.bytes_peak);
+  for (int p = 0; p < GRAPH_NB_PHASES; p++) {
+    fprintf(out, "phase %-22s: %.6f s\n", phase_names[p], (double)stats.phase_ns[p] * 1e-9);
+  }
+}
 
-#define MAX_READ_LINE 100
+#define STAT_ADD(field, n) do { if (stats_on()) STAT_ATOMIC_ADD(stats.field, (n)); } while (0)
+#define STAT_BYTES(n) do { if (stats_on()) stats_bytes((long long)(n)); } while (0)
+#define STAT_PHASE_BEGIN(p) graph_stats_phase_begin(p)
+#define STAT_PHASE_END(p) graph_stats_phase_end(p)
+#else
+#define STAT_ADD(field, n) ((void)0)
+#define STAT_BYTES(n) ((void)0)
+#define STAT_PHASE_BEGIN(p) ((void)0)
+#define STAT_PHASE_END(p) ((void)0)
+#endif
 
 // Liste chaînée interne (pour les représentations en listes d'adjacence)
+// Le poids de l'arête occupe le remplissage qui suit val : un maillon garde sa taille
 typedef struct node {
   t_vertex val;
+  float w;
   struct node * p_next;
 } t_node;
 typedef t_node * t_list;
 
-static t_list list_add_head(t_vertex e, t_list l) {
+static t_list list_add_head(t_vertex e, float w, t_list l) {
   t_node * n = malloc(sizeof(t_node));
   assert(n != NULL);
+  STAT_ADD(nodes_allocated, 1);
+  STAT_BYTES(sizeof(t_node));
   n->val = e;
+  n->w = w;
   n->p_next = l;
   return n;
 }
@@ -27,22 +150,681 @@ static t_list list_free(t_list l) {
   while (n != NULL) {
     nNext = n->p_next;
     free(n);
+    STAT_BYTES(-(long long)sizeof(t_node));
     n = nNext;
   }
   return NULL;
 }
 
+// Représentation compacte (CSR) modifiable
+// Les successeurs de u sont succ[off[u] .. off[u + 1] - 1], triés. Une arête
+// supprimée reste en place, marquée dans dead, et une arête ajoutée va dans le
+// tampon d'insertion de son origine (delta), jusqu'au compactage qui fusionne
+// le tout. Le compactage n'a lieu que lorsque les modifications en attente
+// dépassent la moitié des arêtes compactées (ou sur graph_compact) : une rafale
+// de mises à jour coûte O(1) amorti par arête au lieu d'une reconstruction O(E).
+// Les poids vont dans des tableaux parallèles à succ et aux tampons, alloués au
+// premier poids différent de 1 : un graphe sans poids n'en a aucun.
+#define CSR_COMPACT_MIN 4096
+
+typedef struct {
+  t_vertex * v;
+  float * w; // poids (NULL tant qu'ils valent tous 1)
+  int len;
+  int cap;
+} t_delta;
+
+struct csr {
+  long long * off;    // size + 1 positions dans succ
+  t_vertex * succ;    // off[size] successeurs compactés
+  float * w;          // poids des cases de succ (NULL tant qu'ils valent tous 1)
+  uint64_t * dead;    // un bit par case de succ (NULL tant qu'aucune suppression)
+  t_delta * delta;    // tampons d'insertion par sommet (NULL tant qu'aucun ajout)
+  long long nb_dead;  // cases marquées dans dead
+  long long nb_delta; // arêtes dans les tampons
+};
+
+static struct csr * csr_new(int size) {
+  struct csr * c = calloc(1, sizeof(*c));
+  if (c == NULL) return NULL;
+  c->off = calloc((size_t)size + 1, sizeof(*(c->off)));
+  if (c->off == NULL) {
+    free(c);
+    return NULL;
+  }
+  STAT_BYTES(sizeof(*c) + ((size_t)size + 1) * sizeof(*(c->off)));
+  return c;
+}
+
+static size_t csr_dead_words(const struct csr * c, int size) {
+  return ((size_t)c->off[size] + 63) / 64;
+}
+
+// Libère les tampons d'insertion et les marques de suppression
+static void csr_drop_pending(struct csr * c, int size) {
+  if (c->delta != NULL) {
+    for (int u = 0; u < size; u++) {
+      STAT_BYTES(-(long long)((size_t)c->delta[u].cap
+                              * (sizeof(t_vertex) + (c->delta[u].w != NULL ? sizeof(float) : 0))));
+      free(c->delta[u].v);
+      free(c->delta[u].w);
+    }
+    STAT_BYTES(-(long long)((size_t)size * sizeof(t_delta)));
+    free(c->delta);
+    c->delta = NULL;
+  }
+  if (c->dead != NULL) {
+    STAT_BYTES(-(long long)(csr_dead_words(c, size) * sizeof(uint64_t)));
+    free(c->dead);
+    c->dead = NULL;
+  }
+  c->nb_dead = 0;
+  c->nb_delta = 0;
+}
+
+static void csr_free(struct csr * c, int size) {
+  csr_drop_pending(c, size);
+  STAT_BYTES(-(long long)(sizeof(*c) + ((size_t)size + 1) * sizeof(*(c->off))
+                          + (size_t)c->off[size] * (sizeof(t_vertex) + (c->w != NULL ? sizeof(float) : 0))));
+  free(c->succ);
+  free(c->w);
+  free(c->off);
+  free(c);
+}
+
+static t_bool csr_is_dead(const struct csr * c, long long i) {
+  return c->dead != NULL && ((c->dead[i >> 6] >> (i & 63)) & 1);
+}
+
+// Position de to parmi les successeurs compactés de u (morte ou non), -1 sinon
+static long long csr_find(const struct csr * c, t_vertex u, t_vertex to) {
+  long long lo = c->off[u], hi = c->off[u + 1];
+  while (lo < hi) {
+    long long mid = lo + (hi - lo) / 2;
+    STAT_ADD(dedup_probes, 1);
+    if (c->succ[mid] < to) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo < c->off[u + 1] && c->succ[lo] == to ? lo : -1;
+}
+
+// Position de to dans le tampon d'insertion de u, -1 sinon
+static int csr_find_delta(const struct csr * c, t_vertex u, t_vertex to) {
+  if (c->delta == NULL) return -1;
+  const t_delta * d = &c->delta[u];
+  for (int i = 0; i < d->len; i++) {
+    STAT_ADD(dedup_probes, 1);
+    if (d->v[i] == to) return i;
+  }
+  return -1;
+}
+
+static t_bool csr_has_edge(const struct csr * c, t_vertex u, t_vertex to) {
+  long long i = csr_find(c, u, to);
+  if (i >= 0) return !csr_is_dead(c, i);
+  return csr_find_delta(c, u, to) >= 0;
+}
+
+static int cmp_vertex(const void * a, const void * b) {
+  t_vertex x = *(const t_vertex *)a, y = *(const t_vertex *)b;
+  return (x > y) - (x < y);
+}
+
+// Successeur pondéré, pour trier ensemble sommets et poids
+typedef struct {
+  t_vertex v;
+  float w;
+} t_wsucc;
+
+// Par sommet puis par poids : après tri, la première copie d'une arête a le plus petit poids
+static int cmp_wsucc(const void * a, const void * b) {
+  const t_wsucc * x = a, * y = b;
+  if (x->v != y->v) return (x->v > y->v) - (x->v < y->v);
+  return (x->w > y->w) - (x->w < y->w);
+}
+
+// Tableau de poids des cases compactées, créé à 1 au premier poids
+static float * csr_weights(struct csr * c, int size) {
+  if (c->w == NULL) {
+    long long n = c->off[size];
+    c->w = malloc((size_t)(n > 0 ? n : 1) * sizeof(float));
+    assert(c->w != NULL);
+    for (long long i = 0; i < n; i++) c->w[i] = 1.0f;
+    STAT_BYTES((size_t)n * sizeof(float));
+  }
+  return c->w;
+}
+
+static float csr_weight(const struct csr * c, long long i) {
+  return c->w != NULL ? c->w[i] : 1.0f;
+}
+
+static float delta_weight(const t_delta * d, int j) {
+  return d->w != NULL ? d->w[j] : 1.0f;
+}
+
+// Fusionne tampons et suppressions : O(E + V) plus le tri des tampons
+static void csr_compact(struct csr * c, int size) {
+  if (c->nb_dead == 0 && c->nb_delta == 0) return;
+  t_bool weighted = c->w != NULL;
+  for (int u = 0; u < size && !weighted && c->delta != NULL; u++) weighted = c->delta[u].w != NULL;
+  long long total = c->off[size] - c->nb_dead + c->nb_delta;
+  long long * off = malloc(((size_t)size + 1) * sizeof(*off));
+  t_vertex * succ = malloc((size_t)(total > 0 ? total : 1) * sizeof(*succ));
+  float * w = weighted ? malloc((size_t)(total > 0 ? total : 1) * sizeof(*w)) : NULL;
+  assert(off != NULL && succ != NULL && (w != NULL || !weighted));
+
+  long long k = 0;
+  t_wsucc * tmp = NULL;
+  int tmp_cap = 0;
+  for (int u = 0; u < size; u++) {
+    off[u] = k;
+    const t_delta * d = c->delta != NULL ? &c->delta[u] : NULL;
+    int dn = d != NULL ? d->len : 0, j = 0;
+    if (dn > 0 && !weighted) {
+      qsort(d->v, (size_t)dn, sizeof(*(d->v)), cmp_vertex);
+    } else if (dn > 0) {
+      // Tampon pondéré : tri des couples (sommet, poids)
+      if (dn > tmp_cap) {
+        tmp_cap = dn;
+        tmp = realloc(tmp, (size_t)tmp_cap * sizeof(*tmp));
+        assert(tmp != NULL);
+      }
+      for (int i = 0; i < dn; i++) tmp[i] = (t_wsucc){ d->v[i], delta_weight(d, i) };
+      qsort(tmp, (size_t)dn, sizeof(*tmp), cmp_wsucc);
+    }
+    for (long long i = c->off[u]; i <= c->off[u + 1]; i++) {
+      t_bool last = i == c->off[u + 1];
+      if (!last && csr_is_dead(c, i)) continue;
+      while (j < dn && (last || (weighted ? tmp[j].v : d->v[j]) < c->succ[i])) {
+        if (weighted) {
+          succ[k] = tmp[j].v;
+          w[k++] = tmp[j++].w;
+        } else {
+          succ[k++] = d->v[j++];
+        }
+      }
+      if (last) break;
+      if (weighted) w[k] = csr_weight(c, i);
+      succ[k++] = c->succ[i];
+    }
+  }
+  free(tmp);
+  off[size] = k;
+  assert(k == total);
+
+  STAT_BYTES((total - c->off[size]) * (long long)sizeof(t_vertex)
+             + (weighted ? total * (long long)sizeof(float) : 0)
+             - (c->w != NULL ? c->off[size] * (long long)sizeof(float) : 0));
+  csr_drop_pending(c, size);
+  free(c->succ);
+  free(c->off);
+  free(c->w);
+  c->off = off;
+  c->succ = succ;
+  c->w = w;
+}
+
+static void csr_maybe_compact(struct csr * c, int size) {
+  long long pending = c->nb_dead + c->nb_delta;
+  if (pending >= CSR_COMPACT_MIN && 2 * pending > c->off[size]) csr_compact(c, size);
+}
+
+static void csr_alloc_delta(struct csr * c, int size) {
+  if (c->delta != NULL) return;
+  c->delta = calloc((size_t)size, sizeof(t_delta));
+  assert(c->delta != NULL);
+  STAT_BYTES((size_t)size * sizeof(t_delta));
+}
+
+// Poids du tampon, créés à 1 au premier poids
+static float * delta_weights(t_delta * d) {
+  if (d->w == NULL) {
+    d->w = malloc((size_t)(d->cap > 0 ? d->cap : 1) * sizeof(*(d->w)));
+    assert(d->w != NULL);
+    STAT_BYTES((size_t)d->cap * sizeof(*(d->w)));
+    for (int i = 0; i < d->len; i++) d->w[i] = 1.0f;
+  }
+  return d->w;
+}
+
+static void csr_delta_push(t_delta * d, t_vertex to, float w) {
+  if (w != 1.0f) delta_weights(d);
+  if (d->len == d->cap) {
+    int cap = d->cap ? 2 * d->cap : 4;
+    t_vertex * v = realloc(d->v, (size_t)cap * sizeof(*v));
+    assert(v != NULL);
+    STAT_BYTES((size_t)(cap - d->cap) * sizeof(*v));
+    d->v = v;
+    if (d->w != NULL) {
+      float * dw = realloc(d->w, (size_t)cap * sizeof(*dw));
+      assert(dw != NULL);
+      STAT_BYTES((size_t)(cap - d->cap) * sizeof(*dw));
+      d->w = dw;
+    }
+    d->cap = cap;
+  }
+  if (d->w != NULL) d->w[d->len] = w;
+  d->v[d->len++] = to;
+}
+
+// Ajout de l'arête (u, to) de poids w, ou baisse de son poids si elle existe
+// déjà ; sans compactage ni mise à jour de nb_delta et nb_dead. Retourne 1 si
+// l'arête est allée dans le tampon, -1 si une arête supprimée a été rétablie, 0 sinon.
+static int csr_put(struct csr * c, int size, t_vertex u, t_vertex to, float w) {
+  long long i = csr_find(c, u, to);
+  if (i >= 0 && csr_is_dead(c, i)) {
+    // Arête supprimée depuis le dernier compactage : on la rétablit
+    c->dead[i >> 6] &= ~(1ULL << (i & 63));
+    if (w != 1.0f || c->w != NULL) csr_weights(c, size)[i] = w;
+    return -1;
+  }
+  if (i >= 0) {
+    if (w < csr_weight(c, i)) csr_weights(c, size)[i] = w;
+    return 0;
+  }
+  int j = csr_find_delta(c, u, to);
+  if (j >= 0) {
+    t_delta * d = &c->delta[u];
+    if (w < delta_weight(d, j)) delta_weights(d)[j] = w;
+    return 0;
+  }
+  csr_alloc_delta(c, size);
+  csr_delta_push(&c->delta[u], to, w);
+  return 1;
+}
+
+static t_bool csr_remove_edge(struct csr * c, int size, t_vertex u, t_vertex to) {
+  int j = csr_find_delta(c, u, to);
+  if (j >= 0) {
+    t_delta * d = &c->delta[u];
+    d->v[j] = d->v[--d->len];
+    if (d->w != NULL) d->w[j] = d->w[d->len];
+    c->nb_delta--;
+    return 1;
+  }
+  long long i = csr_find(c, u, to);
+  if (i < 0 || csr_is_dead(c, i)) return 0;
+  if (c->dead == NULL) {
+    c->dead = calloc(csr_dead_words(c, size), sizeof(uint64_t));
+    assert(c->dead != NULL);
+    STAT_BYTES(csr_dead_words(c, size) * sizeof(uint64_t));
+  }
+  c->dead[i >> 6] |= 1ULL << (i & 63);
+  c->nb_dead++;
+  csr_maybe_compact(c, size);
+  return 1;
+}
+
+// Construction en bloc d'un CSR vide à partir de len arêtes (from, to) et de
+// leurs poids w (NULL : tous 1) : tri par comptage sur l'origine, tri de chaque
+// ligne, doublons retirés (le plus petit poids est gardé)
+static void csr_build(struct csr * c, int size, const t_vertex * e, const float * w, size_t len) {
+  assert(c->off[size] == 0 && c->nb_delta == 0 && c->w == NULL);
+  long long * off = c->off;
+  for (size_t i = 0; i < len; i++) off[e[2 * i] + 1]++;
+  for (int u = 0; u < size; u++) off[u + 1] += off[u];
+  long long * fill = malloc((size_t)size * sizeof(*fill));
+  assert(fill != NULL);
+  memcpy(fill, off, (size_t)size * sizeof(*fill));
+
+  long long k = 0;
+  t_vertex * succ;
+  float * sw = NULL;
+  if (w == NULL) {
+    succ = malloc((len > 0 ? len : 1) * sizeof(*succ));
+    assert(succ != NULL);
+    for (size_t i = 0; i < len; i++) succ[fill[e[2 * i]]++] = e[2 * i + 1];
+    for (int u = 0; u < size; u++) {
+      long long lo = off[u], hi = off[u + 1];
+      t_bool sorted = 1;
+      for (long long i = lo + 1; i < hi && sorted; i++) sorted = succ[i - 1] <= succ[i];
+      if (!sorted) qsort(succ + lo, (size_t)(hi - lo), sizeof(*succ), cmp_vertex);
+      off[u] = k;
+      for (long long i = lo; i < hi; i++) {
+        if (i > lo && succ[i] == succ[i - 1]) continue;
+        succ[k++] = succ[i];
+      }
+    }
+  } else {
+    // Couples (sommet, poids) triés ensemble, puis séparés
+    t_wsucc * tmp = malloc((len > 0 ? len : 1) * sizeof(*tmp));
+    succ = malloc((len > 0 ? len : 1) * sizeof(*succ));
+    sw = malloc((len > 0 ? len : 1) * sizeof(*sw));
+    assert(tmp != NULL && succ != NULL && sw != NULL);
+    for (size_t i = 0; i < len; i++) tmp[fill[e[2 * i]]++] = (t_wsucc){ e[2 * i + 1], w[i] };
+    for (int u = 0; u < size; u++) {
+      long long lo = off[u], hi = off[u + 1];
+      qsort(tmp + lo, (size_t)(hi - lo), sizeof(*tmp), cmp_wsucc);
+      off[u] = k;
+      for (long long i = lo; i < hi; i++) {
+        if (i > lo && tmp[i].v == tmp[i - 1].v) continue;
+        succ[k] = tmp[i].v;
+        sw[k++] = tmp[i].w;
+      }
+    }
+    free(tmp);
+  }
+  free(fill);
+  off[size] = k;
+  if (k < (long long)len && k > 0) {
+    t_vertex * shrunk = realloc(succ, (size_t)k * sizeof(*succ));
+    if (shrunk != NULL) succ = shrunk;
+    float * wshrunk = sw != NULL ? realloc(sw, (size_t)k * sizeof(*sw)) : NULL;
+    if (wshrunk != NULL) sw = wshrunk;
+  }
+  c->succ = succ;
+  c->w = sw;
+  STAT_BYTES((size_t)k * (sizeof(*succ) + (sw != NULL ? sizeof(*sw) : 0)));
+}
+
 // Définition de la structure de graphe (cachée dans ce fichier)
 struct graph {
   int size;
-  t_bool use_matrix; // 1 : matrice d'adjacence ; 0 : listes d'adjacence
+  int kind; // GRAPH_LIST, GRAPH_MATRIX ou GRAPH_CSR
   union {
-    t_list * adj;   // Tableau de listes d'adjacence
-    t_bool ** m;    // Matrice d'adjacence dynamique
+    t_list * adj;      // Tableau de listes d'adjacence
+    t_bool ** m;       // Matrice d'adjacence dynamique
+    struct csr * csr;  // Représentation compacte modifiable
   } repr;
-  char ** names;    // Noms de sommets (optionnel)
+  float ** mw;              // Matrice : poids par ligne (NULL tant qu'ils valent tous 1)
+  struct name_pool * pool; // Réserve des noms de sommets (optionnelle, partagée)
+  struct name_dict * dict; // ou dictionnaire compressé des noms (partagé)
+  size_t * name_off;        // Position du nom de chaque sommet dans la réserve, ou son rang dans dict
+  struct shard * locks;     // Verrous de la construction concurrente (NULL hors de ce mode)
+};
+
+// Réserve de noms : toutes les chaînes bout à bout dans un seul bloc, avec un
+// compteur de références. Un graphe et son transposé (ou tout graphe dérivé)
+// partagent la même réserve au lieu de recopier chaque nom. La réserve n'est
+// plus modifiée dès qu'elle est partagée.
+#define NO_NAME ((size_t)-1)
+
+// Compteurs de références des noms partagés : un graphe const peut être dérivé
+// (graph_reverse, graph_induced_subgraph) par plusieurs fils à la fois
+#ifndef GRAPH_NO_THREADS
+typedef atomic_int t_refcount;
+#define REF_INIT(r) atomic_init(&(r), 1)
+#define REF_RETAIN(r) atomic_fetch_add_explicit(&(r), 1, memory_order_relaxed)
+#define REF_RELEASE(r) (atomic_fetch_sub_explicit(&(r), 1, memory_order_acq_rel) - 1) // restantes
+#define REF_LOAD(r) atomic_load_explicit(&(r), memory_order_relaxed)
+#else
+typedef int t_refcount;
+#define REF_INIT(r) ((r) = 1)
+#define REF_RETAIN(r) ((r)++)
+#define REF_RELEASE(r) (--(r))
+#define REF_LOAD(r) (r)
+#endif
+
+struct name_pool {
+  t_refcount refs;
+  size_t len;
+  size_t cap;
+  char * data;
+};
+
+static struct name_pool * name_pool_new(size_t cap) {
+  struct name_pool * pool = malloc(sizeof(*pool));
+  if (pool == NULL) return NULL;
+  REF_INIT(pool->refs);
+  pool->len = 0;
+  pool->cap = cap > 0 ? cap : 64;
+  pool->data = malloc(pool->cap);
+  if (pool->data == NULL) {
+    free(pool);
+    return NULL;
+  }
+  STAT_BYTES(sizeof(*pool) + pool->cap);
+  return pool;
+}
+
+static struct name_pool * name_pool_retain(struct name_pool * pool) {
+  REF_RETAIN(pool->refs);
+  return pool;
+}
+
+static void name_pool_release(struct name_pool * pool) {
+  if (pool == NULL || REF_RELEASE(pool->refs) > 0) return;
+  STAT_BYTES(-(long long)(sizeof(*pool) + pool->cap));
+  free(pool->data);
+  free(pool);
+}
+
+// Ajoute une copie de s à la réserve et retourne sa position
+static size_t name_pool_add(struct name_pool * pool, const char * s) {
+  assert(REF_LOAD(pool->refs) == 1);
+  size_t len = strlen(s) + 1;
+  if (pool->len + len > pool->cap) {
+    size_t cap = pool->cap;
+    while (pool->len + len > cap) cap *= 2;
+    char * data = realloc(pool->data, cap);
+    assert(data != NULL);
+    STAT_BYTES(cap - pool->cap);
+    pool->data = data;
+    pool->cap = cap;
+  }
+  size_t off = pool->len;
+  memcpy(pool->data + off, s, len);
+  pool->len += len;
+  return off;
+}
+
+// Dictionnaire de noms : les noms triés, codés par préfixe. Ils sont rangés par
+// groupes de NAME_DICT_BUCKET ; le premier nom d'un groupe est écrit en entier
+// (point de reprise), chacun des suivants par la longueur du préfixe commun avec
+// le précédent (un octet) puis le reste. Les noms partageant de longs préfixes
+// (java.util., ...) n'en gardent qu'une copie par groupe. Un nom se retrouve par
+// recherche dichotomique sur les points de reprise puis décodage d'un groupe ; un
+// préfixe donne un intervalle de rangs. Comme la réserve, le dictionnaire est
+// partagé entre graphes dérivés, et name_off[v] y donne le rang du nom de v.
+// Les noms viennent de lignes de MAX_READ_LINE octets : ils tiennent dans un
+// tampon de cette taille, et leurs longueurs dans un octet.
+#define NAME_DICT_BUCKET 16
+#define NAME_RING 8
+_Static_assert(MAX_READ_LINE <= 256, "préfixes communs codés sur un octet");
+
+struct name_dict {
+  t_refcount refs;
+  int n;              // noms, de rang 0 à n - 1
+  size_t * start;     // position du point de reprise de chaque groupe dans data
+  char * data;
+  size_t len;
+  t_vertex * ids;     // sommet (du graphe d'origine) de chaque rang
 };
 
+struct name_entry {
+  const char * s;
+  t_vertex v;
+};
+
+static int name_entry_cmp(const void * a, const void * b) {
+  const struct name_entry * x = a, * y = b;
+  int c = strcmp(x->s, y->s);
+  return c != 0 ? c : (x->v > y->v) - (x->v < y->v); // homonymes : ordre des sommets
+}
+
+static size_t name_dict_bytes(const struct name_dict * d) {
+  size_t nb_buckets = ((size_t)d->n + NAME_DICT_BUCKET - 1) / NAME_DICT_BUCKET;
+  return sizeof(*d) + d->len + nb_buckets * sizeof(*(d->start)) + (size_t)d->n * sizeof(*(d->ids));
+}
+
+static void name_dict_release(struct name_dict * d) {
+  if (d == NULL || REF_RELEASE(d->refs) > 0) return;
+  STAT_BYTES(-(long long)name_dict_bytes(d));
+  free(d->start);
+  free(d->data);
+  free(d->ids);
+  free(d);
+}
+
+// Dictionnaire des noms de g (réserve) ; rank[v] reçoit le rang du nom de v.
+// NULL si la mémoire manque.
+static struct name_dict * name_dict_build(const t_graph * g, size_t * rank) {
+  struct name_entry * e = malloc((size_t)g->size * sizeof(*e));
+  struct name_dict * d = calloc(1, sizeof(*d));
+  if (e == NULL || d == NULL) {
+    free(e);
+    free(d);
+    return NULL;
+  }
+  int n = 0;
+  size_t total = 0;
+  for (t_vertex v = 0; v < g->size; v++) {
+    if (g->name_off[v] == NO_NAME) continue;
+    e[n].s = g->pool->data + g->name_off[v];
+    e[n].v = v;
+    total += strlen(e[n].s) + 2;
+    n++;
+  }
+  qsort(e, (size_t)n, sizeof(*e), name_entry_cmp);
+
+  REF_INIT(d->refs);
+  d->n = n;
+  d->start = malloc(((size_t)n + NAME_DICT_BUCKET - 1) / NAME_DICT_BUCKET * sizeof(*(d->start)) + 1);
+  d->ids = malloc((size_t)n * sizeof(*(d->ids)) + 1);
+  d->data = malloc(total + 1); // borne : chaque nom en entier avec son octet de préfixe
+  if (d->start == NULL || d->ids == NULL || d->data == NULL) {
+    free(e);
+    free(d->start);
+    free(d->ids);
+    free(d->data);
+    free(d);
+    return NULL;
+  }
+  const char * prev = "";
+  for (int r = 0; r < n; r++) {
+    size_t lcp = 0;
+    if (r % NAME_DICT_BUCKET == 0) {
+      d->start[r / NAME_DICT_BUCKET] = d->len;
+    } else {
+      while (prev[lcp] != '\0' && prev[lcp] == e[r].s[lcp]) lcp++;
+      d->data[d->len++] = (char)lcp;
+    }
+    size_t k = strlen(e[r].s + lcp) + 1;
+    memcpy(d->data + d->len, e[r].s + lcp, k);
+    d->len += k;
+    d->ids[r] = e[r].v;
+    rank[e[r].v] = (size_t)r;
+    prev = e[r].s;
+  }
+  free(e);
+  char * data = realloc(d->data, d->len + 1);
+  if (data != NULL) d->data = data;
+  STAT_BYTES(name_dict_bytes(d));
+  return d;
+}
+
+// Parcours des noms dans l'ordre, à partir d'un rang
+typedef struct {
+  const struct name_dict * d;
+  int r;              // rang du nom dans buf
+  const char * p;     // codage du nom suivant
+  char buf[MAX_READ_LINE];
+} t_name_iter;
+
+// Place dans it->buf le nom de rang r (r < n)
+static void name_iter_seek(t_name_iter * it, const struct name_dict * d, int r) {
+  it->d = d;
+  const char * p = d->data + d->start[r / NAME_DICT_BUCKET];
+  size_t k = strlen(p) + 1;
+  memcpy(it->buf, p, k);
+  p += k;
+  for (int i = r - r % NAME_DICT_BUCKET; i < r; i++) {
+    size_t lcp = (unsigned char)*p++;
+    k = strlen(p) + 1;
+    memcpy(it->buf + lcp, p, k);
+    p += k;
+  }
+  it->r = r;
+  it->p = p;
+}
+
+// Passe au nom suivant ; retourne 0 après le dernier
+static t_bool name_iter_next(t_name_iter * it) {
+  int r = it->r + 1;
+  if (r >= it->d->n) return 0;
+  if (r % NAME_DICT_BUCKET == 0) {
+    name_iter_seek(it, it->d, r);
+    return 1;
+  }
+  size_t lcp = (unsigned char)*it->p++;
+  size_t k = strlen(it->p) + 1;
+  memcpy(it->buf + lcp, it->p, k);
+  it->p += k;
+  it->r = r;
+  return 1;
+}
+
+// Premier rang dont le nom est >= name (n si aucun) : dichotomie sur les points
+// de reprise, puis parcours d'un groupe
+static int name_dict_lower_bound(const struct name_dict * d, const char * name) {
+  int nb_buckets = (d->n + NAME_DICT_BUCKET - 1) / NAME_DICT_BUCKET;
+  int lo = 0, hi = nb_buckets; // premier groupe dont le point de reprise est > name
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    STAT_ADD(name_compares, 1);
+    if (strcmp(d->data + d->start[mid], name) <= 0) lo = mid + 1;
+    else hi = mid;
+  }
+  if (lo == 0) return 0;
+  int first = (lo - 1) * NAME_DICT_BUCKET;
+  int end = first + NAME_DICT_BUCKET < d->n ? first + NAME_DICT_BUCKET : d->n;
+  t_name_iter it;
+  name_iter_seek(&it, d, first);
+  for (;;) {
+    STAT_ADD(name_compares, 1);
+    if (strcmp(it.buf, name) >= 0) return it.r;
+    if (it.r + 1 >= end) return end; // le groupe suivant commence après name
+    name_iter_next(&it);
+  }
+}
+
+// Sommet de g dont le nom a le rang r (-1 si aucun) : directement pour le graphe
+// d'origine et ses transposés, en parcourant name_off pour un sous-graphe
+static t_vertex name_dict_vertex(const t_graph * g, int r) {
+  t_vertex v = g->dict->ids[r];
+  if (v < g->size && g->name_off[v] == (size_t)r) return v;
+  for (t_vertex u = 0; u < g->size; u++) {
+    if (g->name_off[u] == (size_t)r) return u;
+  }
+  return -1;
+}
+
+static int name_dict_mode = -1; // -1 : pas encore lu, 0 : réserve, 1 : dictionnaire
+
+void graph_set_name_dict(t_bool on) {
+  name_dict_mode = on ? 1 : 0;
+}
+
+static t_bool name_dict_on(void) {
+  if (name_dict_mode < 0) {
+    const char * env = getenv("GRAPH_NAME_DICT");
+    name_dict_mode = (env != NULL && env[0] != '\0' && strcmp(env, "0") != 0);
+  }
+  return name_dict_mode;
+}
+
+t_bool graph_compress_names(t_graph * g) {
+  assert(g != NULL);
+  if (g->dict != NULL) return 1;
+  if (g->pool == NULL) return 0;
+  size_t * rank = malloc((size_t)g->size * sizeof(*rank));
+  if (rank == NULL) return 0;
+  struct name_dict * d = name_dict_build(g, rank);
+  if (d == NULL) {
+    free(rank);
+    return 0;
+  }
+  for (t_vertex v = 0; v < g->size; v++) {
+    if (g->name_off[v] != NO_NAME) g->name_off[v] = rank[v];
+  }
+  free(rank);
+  name_pool_release(g->pool);
+  g->pool = NULL;
+  g->dict = d;
+  return 1;
+}
+
 // Fonctions utilitaires
 static void trim_trailing(char * s) {
   size_t len = strlen(s);
@@ -65,60 +847,300 @@ static int read_line_skip_empty(FILE * f, char * buf, size_t len) {
   return 0;
 }
 
-static char * str_dup(const char * s) {
-  size_t len = strlen(s) + 1;
-  char * copy = malloc(len);
-  assert(copy != NULL);
-  memcpy(copy, s, len);
-  return copy;
+// Poids de la matrice : une ligne de poids par sommet, allouée au premier
+// poids différent de 1 de cette ligne
+static void matrix_alloc_weight_rows(t_graph * g) {
+  if (g->mw != NULL) return;
+  g->mw = calloc((size_t)g->size, sizeof(*(g->mw)));
+  assert(g->mw != NULL);
+  STAT_BYTES((size_t)g->size * sizeof(*(g->mw)));
+}
+
+static float * matrix_weights(t_graph * g, t_vertex u) {
+  matrix_alloc_weight_rows(g);
+  if (g->mw[u] == NULL) {
+    g->mw[u] = malloc((size_t)g->size * sizeof(float));
+    assert(g->mw[u] != NULL);
+    STAT_BYTES((size_t)g->size * sizeof(float));
+    for (int v = 0; v < g->size; v++) g->mw[u][v] = 1.0f;
+  }
+  return g->mw[u];
+}
+
+static float matrix_weight(const t_graph * g, t_vertex u, t_vertex v) {
+  return g->mw != NULL && g->mw[u] != NULL ? g->mw[u][v] : 1.0f;
+}
+
+static void matrix_drop_weights(t_graph * g) {
+  if (g->mw == NULL) return;
+  for (int u = 0; u < g->size; u++) {
+    if (g->mw[u] != NULL) STAT_BYTES(-(long long)((size_t)g->size * sizeof(float)));
+    free(g->mw[u]);
+  }
+  STAT_BYTES(-(long long)((size_t)g->size * sizeof(*(g->mw))));
+  free(g->mw);
+  g->mw = NULL;
 }
 
 // Création / libération
-t_graph * graph_new(int size, t_bool with_names, t_bool use_matrix) {
+#ifdef GRAPH_STATS
+// Tableaux fixes de la représentation (le CSR compte lui-même ses allocations)
+static size_t graph_table_bytes(const t_graph * g) {
+  switch (g->kind) {
+  case GRAPH_MATRIX: return (size_t)g->size * (sizeof(*(g->repr.m)) + (size_t)g->size * sizeof(t_bool));
+  case GRAPH_CSR: return 0;
+  default: return (size_t)g->size * sizeof(*(g->repr.adj));
+  }
+}
+#endif
+
+// Retourne NULL (avec un message) si la mémoire manque, sans rien laisser alloué
+t_graph * graph_new(int size, t_bool with_names, int repr) {
   assert(size > 0);
-  t_graph * g = malloc(sizeof(*g));
-  assert(g != NULL);
+  t_graph * g = calloc(1, sizeof(*g));
+  if (g == NULL) return NULL;
   g->size = size;
-  g->use_matrix = use_matrix;
-  if (use_matrix) {
+  g->kind = (repr == GRAPH_MATRIX || repr == GRAPH_CSR) ? repr : GRAPH_LIST;
+  t_bool ok;
+  if (g->kind == GRAPH_MATRIX) {
     g->repr.m = calloc((size_t)size, sizeof(*(g->repr.m)));
-    assert(g->repr.m != NULL);
-    for (int i = 0; i < size; i++) {
+    ok = g->repr.m != NULL;
+    for (int i = 0; i < size && ok; i++) {
       g->repr.m[i] = calloc((size_t)size, sizeof(*(g->repr.m[i])));
-      assert(g->repr.m[i] != NULL);
+      ok = g->repr.m[i] != NULL;
     }
+  } else if (g->kind == GRAPH_CSR) {
+    g->repr.csr = csr_new(size);
+    ok = g->repr.csr != NULL;
   } else {
     g->repr.adj = calloc((size_t)size, sizeof(*(g->repr.adj)));
-    assert(g->repr.adj != NULL);
+    ok = g->repr.adj != NULL;
+  }
+  if (ok && with_names) {
+    g->pool = name_pool_new((size_t)size * 16);
+    g->name_off = malloc((size_t)size * sizeof(*(g->name_off)));
+    ok = g->pool != NULL && g->name_off != NULL;
+    for (int i = 0; i < size && ok; i++) {
+      g->name_off[i] = NO_NAME;
+    }
   }
-  g->names = with_names ? calloc((size_t)size, sizeof(*(g->names))) : NULL;
-  if (with_names) {
-    assert(g->names != NULL);
+  if (!ok) {
+    fprintf(stderr, "Mémoire insuffisante pour un graphe de %d sommets (%s, %.1f Mo estimés)\n", size,
+            graph_representation_name(g->kind),
+            (double)graph_estimate_memory(g->kind, size, 0, with_names).total / (1 << 20));
+    if (g->kind == GRAPH_MATRIX && g->repr.m != NULL) {
+      for (int i = 0; i < size; i++) free(g->repr.m[i]);
+      free(g->repr.m);
+    } else if (g->kind == GRAPH_CSR) {
+      if (g->repr.csr != NULL) csr_free(g->repr.csr, size);
+    } else {
+      free(g->repr.adj);
+    }
+    if (g->pool != NULL) name_pool_release(g->pool);
+    free(g->name_off);
+    free(g);
+    return NULL;
   }
+  STAT_BYTES(sizeof(*g) + graph_table_bytes(g)
+             + (with_names ? (size_t)size * sizeof(*(g->name_off)) : 0));
   return g;
 }
 
 void graph_free(t_graph * g) {
   if (g == NULL) return;
-  if (g->use_matrix) {
+  STAT_BYTES(-(long long)(sizeof(*g) + graph_table_bytes(g)
+                          + (g->name_off != NULL ? (size_t)g->size * sizeof(*(g->name_off)) : 0)));
+  if (g->kind == GRAPH_MATRIX) {
     for (int i = 0; i < g->size; i++) {
       free(g->repr.m[i]);
     }
     free(g->repr.m);
+    matrix_drop_weights(g);
+  } else if (g->kind == GRAPH_CSR) {
+    csr_free(g->repr.csr, g->size);
   } else {
     for (int i = 0; i < g->size; i++) {
       g->repr.adj[i] = list_free(g->repr.adj[i]);
     }
     free(g->repr.adj);
   }
+  name_pool_release(g->pool);
+  name_dict_release(g->dict);
+  free(g->name_off);
+  free(g->locks);
+  free(g);
+}
+
+// Mémoire occupée et budget
+// Les tailles sont celles demandées aux allocations (sans le surcoût de malloc).
+static size_t locks_bytes(const t_graph * g);
+
+t_graph_memory graph_memory_usage(const t_graph * g) {
+  assert(g != NULL);
+  t_graph_memory m = { 0, 0, 0, 0 };
+  size_t n = (size_t)g->size;
+  if (g->kind == GRAPH_MATRIX) {
+    m.index = n * sizeof(*(g->repr.m));
+    m.adjacency = n * n * sizeof(t_bool);
+    if (g->mw != NULL) {
+      m.index += n * sizeof(*(g->mw));
+      for (size_t u = 0; u < n; u++) {
+        if (g->mw[u] != NULL) m.adjacency += n * sizeof(float);
+      }
+    }
+  } else if (g->kind == GRAPH_CSR) {
+    const struct csr * c = g->repr.csr;
+    size_t len = (size_t)c->off[n];
+    m.index = sizeof(*c) + (n + 1) * sizeof(*(c->off));
+    m.adjacency = len * (sizeof(t_vertex) + (c->w != NULL ? sizeof(float) : 0));
+    if (c->dead != NULL) m.index += csr_dead_words(c, g->size) * sizeof(uint64_t);
+    if (c->delta != NULL) {
+      m.index += n * sizeof(t_delta);
+      for (size_t u = 0; u < n; u++) {
+        const t_delta * d = &c->delta[u];
+        m.adjacency += (size_t)d->cap * (sizeof(t_vertex) + (d->w != NULL ? sizeof(float) : 0));
+      }
+    }
+  } else {
+    m.index = n * sizeof(*(g->repr.adj));
+    for (size_t u = 0; u < n; u++) {
+      for (const t_node * p = g->repr.adj[u]; p != NULL; p = p->p_next) m.adjacency += sizeof(t_node);
+    }
+  }
+  m.index += locks_bytes(g);
+  if (g->pool != NULL) {
+    m.names = sizeof(*(g->pool)) + g->pool->cap + n * sizeof(*(g->name_off));
+  } else if (g->dict != NULL) {
+    m.names = name_dict_bytes(g->dict) + n * sizeof(*(g->name_off));
+  }
+  m.total = sizeof(*g) + m.adjacency + m.index + m.names;
+  return m;
+}
 
-  if (g->names != NULL) {
-    for (int i = 0; i < g->size; i++) {
-      free(g->names[i]);
+// Même découpage que graph_memory_usage, pour un graphe non pondéré et compacté ;
+// les noms comptent la réserve initiale (16 octets par sommet)
+t_graph_memory graph_estimate_memory(int repr, int size, long long nb_edges, t_bool with_names) {
+  assert(size > 0 && nb_edges >= 0);
+  if (repr == GRAPH_AUTO) repr = graph_choose_representation(size, nb_edges);
+  t_graph_memory m = { 0, 0, 0, 0 };
+  double n = (double)size, e = (double)nb_edges, adjacency, index;
+  if (repr == GRAPH_MATRIX) {
+    index = n * sizeof(t_bool *);
+    adjacency = n * n * sizeof(t_bool);
+  } else if (repr == GRAPH_CSR) {
+    index = sizeof(struct csr) + (n + 1) * sizeof(long long);
+    adjacency = e * sizeof(t_vertex);
+  } else {
+    index = n * sizeof(t_list);
+    adjacency = e * sizeof(t_node);
+  }
+  // En double : une matrice de 2^31 sommets dépasse size_t sur 32 bits
+  m.adjacency = adjacency < (double)SIZE_MAX ? (size_t)adjacency : SIZE_MAX;
+  m.index = (size_t)index;
+  if (with_names) m.names = sizeof(struct name_pool) + (size_t)size * (16 + sizeof(size_t));
+  double total = (double)sizeof(t_graph) + adjacency + index + (double)m.names;
+  m.total = total < (double)SIZE_MAX ? (size_t)total : SIZE_MAX;
+  return m;
+}
+
+// Budget des lectures : -1 tant que GRAPH_MEMORY_BUDGET n'a pas été lu
+static long long memory_budget = -1;
+
+void graph_set_memory_budget(size_t bytes) {
+  memory_budget = (long long)bytes;
+}
+
+// Nombre d'octets avec suffixe k, M ou G facultatif ; -1 si illisible
+long long graph_parse_bytes(const char * s) {
+  char * end;
+  double v = strtod(s, &end);
+  if (end == s || !isfinite(v) || v < 0) return -1;
+  switch (*end) {
+  case 'k': case 'K': v *= 1024.0; end++; break;
+  case 'm': case 'M': v *= 1024.0 * 1024.0; end++; break;
+  case 'g': case 'G': v *= 1024.0 * 1024.0 * 1024.0; end++; break;
+  default: break;
+  }
+  // 2^63 et au-delà ne tiennent pas dans un long long (conversion indéfinie)
+  if (*end != '\0' || v >= 9223372036854775808.0) return -1;
+  return (long long)v;
+}
+
+size_t graph_memory_budget(void) {
+  if (memory_budget < 0) {
+    const char * env = getenv("GRAPH_MEMORY_BUDGET");
+    long long v = env != NULL ? graph_parse_bytes(env) : -1;
+    if (env != NULL && v < 0) fprintf(stderr, "GRAPH_MEMORY_BUDGET illisible ignoré : \"%s\"\n", env);
+    if (v < 0) {
+      // Par défaut, la mémoire physique de la machine
+      long pages = sysconf(_SC_PHYS_PAGES), page = sysconf(_SC_PAGESIZE);
+      v = (pages > 0 && page > 0) ? (long long)pages * page : 0;
     }
+    memory_budget = v;
   }
-  free(g->names);
-  free(g);
+  return (size_t)memory_budget;
+}
+
+// Représentation à créer par une lecture pour size sommets et au moins nb_edges
+// arêtes : repr s'il tient dans le budget, sinon le CSR (plus compact) avec un
+// message ; GRAPH_REPR_INVALID, avec un message, si même le CSR le dépasse
+static int budget_representation(const char * who, int repr, int size, long long nb_edges,
+                                 t_bool with_names) {
+  size_t budget = graph_memory_budget();
+  if (budget == 0) return repr;
+  size_t need = graph_estimate_memory(repr, size, nb_edges, with_names).total;
+  if (need <= budget) return repr;
+  size_t csr = graph_estimate_memory(GRAPH_CSR, size, nb_edges, with_names).total;
+  if (csr <= budget) {
+    fprintf(stderr, "%s : %s de %d sommets estimée à %.1f Mo, au-delà du budget mémoire (%.1f Mo) ; csr utilisé\n",
+            who, graph_representation_name(repr), size, (double)need / (1 << 20), (double)budget / (1 << 20));
+    return GRAPH_CSR;
+  }
+  if (nb_edges > 0) {
+    fprintf(stderr, "%s : graphe de %d sommets et %lld arêtes estimé à %.1f Mo, au-delà du budget mémoire (%.1f Mo)\n",
+            who, size, nb_edges, (double)csr / (1 << 20), (double)budget / (1 << 20));
+  } else {
+    fprintf(stderr, "%s : graphe de %d sommets estimé à au moins %.1f Mo, au-delà du budget mémoire (%.1f Mo)\n",
+            who, size, (double)csr / (1 << 20), (double)budget / (1 << 20));
+  }
+  return GRAPH_REPR_INVALID;
+}
+
+// Choix de la représentation
+// Le CSR coûte sizeof(t_vertex) octets par arête plus une position par sommet,
+// lus séquentiellement ; une case de matrice coûte sizeof(t_bool) octets et la
+// matrice parcourt n cases par sommet, mais teste une arête en O(1). La matrice
+// est retenue quand elle n'occupe pas plus du double du CSR, soit au moins une
+// arête sur deux couples (u, v) : son parcours reste alors du même ordre. Les
+// listes (environ 32 octets par arête) ne sont plus choisies automatiquement ;
+// elles restent utiles pour un graphe surtout construit par petits ajouts.
+int graph_choose_representation(int size, long long nb_edges) {
+  double cells = (double)size * (double)size * sizeof(t_bool);
+  double packed = (double)nb_edges * sizeof(t_vertex) + ((double)size + 1) * sizeof(long long);
+  return cells <= 2 * packed ? GRAPH_MATRIX : GRAPH_CSR;
+}
+
+int graph_representation(const t_graph * g) {
+  assert(g != NULL);
+  return g->kind;
+}
+
+const char * graph_representation_name(int repr) {
+  switch (repr) {
+  case GRAPH_LIST: return "list";
+  case GRAPH_MATRIX: return "matrix";
+  case GRAPH_CSR: return "csr";
+  case GRAPH_AUTO: return "auto";
+  default: return NULL;
+  }
+}
+
+int graph_representation_from_name(const char * name) {
+  const int all[] = { GRAPH_LIST, GRAPH_MATRIX, GRAPH_CSR, GRAPH_AUTO };
+  for (size_t i = 0; name != NULL && i < sizeof(all) / sizeof(all[0]); i++) {
+    if (strcmp(name, graph_representation_name(all[i])) == 0) return all[i];
+  }
+  return GRAPH_REPR_INVALID;
 }
 
 int graph_size(const t_graph * g) {
@@ -126,63 +1148,288 @@ int graph_size(const t_graph * g) {
 }
 
 t_bool graph_has_names(const t_graph * g) {
-  return (g != NULL && g->names != NULL);
+  return (g != NULL && (g->pool != NULL || g->dict != NULL));
 }
 
+// Pointeur dans la réserve partagée : valable tant que le graphe existe. Avec
+// le dictionnaire, le nom est décodé dans l'un des NAME_RING tampons du fil.
 const char * graph_vertex_name(const t_graph * g, t_vertex v) {
-  if (g == NULL || g->names == NULL) return NULL;
-  if (v < 0 || v >= g->size) return NULL;
-  return g->names[v];
+  if (!graph_has_names(g)) return NULL;
+  if (v < 0 || v >= g->size || g->name_off[v] == NO_NAME) return NULL;
+  if (g->pool != NULL) return g->pool->data + g->name_off[v];
+  static _Thread_local t_name_iter ring[NAME_RING];
+  static _Thread_local unsigned next;
+  t_name_iter * it = &ring[next++ % NAME_RING];
+  name_iter_seek(it, g->dict, (int)g->name_off[v]);
+  return it->buf;
+}
+
+int graph_vertex_name_copy(const t_graph * g, t_vertex v, char * buf, size_t cap) {
+  if (!graph_has_names(g) || v < 0 || v >= g->size || g->name_off[v] == NO_NAME) return -1;
+  const char * name;
+  t_name_iter it;
+  if (g->pool != NULL) {
+    name = g->pool->data + g->name_off[v];
+  } else {
+    name_iter_seek(&it, g->dict, (int)g->name_off[v]);
+    name = it.buf;
+  }
+  size_t len = strlen(name);
+  if (cap > 0) {
+    size_t k = len < cap - 1 ? len : cap - 1;
+    memcpy(buf, name, k);
+    buf[k] = '\0';
+  }
+  return (int)len;
 }
 
 t_vertex graph_vertex_from_name(const t_graph * g, const char * name) {
-  if (g == NULL || g->names == NULL || name == NULL) return -1;
+  if (!graph_has_names(g) || name == NULL) return -1;
+  STAT_ADD(name_lookups, 1);
+  if (g->dict != NULL) {
+    int r = name_dict_lower_bound(g->dict, name);
+    if (r >= g->dict->n) return -1;
+    t_name_iter it;
+    name_iter_seek(&it, g->dict, r);
+    do {
+      if (strcmp(it.buf, name) != 0) break;
+      t_vertex v = name_dict_vertex(g, it.r); // homonymes : le premier présent dans g
+      if (v >= 0) return v;
+    } while (name_iter_next(&it));
+    return -1;
+  }
   for (int i = 0; i < g->size; i++) {
-    if (g->names[i] != NULL && strcmp(g->names[i], name) == 0) {
+    if (g->name_off[i] != NO_NAME && strcmp(g->pool->data + g->name_off[i], name) == 0) {
+      STAT_ADD(name_compares, (unsigned long long)i + 1);
       return i;
     }
   }
+  STAT_ADD(name_compares, (unsigned long long)g->size);
   return -1;
 }
 
+int graph_vertices_with_prefix(const t_graph * g, const char * prefix, t_vertex * out) {
+  assert(g != NULL && prefix != NULL);
+  if (!graph_has_names(g)) return 0;
+  size_t len = strlen(prefix);
+  int nb = 0;
+  if (g->pool != NULL) {
+    for (t_vertex v = 0; v < g->size; v++) {
+      if (g->name_off[v] == NO_NAME || strncmp(g->pool->data + g->name_off[v], prefix, len) != 0) continue;
+      if (out != NULL) out[nb] = v;
+      nb++;
+    }
+    return nb;
+  }
+
+  // Dictionnaire : intervalle [lo, hi[ des rangs portant le préfixe
+  const struct name_dict * d = g->dict;
+  int lo = name_dict_lower_bound(d, prefix), hi = lo;
+  if (lo < d->n) {
+    t_name_iter it;
+    name_iter_seek(&it, d, lo);
+    while (strncmp(it.buf, prefix, len) == 0) {
+      hi++;
+      if (!name_iter_next(&it)) break;
+    }
+  }
+  // Graphe d'origine ou transposé : sommets directement par ids, puis triés
+  for (int r = lo; r < hi && nb >= 0; r++) {
+    t_vertex v = d->ids[r];
+    if (v >= g->size || g->name_off[v] != (size_t)r) nb = -1;
+    else if (out != NULL) out[nb++] = v;
+    else nb++;
+  }
+  if (nb >= 0) {
+    if (out != NULL) qsort(out, (size_t)nb, sizeof(*out), cmp_vertex);
+    return nb;
+  }
+  // Sous-graphe : rangs de ses sommets comparés à l'intervalle
+  nb = 0;
+  for (t_vertex v = 0; v < g->size; v++) {
+    size_t r = g->name_off[v];
+    if (r == NO_NAME || r < (size_t)lo || r >= (size_t)hi) continue;
+    if (out != NULL) out[nb] = v;
+    nb++;
+  }
+  return nb;
+}
+
 // Opérations sur les arêtes
 t_bool graph_has_edge(const t_graph * g, t_vertex from, t_vertex to) {
   assert(g != NULL);
   assert(from >= 0 && from < g->size);
   assert(to >= 0 && to < g->size);
-  if (g->use_matrix) {
+  STAT_ADD(dedup_checks, 1);
+  if (g->kind == GRAPH_MATRIX) {
+    STAT_ADD(dedup_probes, 1);
     return g->repr.m[from][to] ? 1 : 0;
+  } else if (g->kind == GRAPH_CSR) {
+    return csr_has_edge(g->repr.csr, from, to);
   } else {
     for (t_node * n = g->repr.adj[from]; n != NULL; n = n->p_next) {
+      STAT_ADD(dedup_probes, 1);
       if (n->val == to) return 1;
     }
     return 0;
   }
 }
 
-void graph_add_edge(t_graph * g, t_vertex from, t_vertex to) {
-  assert(g != NULL);
-  assert(from >= 0 && from < g->size);
-  assert(to >= 0 && to < g->size);
-  if (graph_has_edge(g, from, to)) return;
-  if (g->use_matrix) {
-    g->repr.m[from][to] = 1;
-  } else {
-    g->repr.adj[from] = list_add_head(to, g->repr.adj[from]);
+// Ajout, ou baisse du poids si l'arête existe ; pas de compactage du CSR
+// (fait par l'appelant : la construction concurrente le reporte)
+static void graph_put_edge(t_graph * g, t_vertex from, t_vertex to, float w) {
+  if (g->kind == GRAPH_MATRIX) {
+    STAT_ADD(dedup_probes, 1);
+    if (!g->repr.m[from][to]) {
+      g->repr.m[from][to] = 1;
+      if (w != 1.0f || matrix_weight(g, from, to) != 1.0f) matrix_weights(g, from)[to] = w;
+    } else if (w < matrix_weight(g, from, to)) {
+      matrix_weights(g, from)[to] = w;
+    }
+    return;
   }
-}
-
+  if (g->kind == GRAPH_CSR) {
+    int r = csr_put(g->repr.csr, g->size, from, to, w);
+    if (r > 0) g->repr.csr->nb_delta++;
+    if (r < 0) g->repr.csr->nb_dead--;
+    return;
+  }
+  for (t_node * n = g->repr.adj[from]; n != NULL; n = n->p_next) {
+    STAT_ADD(dedup_probes, 1);
+    if (n->val == to) {
+      if (w < n->w) n->w = w;
+      return;
+    }
+  }
+  g->repr.adj[from] = list_add_head(to, w, g->repr.adj[from]);
+}
+
+void graph_add_edge(t_graph * g, t_vertex from, t_vertex to) {
+  graph_add_weighted_edge(g, from, to, 1.0f);
+}
+
+void graph_add_weighted_edge(t_graph * g, t_vertex from, t_vertex to, float w) {
+  assert(g != NULL);
+  assert(from >= 0 && from < g->size);
+  assert(to >= 0 && to < g->size);
+  assert(w >= 0 && w <= FLT_MAX);
+  STAT_ADD(dedup_checks, 1);
+  graph_put_edge(g, from, to, w);
+  if (g->kind == GRAPH_CSR) csr_maybe_compact(g->repr.csr, g->size);
+}
+
+float graph_edge_weight(const t_graph * g, t_vertex from, t_vertex to) {
+  assert(g != NULL);
+  assert(from >= 0 && from < g->size);
+  assert(to >= 0 && to < g->size);
+  if (g->kind == GRAPH_MATRIX) {
+    return g->repr.m[from][to] ? matrix_weight(g, from, to) : -1.0f;
+  }
+  if (g->kind == GRAPH_CSR) {
+    const struct csr * c = g->repr.csr;
+    long long i = csr_find(c, from, to);
+    if (i >= 0) return csr_is_dead(c, i) ? -1.0f : csr_weight(c, i);
+    int j = csr_find_delta(c, from, to);
+    return j >= 0 ? delta_weight(&c->delta[from], j) : -1.0f;
+  }
+  for (const t_node * n = g->repr.adj[from]; n != NULL; n = n->p_next) {
+    if (n->val == to) return n->w;
+  }
+  return -1.0f;
+}
+
+t_bool graph_is_weighted(const t_graph * g) {
+  assert(g != NULL);
+  if (g->kind == GRAPH_MATRIX) return g->mw != NULL;
+  if (g->kind == GRAPH_CSR) {
+    const struct csr * c = g->repr.csr;
+    if (c->w != NULL) return 1;
+    for (int u = 0; u < g->size && c->delta != NULL; u++) {
+      if (c->delta[u].w != NULL) return 1;
+    }
+    return 0;
+  }
+  for (int u = 0; u < g->size; u++) {
+    for (const t_node * n = g->repr.adj[u]; n != NULL; n = n->p_next) {
+      if (n->w != 1.0f) return 1;
+    }
+  }
+  return 0;
+}
+
+t_bool graph_remove_edge(t_graph * g, t_vertex from, t_vertex to) {
+  assert(g != NULL);
+  assert(from >= 0 && from < g->size);
+  assert(to >= 0 && to < g->size);
+  if (g->kind == GRAPH_MATRIX) {
+    t_bool had = g->repr.m[from][to] ? 1 : 0;
+    g->repr.m[from][to] = 0;
+    return had;
+  }
+  if (g->kind == GRAPH_CSR) {
+    return csr_remove_edge(g->repr.csr, g->size, from, to);
+  }
+  for (t_list * p = &g->repr.adj[from]; *p != NULL; p = &(*p)->p_next) {
+    if ((*p)->val == to) {
+      t_node * n = *p;
+      *p = n->p_next;
+      free(n);
+      STAT_BYTES(-(long long)sizeof(t_node));
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void graph_compact(t_graph * g) {
+  assert(g != NULL);
+  if (g->kind == GRAPH_CSR) csr_compact(g->repr.csr, g->size);
+}
+
 // Parcours des successeurs
+void graph_for_each_succ_weighted(const t_graph * g, t_vertex u,
+                                  void (*f)(t_vertex v, float w, void * ctx), void * ctx) {
+  assert(g != NULL);
+  assert(f != NULL);
+  assert(u >= 0 && u < g->size);
+  if (g->kind == GRAPH_MATRIX) {
+    const float * row = g->mw != NULL ? g->mw[u] : NULL;
+    for (int v = 0; v < g->size; v++) {
+      if (g->repr.m[u][v]) f(v, row != NULL ? row[v] : 1.0f, ctx);
+    }
+  } else if (g->kind == GRAPH_CSR) {
+    const struct csr * c = g->repr.csr;
+    for (long long i = c->off[u]; i < c->off[u + 1]; i++) {
+      if (!csr_is_dead(c, i)) f(c->succ[i], csr_weight(c, i), ctx);
+    }
+    if (c->delta != NULL) {
+      for (int i = 0; i < c->delta[u].len; i++) f(c->delta[u].v[i], delta_weight(&c->delta[u], i), ctx);
+    }
+  } else {
+    for (t_node * n = g->repr.adj[u]; n != NULL; n = n->p_next) {
+      f(n->val, n->w, ctx);
+    }
+  }
+}
+
 void graph_for_each_succ(const t_graph * g, t_vertex u, void (*f)(t_vertex v, void * ctx), void * ctx) {
   assert(g != NULL);
   assert(f != NULL);
   assert(u >= 0 && u < g->size);
-  if (g->use_matrix) {
+  if (g->kind == GRAPH_MATRIX) {
     for (int v = 0; v < g->size; v++) {
       if (g->repr.m[u][v]) {
         f(v, ctx);
       }
     }
+  } else if (g->kind == GRAPH_CSR) {
+    const struct csr * c = g->repr.csr;
+    for (long long i = c->off[u]; i < c->off[u + 1]; i++) {
+      if (!csr_is_dead(c, i)) f(c->succ[i], ctx);
+    }
+    if (c->delta != NULL) {
+      for (int i = 0; i < c->delta[u].len; i++) f(c->delta[u].v[i], ctx);
+    }
   } else {
     for (t_node * n = g->repr.adj[u]; n != NULL; n = n->p_next) {
       f(n->val, ctx);
@@ -190,170 +1437,3554 @@ void graph_for_each_succ(const t_graph * g, t_vertex u, void (*f)(t_vertex v, vo
   }
 }
 
+// Curseur sur les successeurs (indépendant de la représentation) : node est le
+// maillon courant des listes, col la prochaine colonne de la matrice ou la
+// position dans le tampon d'insertion du CSR, i la prochaine case compactée
+typedef t_graph_cursor t_cursor;
+
+static void cursor_init(const t_graph * g, t_vertex u, t_cursor * c) {
+  c->node = g->kind == GRAPH_LIST ? g->repr.adj[u] : NULL;
+  c->col = 0;
+  c->i = g->kind == GRAPH_CSR ? g->repr.csr->off[u] : 0;
+}
+
+// Place dans *v le successeur suivant de u ; retourne 0 en fin de parcours
+static t_bool cursor_next(const t_graph * g, t_vertex u, t_cursor * c, t_vertex * v) {
+  if (g->kind == GRAPH_CSR) {
+    const struct csr * cs = g->repr.csr;
+    while (c->i < cs->off[u + 1]) {
+      long long i = c->i++;
+      if (!csr_is_dead(cs, i)) {
+        *v = cs->succ[i];
+        return 1;
+      }
+    }
+    if (cs->delta != NULL && c->col < cs->delta[u].len) {
+      *v = cs->delta[u].v[c->col++];
+      return 1;
+    }
+    return 0;
+  }
+  if (g->kind == GRAPH_MATRIX) {
+    const t_bool * row = g->repr.m[u];
+    while (c->col < g->size) {
+      int col = c->col++;
+      if (row[col]) {
+        *v = col;
+        return 1;
+      }
+    }
+    return 0;
+  }
+  const t_node * n = c->node;
+  if (n == NULL) return 0;
+  *v = n->val;
+  c->node = n->p_next;
+  return 1;
+}
+
+void graph_cursor_init(const t_graph * g, t_vertex u, t_graph_cursor * c) {
+  assert(g != NULL && c != NULL);
+  assert(u >= 0 && u < g->size);
+  cursor_init(g, u, c);
+}
+
+t_bool graph_cursor_next(const t_graph * g, t_vertex u, t_graph_cursor * c, t_vertex * v) {
+  return cursor_next(g, u, c, v);
+}
+
+// Partage des noms de src avec dst : dst[v] porte le nom de src[map[v]]
+// (map NULL : mêmes numéros). Seul le tableau des positions est alloué.
+static void graph_share_names(t_graph * dst, const t_graph * src, const t_vertex * map) {
+  if (!graph_has_names(src)) return;
+  assert(!graph_has_names(dst));
+  if (src->pool != NULL) dst->pool = name_pool_retain(src->pool);
+  else {
+    dst->dict = src->dict;
+    REF_RETAIN(dst->dict->refs);
+  }
+  dst->name_off = malloc((size_t)dst->size * sizeof(*(dst->name_off)));
+  assert(dst->name_off != NULL);
+  STAT_BYTES((size_t)dst->size * sizeof(*(dst->name_off)));
+  if (map == NULL) {
+    memcpy(dst->name_off, src->name_off, (size_t)dst->size * sizeof(*(dst->name_off)));
+  } else {
+    for (int i = 0; i < dst->size; i++) {
+      dst->name_off[i] = src->name_off[map[i]];
+    }
+  }
+}
+
 // Graphe transposé
 struct reverse_ctx {
   t_graph * rev;
   t_vertex from;
 };
 
-static void graph_reverse_cb(t_vertex v, void * ctx) {
+static void graph_reverse_cb(t_vertex v, float w, void * ctx) {
   struct reverse_ctx * c = ctx;
-  graph_add_edge(c->rev, v, c->from);
+  graph_add_weighted_edge(c->rev, v, c->from, w);
 }
 
-t_graph * graph_reverse(const t_graph * g) {
-  assert(g != NULL);
-  t_bool has_names = g->names != NULL;
-  t_graph * rev = graph_new(g->size, has_names, g->use_matrix);
-  if (has_names) {
-    for (int i = 0; i < g->size; i++) {
-      rev->names[i] = g->names[i] ? str_dup(g->names[i]) : NULL;
+struct csr_reverse_ctx {
+  struct csr * rc;
+  long long * off;
+  t_vertex from;
+};
+
+static void csr_reverse_cb(t_vertex v, float w, void * ctx) {
+  struct csr_reverse_ctx * c = ctx;
+  long long i = c->off[v]++;
+  c->rc->succ[i] = c->from;
+  c->rc->w[i] = w;
+}
+
+// Transposé d'un CSR, compacté directement : tri par comptage sur la
+// destination ; les origines étant parcourues dans l'ordre, chaque ligne sort triée
+static void csr_reverse(const t_graph * g, struct csr * rc) {
+  int n = g->size;
+  long long * off = rc->off;
+  t_cursor c;
+  t_vertex v;
+  for (t_vertex u = 0; u < n; u++) {
+    cursor_init(g, u, &c);
+    while (cursor_next(g, u, &c, &v)) off[v + 1]++;
+  }
+  for (int i = 0; i < n; i++) off[i + 1] += off[i];
+  rc->succ = malloc((size_t)(off[n] > 0 ? off[n] : 1) * sizeof(t_vertex));
+  assert(rc->succ != NULL);
+  STAT_BYTES((size_t)off[n] * sizeof(t_vertex));
+  if (graph_is_weighted(g)) {
+    // Poids recopiés avec les arêtes, par le parcours pondéré
+    rc->w = malloc((size_t)(off[n] > 0 ? off[n] : 1) * sizeof(float));
+    assert(rc->w != NULL);
+    STAT_BYTES((size_t)off[n] * sizeof(float));
+    struct csr_reverse_ctx ctx = { rc, off, 0 };
+    for (t_vertex u = 0; u < n; u++) {
+      ctx.from = u;
+      graph_for_each_succ_weighted(g, u, csr_reverse_cb, &ctx);
+    }
+  } else {
+    for (t_vertex u = 0; u < n; u++) {
+      cursor_init(g, u, &c);
+      while (cursor_next(g, u, &c, &v)) rc->succ[off[v]++] = u;
     }
   }
+  for (int i = n; i > 0; i--) off[i] = off[i - 1];
+  off[0] = 0;
+}
 
-  for (int u = 0; u < g->size; u++) {
-    struct reverse_ctx ctx = { rev, u };
-    graph_for_each_succ(g, u, graph_reverse_cb, &ctx);
+t_graph * graph_reverse(const t_graph * g) {
+  assert(g != NULL);
+  STAT_PHASE_BEGIN(GRAPH_PHASE_REVERSE);
+  t_graph * rev = graph_new(g->size, 0, g->kind);
+  assert(rev != NULL);
+  graph_share_names(rev, g, NULL);
+
+  if (g->kind == GRAPH_CSR) {
+    csr_reverse(g, rev->repr.csr);
+  } else {
+    for (int u = 0; u < g->size; u++) {
+      struct reverse_ctx ctx = { rev, u };
+      graph_for_each_succ_weighted(g, u, graph_reverse_cb, &ctx);
+    }
   }
 
+  STAT_PHASE_END(GRAPH_PHASE_REVERSE);
   return rev;
 }
 
-// Affichage façon liste d'adjacence
-struct show_ctx {
-  const t_graph * g;
-};
-
-static void graph_show_cb(t_vertex v, void * ctx) {
-  const struct show_ctx * c = ctx;
-  const char * name = graph_vertex_name(c->g, v);
-  if (name) {
-    printf(" %s", name);
-  } else {
-    printf(" %d", v);
+// Nombre de successeurs de u ; sans suppression en attente, un CSR le donne
+// sans parcourir la ligne
+static int succ_count(const t_graph * g, t_vertex u) {
+  if (g->kind == GRAPH_CSR && g->repr.csr->nb_dead == 0) {
+    const struct csr * c = g->repr.csr;
+    return (int)(c->off[u + 1] - c->off[u]) + (c->delta != NULL ? c->delta[u].len : 0);
   }
+  int k = 0;
+  t_cursor c;
+  t_vertex v;
+  cursor_init(g, u, &c);
+  while (cursor_next(g, u, &c, &v)) k++;
+  return k;
 }
 
-void graph_show(const t_graph * g) {
-  assert(g != NULL);
-  for (int i = 0; i < g->size; i++) {
-    const char * name = graph_vertex_name(g, i);
-    if (name) {
-      printf("%s:", name);
-    } else {
-      printf("%d:", i);
+// Élagage des CFC triviales. Un sommet sans arc entrant (ou sortant) venant d'un
+// sommet encore présent forme une CFC à lui seul : on le retire et on décrémente
+// les degrés de ses voisins, qui peuvent être retirés à leur tour (liste de travail).
+// Une source n'est retirée qu'après tous ses prédécesseurs et un puits qu'après
+// tous ses successeurs : numéroter les sources dans l'ordre de retrait et les puits
+// dans l'ordre inverse, les CFC du cœur entre les deux, garde l'ordre topologique.
+t_trim graph_trim(const t_graph * g, const t_graph * rev, int * comp, t_vertex * core) {
+  assert(g != NULL && rev != NULL && comp != NULL && core != NULL);
+  assert(rev->size == g->size);
+  int n = g->size;
+  int * in = calloc((size_t)n, sizeof(*in));
+  int * out = calloc((size_t)n, sizeof(*out));
+  assert(n == 0 || (in != NULL && out != NULL));
+  t_trim t = { 0, 0, 0 };
+
+  for (t_vertex u = 0; u < n; u++) {
+    out[u] = succ_count(g, u);
+    in[u] = succ_count(rev, u);
+  }
+
+  // comp : -1 présent, >= 0 rang de retrait d'une source, <= -2 rang d'un puits ;
+  // core sert de file des sommets retirés en attendant la liste du cœur.
+  // Les sources d'abord : un puits n'a ensuite plus que des prédécesseurs présents
+  // à prévenir, et aucun s'il n'en reste pas (in[x] == 0).
+  int head = 0, tail = 0;
+  for (t_vertex v = 0; v < n; v++) {
+    comp[v] = -1;
+    if (in[v] == 0) {
+      comp[v] = t.nb_sources++;
+      core[tail++] = v;
     }
-    struct show_ctx ctx = { g };
-    graph_for_each_succ(g, i, graph_show_cb, &ctx);
-    printf("\n");
   }
+  while (head < tail) {
+    t_vertex x = core[head++];
+    t_cursor c;
+    t_vertex v;
+    cursor_init(g, x, &c);
+    while (cursor_next(g, x, &c, &v)) {
+      if (--in[v] == 0) {
+        comp[v] = t.nb_sources++;
+        core[tail++] = v;
+      }
+    }
+  }
+  for (t_vertex v = 0; v < n; v++) {
+    if (comp[v] == -1 && out[v] == 0) {
+      comp[v] = -2 - t.nb_sinks++;
+      core[tail++] = v;
+    }
+  }
+  while (head < tail) {
+    t_vertex x = core[head++];
+    if (in[x] == 0) continue;
+    t_cursor c;
+    t_vertex v;
+    cursor_init(rev, x, &c);
+    while (cursor_next(rev, x, &c, &v)) {
+      if (--out[v] == 0 && comp[v] == -1) {
+        comp[v] = -2 - t.nb_sinks++;
+        core[tail++] = v;
+      }
+    }
+  }
+
+  for (t_vertex v = 0; v < n; v++) {
+    if (comp[v] == -1) core[t.nb_core++] = v;
+    else if (comp[v] <= -2) comp[v] = t.nb_sources + t.nb_sinks - 1 - (-2 - comp[v]);
+  }
+  free(out);
+  free(in);
+  return t;
 }
 
-// Lecture format 1 (numéros)
-t_graph * graph_read_format1_file(FILE * in, t_bool use_matrix) {
-  if (in == NULL) return NULL;
-  char buf[MAX_READ_LINE];
-  if (!read_line_skip_empty(in, buf, sizeof(buf))) {
-    return NULL;
+int graph_trim_merge(const t_trim * t, int * comp, int n, const t_vertex * core,
+                     const int * core_comp, int nb_core_scc) {
+  assert(t != NULL && comp != NULL && (t->nb_core == 0 || (core != NULL && core_comp != NULL)));
+  for (int v = 0; v < n; v++) {
+    if (comp[v] >= t->nb_sources) comp[v] += nb_core_scc;
   }
+  for (int i = 0; i < t->nb_core; i++) comp[core[i]] = t->nb_sources + core_comp[i];
+  return t->nb_sources + nb_core_scc + t->nb_sinks;
+}
 
-  int size = 0;
-  if (sscanf(buf, "%d", &size) != 1 || size <= 0) {
-    fprintf(stderr, "Format 1 : échec de lecture du nombre de sommets\n");
-    return NULL;
+// Composantes fortement connexes : élagage des CFC triviales, puis Kosaraju
+// (parcours itératifs) sur le cœur restant seulement.
+// Les deux parcours utilisent une pile explicite de curseurs : pas de récursion,
+// donc pas de débordement de la pile C sur les longues chaînes.
+int graph_scc(const t_graph * g, int * comp) {
+  assert(g != NULL);
+  assert(comp != NULL);
+  int n = g->size;
+  t_graph * rev = graph_reverse(g);
+  t_vertex * core = malloc((size_t)n * sizeof(*core));
+  assert(n == 0 || core != NULL);
+  t_trim t = graph_trim(g, rev, comp, core);
+  if (t.nb_core == 0) {
+    free(core);
+    graph_free(rev);
+    return t.nb_sources + t.nb_sinks;
   }
 
-  t_graph * g = graph_new(size, 0, use_matrix);
+  int m = t.nb_core;
+  t_vertex * order = malloc((size_t)m * sizeof(*order));
+  t_vertex * stack = malloc((size_t)m * sizeof(*stack));
+  t_cursor * cursors = malloc((size_t)m * sizeof(*cursors));
+  assert(order != NULL && stack != NULL && cursors != NULL);
 
-  while (read_line_skip_empty(in, buf, sizeof(buf))) {
-    int from, to;
-    if (sscanf(buf, "%d %d", &from, &to) == 2) {
-      if (from >= 0 && from < size && to >= 0 && to < size) {
-        graph_add_edge(g, from, to);
+  // 1er parcours : ordre de fin de traitement. Sur le cœur, comp vaut -1 (non vu),
+  // puis -2 (vu au 1er parcours), puis -3 - c (CFC c du cœur) ; les sommets
+  // élagués (comp >= 0) ne sont jamais suivis.
+  int nb_done = 0;
+  for (int k = 0; k < m; k++) {
+    t_vertex s = core[k];
+    if (comp[s] != -1) continue;
+    int top = 0;
+    comp[s] = -2;
+    stack[0] = s;
+    cursor_init(g, s, &cursors[0]);
+    while (top >= 0) {
+      t_vertex v;
+      if (cursor_next(g, stack[top], &cursors[top], &v)) {
+        if (comp[v] == -1) {
+          comp[v] = -2;
+          top++;
+          stack[top] = v;
+          cursor_init(g, v, &cursors[top]);
+        }
       } else {
-        fprintf(stderr, "Format 1 : arête hors limites ignorée \"%s\"\n", buf);
+        order[nb_done++] = stack[top--];
       }
-    } else {
-      fprintf(stderr, "Format 1 : ligne ignorée car illisible \"%s\"\n", buf);
     }
   }
 
-  return g;
-}
+  // 2nd parcours sur le transposé, par ordre de fin décroissant
+  int nb_scc = 0;
+  for (int i = m - 1; i >= 0; i--) {
+    t_vertex s = order[i];
+    if (comp[s] != -2) continue;
+    int top = 0;
+    comp[s] = -3 - nb_scc;
+    stack[0] = s;
+    while (top >= 0) {
+      t_vertex x = stack[top--];
+      t_cursor c;
+      t_vertex v;
+      cursor_init(rev, x, &c);
+      while (cursor_next(rev, x, &c, &v)) {
+        if (comp[v] == -2) {
+          comp[v] = -3 - nb_scc;
+          stack[++top] = v;
+        }
+      }
+    }
+    nb_scc++;
+  }
 
-// Lecture format 2 (noms)
-t_graph * graph_read_format2_file(FILE * in, t_bool use_matrix) {
-  if (in == NULL) return NULL;
-  char buf[MAX_READ_LINE];
-  if (!read_line_skip_empty(in, buf, sizeof(buf))) {
-    return NULL;
+  // Numérotation finale (voir graph_trim_merge) : sources, cœur, puits
+  for (int v = 0; v < n; v++) {
+    if (comp[v] >= t.nb_sources) comp[v] += nb_scc;
+    else if (comp[v] < 0) comp[v] = t.nb_sources + (-3 - comp[v]);
   }
 
-  int size = 0;
-  char tag = '\0';
-  int read = sscanf(buf, "%d %c", &size, &tag);
-  if (read < 1 || size <= 0) {
-    fprintf(stderr, "Format 2 : échec de lecture du nombre de sommets\n");
-    return NULL;
+  graph_free(rev);
+  free(cursors);
+  free(stack);
+  free(order);
+  free(core);
+  return t.nb_sources + nb_scc + t.nb_sinks;
+}
+
+#ifndef GRAPH_NO_THREADS
+// Attente active courte puis on cède le processeur
+static void spin_pause(unsigned * spins) {
+  if (++*spins < 64) {
+#ifdef GRAPH_X86_SIMD
+    _mm_pause();
+#endif
+  } else {
+    sched_yield();
   }
-  if (read == 2 && tag != 'n') {
-    fprintf(stderr, "Format 2 : le second champ doit être 'n', lu '%c'\n", tag);
-    return NULL;
+}
+#endif
+
+// Composantes faiblement connexes : union-find sans verrou. Chaque fil prend
+// des tranches de WCC_CHUNK sommets et réunit les extrémités de leurs arcs. Une
+// union accroche la racine de plus grand numéro sous l'autre par compare-and-swap,
+// donc parent[x] <= x et la racine finale d'une composante est son plus petit
+// sommet, quel que soit l'ordre des unions entre fils. find raccourcit le chemin
+// par sauts de deux (path halving), aussi par compare-and-swap : un échec signifie
+// seulement qu'un autre fil l'a déjà raccourci. Chaque case ne fait que décroître,
+// l'ordre relâché suffit ; la fin des fils (pthread_join) publie le résultat.
+#define WCC_CHUNK 4096
+
+#ifndef GRAPH_NO_THREADS
+typedef atomic_int t_uf_cell;
+#define UF_LOAD(c) atomic_load_explicit(&(c), memory_order_relaxed)
+#define UF_CAS(c, expected, desired)                                                  \
+  atomic_compare_exchange_weak_explicit(&(c), &(expected), (desired), memory_order_relaxed, \
+                                        memory_order_relaxed)
+#else
+typedef int t_uf_cell;
+#define UF_LOAD(c) (c)
+#define UF_CAS(c, expected, desired) uf_cas(&(c), &(expected), (desired))
+
+static t_bool uf_cas(int * c, int * expected, int desired) {
+  if (*c != *expected) {
+    *expected = *c;
+    return 0;
   }
+  *c = desired;
+  return 1;
+}
+#endif
 
-  t_graph * g = graph_new(size, 1, use_matrix);
+static int uf_find(t_uf_cell * parent, int x) {
+  for (;;) {
+    int p = UF_LOAD(parent[x]);
+    if (p == x) return x;
+    int gp = UF_LOAD(parent[p]);
+    if (gp == p) return p;
+    (void)UF_CAS(parent[x], p, gp);
+    x = gp;
+  }
+}
 
-  // Lecture des noms de sommets
-  for (int i = 0; i < size; i++) {
-    if (!read_line_skip_empty(in, buf, sizeof(buf))) {
-      fprintf(stderr, "Format 2 : pas assez de noms de sommets, %d/%d lus\n", i, size);
-      graph_free(g);
-      return NULL;
+static void uf_union(t_uf_cell * parent, int a, int b) {
+  for (;;) {
+    a = uf_find(parent, a);
+    b = uf_find(parent, b);
+    if (a == b) return;
+    if (a < b) {
+      int t = a;
+      a = b;
+      b = t;
     }
-    g->names[i] = str_dup(buf);
+    int expected = a;
+    if (UF_CAS(parent[a], expected, b)) return;
   }
+}
 
-  // Lecture des arêtes (on suppose des noms sans espace, séparés par des blancs)
-  while (read_line_skip_empty(in, buf, sizeof(buf))) {
-    char name_from[MAX_READ_LINE], name_to[MAX_READ_LINE];
-    if (sscanf(buf, "%s %s", name_from, name_to) == 2) {
-      t_vertex from = graph_vertex_from_name(g, name_from);
-      t_vertex to = graph_vertex_from_name(g, name_to);
-      if (from >= 0 && to >= 0) {
-        graph_add_edge(g, from, to);
-      } else {
-        fprintf(stderr, "Format 2 : arête ignorée, sommets inconnus \"%s\"\n", buf);
+struct wcc_job {
+  const t_graph * g;
+  t_uf_cell * parent;
+#ifndef GRAPH_NO_THREADS
+  atomic_int next;
+#else
+  int next;
+#endif
+};
+
+static void * wcc_worker(void * arg) {
+  struct wcc_job * job = arg;
+  int n = job->g->size;
+  for (;;) {
+#ifndef GRAPH_NO_THREADS
+    int first = atomic_fetch_add(&job->next, WCC_CHUNK);
+#else
+    int first = job->next;
+    job->next += WCC_CHUNK;
+#endif
+    if (first >= n) break;
+    int last = n - first > WCC_CHUNK ? first + WCC_CHUNK : n;
+    for (t_vertex u = first; u < last; u++) {
+      t_cursor c;
+      t_vertex v;
+      cursor_init(job->g, u, &c);
+      while (cursor_next(job->g, u, &c, &v)) {
+        if (v != u) uf_union(job->parent, u, v);
       }
-    } else {
-      fprintf(stderr, "Format 2 : ligne ignorée car illisible \"%s\"\n", buf);
     }
   }
+  return NULL;
+}
 
-  return g;
+int graph_wcc(const t_graph * g, int * comp, int * sizes, int nb_threads) {
+  assert(g != NULL && comp != NULL);
+  int n = g->size;
+  struct wcc_job job;
+  job.g = g;
+  job.parent = malloc((size_t)(n > 0 ? n : 1) * sizeof(*job.parent));
+  assert(job.parent != NULL);
+  for (int v = 0; v < n; v++) {
+#ifndef GRAPH_NO_THREADS
+    atomic_init(&job.parent[v], v);
+#else
+    job.parent[v] = v;
+#endif
+  }
+
+#ifndef GRAPH_NO_THREADS
+  atomic_init(&job.next, 0);
+  int nb_chunks = (n + WCC_CHUNK - 1) / WCC_CHUNK;
+  if (nb_threads <= 0) nb_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nb_threads > nb_chunks) nb_threads = nb_chunks;
+  pthread_t * workers = malloc((size_t)(nb_threads > 1 ? nb_threads : 1) * sizeof(*workers));
+  assert(workers != NULL);
+  int started = 0;
+  while (started + 1 < nb_threads
+         && pthread_create(&workers[started], NULL, wcc_worker, &job) == 0) {
+    started++;
+  }
+  wcc_worker(&job); // le fil appelant travaille aussi
+  for (int t = 0; t < started; t++) pthread_join(workers[t], NULL);
+  free(workers);
+#else
+  (void)nb_threads;
+  job.next = 0;
+  wcc_worker(&job);
+#endif
+
+  // Racine = plus petit sommet : numéros dans l'ordre du plus petit sommet,
+  // attribués en un seul passage croissant
+  int nb = 0;
+  for (t_vertex v = 0; v < n; v++) {
+    int r = uf_find(job.parent, v);
+    comp[v] = r == v ? nb++ : comp[r];
+    if (sizes != NULL) {
+      if (r == v) sizes[comp[v]] = 0;
+      sizes[comp[v]]++;
+    }
+  }
+  free(job.parent);
+  return nb;
 }
 
-// Enveloppe avec nom de fichier
-static t_graph * graph_read_with_file(const char * filename, t_bool use_matrix,
-                                      t_graph * (*reader)(FILE *, t_bool)) {
-  t_graph * g = NULL;
-  if (filename == NULL || strcmp(filename, "-") == 0) {
-    g = reader(stdin, use_matrix);
-  } else {
-    FILE * f = fopen(filename, "r");
-    if (f == NULL) {
-      fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", filename);
-      return NULL;
+// PageRank par tirage : le nouveau rang de v est la somme des contributions
+// rank[u] / deg+(u) de ses prédécesseurs, lus comme successeurs de v dans le
+// transposé. Chaque case n'est écrite que par le fil qui possède v : ni verrou ni
+// atomique sur les rangs. La masse des sommets sans successeur est répartie sur
+// tous les sommets, avec le saut aléatoire (1 - damping).
+// Les sommets sont découpés en tranches contiguës de travail égal (arcs entrants
+// + 1) ; le fil t prend les tranches t, t + nb, t + 2 nb... Rangs et contributions
+// sont en double tampon : une itération lit ceux de la précédente et écrit les
+// suivants, avec une seule barrière par itération. Chaque fil y dépose sa part de
+// l'écart (norme 1) et de la masse pendante ; après la barrière, tous font la même
+// somme des parts dans le même ordre et prennent donc la même décision d'arrêt.
+#define PR_MIN_WORK 65536 // travail minimal (sommets + arcs) par fil
+
+struct pr_part {
+  _Alignas(64) double diff; // somme des |écarts| sur les tranches du fil
+  double dangling;          // somme des rangs de ses sommets sans successeur
+};
+
+struct pr_job {
+  const t_graph * rev;
+  const struct csr * flat;  // rev en CSR sans suppression ni ajout, sinon NULL
+  const int * outdeg;
+  const t_vertex * bounds;  // tranche r : [bounds[r], bounds[r + 1])
+  int nb_ranges;
+  double * rank[2];
+  double * contrib[2];      // rank[u] / outdeg[u], 0 sans successeur
+  struct pr_part * part[2]; // une part par fil, une paire par parité d'itération
+  double damping;
+  double tolerance;
+  int max_iter;
+  int iters;                // résultat, écrit par le fil 0
+  int cur;                  // tampon du résultat
+  double delta;             // écart de la dernière itération
+#ifndef GRAPH_NO_THREADS
+  atomic_int nb_threads;    // fixé par le fil appelant avant sa première barrière
+  atomic_int arrived;
+  atomic_int phase;
+#else
+  int nb_threads;
+#endif
+};
+
+struct pr_arg {
+  struct pr_job * job;
+  int t;
+};
+
+// Barrière à attente active : le dernier arrivé remet le compteur à zéro et
+// change de phase ; la phase publie (release / acquire) les écritures d'avant
+static void pr_barrier(struct pr_job * job) {
+#ifndef GRAPH_NO_THREADS
+  int phase = atomic_load_explicit(&job->phase, memory_order_acquire);
+  if (atomic_fetch_add_explicit(&job->arrived, 1, memory_order_acq_rel) + 1
+      == atomic_load_explicit(&job->nb_threads, memory_order_acquire)) {
+    atomic_store_explicit(&job->arrived, 0, memory_order_relaxed);
+    atomic_store_explicit(&job->phase, phase + 1, memory_order_release);
+    return;
+  }
+  unsigned spins = 0;
+  while (atomic_load_explicit(&job->phase, memory_order_acquire) == phase) spin_pause(&spins);
+#else
+  (void)job;
+#endif
+}
+
+static double pr_pull(const struct pr_job * job, const double * contrib, t_vertex v) {
+  double s = 0;
+  if (job->flat != NULL) {
+    const struct csr * cs = job->flat;
+    for (long long i = cs->off[v]; i < cs->off[v + 1]; i++) s += contrib[cs->succ[i]];
+    return s;
+  }
+  t_cursor c;
+  t_vertex u;
+  cursor_init(job->rev, v, &c);
+  while (cursor_next(job->rev, v, &c, &u)) s += contrib[u];
+  return s;
+}
+
+static void * pr_worker(void * arg) {
+  const struct pr_arg * a = arg;
+  struct pr_job * job = a->job;
+  int t = a->t;
+  double inv_n = 1.0 / job->rev->size;
+  double d = job->damping;
+
+  pr_barrier(job); // nombre de fils définitif
+#ifndef GRAPH_NO_THREADS
+  int nb = atomic_load_explicit(&job->nb_threads, memory_order_relaxed);
+#else
+  int nb = job->nb_threads;
+#endif
+
+  double dangling = 0;
+  for (int r = t; r < job->nb_ranges; r += nb) {
+    for (t_vertex v = job->bounds[r]; v < job->bounds[r + 1]; v++) {
+      job->rank[0][v] = inv_n;
+      if (job->outdeg[v] > 0) job->contrib[0][v] = inv_n / job->outdeg[v];
+      else {
+        job->contrib[0][v] = 0;
+        dangling += inv_n;
+      }
     }
-    g = reader(f, use_matrix);
-    fclose(f);
   }
-  return g;
+  job->part[0][t].dangling = dangling;
+  pr_barrier(job);
+
+  int cur = 0;
+  for (int it = 1;; it++) {
+    dangling = 0;
+    for (int s = 0; s < nb; s++) dangling += job->part[cur][s].dangling;
+    double base = (1 - d) * inv_n + d * dangling * inv_n;
+    const double * old = job->rank[cur];
+    const double * in = job->contrib[cur];
+    double * rank = job->rank[1 - cur];
+    double * contrib = job->contrib[1 - cur];
+    double diff = 0;
+    dangling = 0;
+    for (int r = t; r < job->nb_ranges; r += nb) {
+      for (t_vertex v = job->bounds[r]; v < job->bounds[r + 1]; v++) {
+        double x = base + d * pr_pull(job, in, v);
+        diff += x > old[v] ? x - old[v] : old[v] - x;
+        rank[v] = x;
+        if (job->outdeg[v] > 0) contrib[v] = x / job->outdeg[v];
+        else {
+          contrib[v] = 0;
+          dangling += x;
+        }
+      }
+    }
+    job->part[1 - cur][t].diff = diff;
+    job->part[1 - cur][t].dangling = dangling;
+    pr_barrier(job);
+    cur = 1 - cur;
+
+    double delta = 0;
+    for (int s = 0; s < nb; s++) delta += job->part[cur][s].diff;
+    if (delta < job->tolerance || it == job->max_iter) {
+      if (t == 0) {
+        job->iters = delta < job->tolerance ? it : -1;
+        job->cur = cur;
+        job->delta = delta;
+      }
+      break;
+    }
+  }
+  return NULL;
 }
 
-t_graph * graph_read_format1(const char * filename, t_bool use_matrix) {
-  return graph_read_with_file(filename, use_matrix, graph_read_format1_file);
+int graph_pagerank(const t_graph * g, const t_graph * rev, double damping, double tolerance,
+                   int max_iter, int nb_threads, double * rank) {
+  assert(g != NULL && rank != NULL);
+  assert(damping >= 0 && damping <= 1 && max_iter > 0);
+  int n = g->size;
+  if (n == 0) return 0;
+  t_graph * own = NULL;
+  if (rev == NULL) rev = own = graph_reverse(g);
+  assert(rev->size == n);
+
+  struct pr_job job;
+  job.rev = rev;
+  job.flat = rev->kind == GRAPH_CSR && rev->repr.csr->nb_dead == 0 && rev->repr.csr->delta == NULL
+             ? rev->repr.csr : NULL;
+  job.damping = damping;
+  job.tolerance = tolerance;
+  job.max_iter = max_iter;
+  int * outdeg = malloc((size_t)n * sizeof(*outdeg));
+  double * second = malloc((size_t)n * sizeof(*second));
+  double * contrib = malloc(2 * (size_t)n * sizeof(*contrib));
+  assert(outdeg != NULL && second != NULL && contrib != NULL);
+  long long total = n;
+  for (t_vertex u = 0; u < n; u++) {
+    outdeg[u] = succ_count(g, u);
+    total += outdeg[u];
+  }
+  job.outdeg = outdeg;
+  job.rank[0] = rank;
+  job.rank[1] = second;
+  job.contrib[0] = contrib;
+  job.contrib[1] = contrib + n;
+
+#ifndef GRAPH_NO_THREADS
+  if (nb_threads <= 0) nb_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nb_threads > total / PR_MIN_WORK) nb_threads = (int)(total / PR_MIN_WORK);
+  if (nb_threads < 1) nb_threads = 1;
+#else
+  nb_threads = 1;
+#endif
+
+  // Tranches de travail égal : la tranche r finit dès que le travail cumulé
+  // atteint (r + 1) / nb_threads du total
+  t_vertex * bounds = malloc(((size_t)nb_threads + 1) * sizeof(*bounds));
+  struct pr_part * parts = malloc(2 * (size_t)nb_threads * sizeof(*parts));
+  struct pr_arg * args = malloc((size_t)nb_threads * sizeof(*args));
+  assert(bounds != NULL && parts != NULL && args != NULL);
+  bounds[0] = 0;
+  int r = 1;
+  long long acc = 0;
+  for (t_vertex v = 0; v < n && r < nb_threads; v++) {
+    acc += succ_count(rev, v) + 1;
+    while (r < nb_threads && acc * nb_threads >= total * r) bounds[r++] = v + 1;
+  }
+  while (r < nb_threads) bounds[r++] = n;
+  bounds[nb_threads] = n;
+  job.bounds = bounds;
+  job.nb_ranges = nb_threads;
+  job.part[0] = parts;
+  job.part[1] = parts + nb_threads;
+  for (int t = 0; t < nb_threads; t++) {
+    args[t].job = &job;
+    args[t].t = t;
+  }
+
+#ifndef GRAPH_NO_THREADS
+  atomic_init(&job.nb_threads, nb_threads);
+  atomic_init(&job.arrived, 0);
+  atomic_init(&job.phase, 0);
+  pthread_t * workers = malloc((size_t)nb_threads * sizeof(*workers));
+  assert(workers != NULL);
+  int started = 0;
+  while (started + 1 < nb_threads
+         && pthread_create(&workers[started], NULL, pr_worker, &args[started + 1]) == 0) {
+    started++;
+  }
+  // Fils manquants : les autres se partagent toutes les tranches
+  atomic_store_explicit(&job.nb_threads, started + 1, memory_order_release);
+  pr_worker(&args[0]); // le fil appelant travaille aussi
+  for (int t = 0; t < started; t++) pthread_join(workers[t], NULL);
+  free(workers);
+#else
+  job.nb_threads = 1;
+  pr_worker(&args[0]);
+#endif
+
+  if (job.cur != 0) memcpy(rank, second, (size_t)n * sizeof(*rank));
+  free(args);
+  free(parts);
+  free(bounds);
+  free(contrib);
+  free(second);
+  free(outdeg);
+  if (own != NULL) graph_free(own);
+  return job.iters;
+}
+
+// Les k plus grands scores, par tas minimum de k cases : O(n log k). À score
+// égal, le plus petit numéro passe devant.
+static t_bool top_before(const double * score, t_vertex a, t_vertex b) {
+  return score[a] > score[b] || (score[a] == score[b] && a < b);
+}
+
+static void top_sift_down(const double * score, t_vertex * heap, int k, int i) {
+  for (;;) {
+    int m = i, l = 2 * i + 1;
+    if (l < k && top_before(score, heap[m], heap[l])) m = l;
+    if (l + 1 < k && top_before(score, heap[m], heap[l + 1])) m = l + 1;
+    if (m == i) return;
+    t_vertex x = heap[i];
+    heap[i] = heap[m];
+    heap[m] = x;
+    i = m;
+  }
 }
 
-t_graph * graph_read_format2(const char * filename, t_bool use_matrix) {
-  return graph_read_with_file(filename, use_matrix, graph_read_format2_file);
+int graph_top_k(const double * score, int n, int k, t_vertex * out) {
+  assert(score != NULL && out != NULL);
+  if (k > n) k = n;
+  if (k <= 0) return 0;
+  // Tas : la racine est la moins bonne des k retenues
+  for (t_vertex v = 0; v < k; v++) out[v] = v;
+  for (int i = k / 2 - 1; i >= 0; i--) top_sift_down(score, out, k, i);
+  for (t_vertex v = k; v < n; v++) {
+    if (top_before(score, v, out[0])) {
+      out[0] = v;
+      top_sift_down(score, out, k, 0);
+    }
+  }
+  // Tri en place : on sort la moins bonne et on la range à la fin
+  for (int m = k - 1; m > 0; m--) {
+    t_vertex x = out[0];
+    out[0] = out[m];
+    out[m] = x;
+    top_sift_down(score, out, m, 0);
+  }
+  return k;
+}
+
+// Tri topologique (Kahn) : order sert de file, les sommets y entrent quand leur
+// dernier prédécesseur en sort. S'il reste des sommets, chacun a encore un
+// prédécesseur restant : in[v] reçoit l'un d'eux (codé -1 - u, 0 marquant les
+// sommets triés), et en remontant ces prédécesseurs depuis n'importe quel sommet
+// restant on entre dans un circuit en au plus n pas.
+t_bool graph_toposort(const t_graph * g, t_vertex * order, int * len) {
+  assert(g != NULL && order != NULL && len != NULL);
+  int n = g->size;
+  int * in = calloc((size_t)(n > 0 ? n : 1), sizeof(*in));
+  assert(in != NULL);
+  t_cursor c;
+  t_vertex v;
+  for (t_vertex u = 0; u < n; u++) {
+    cursor_init(g, u, &c);
+    while (cursor_next(g, u, &c, &v)) in[v]++;
+  }
+
+  int tail = 0;
+  for (t_vertex u = 0; u < n; u++) {
+    if (in[u] == 0) order[tail++] = u;
+  }
+  for (int head = 0; head < tail; head++) {
+    t_vertex u = order[head];
+    cursor_init(g, u, &c);
+    while (cursor_next(g, u, &c, &v)) {
+      if (--in[v] == 0) order[tail++] = v;
+    }
+  }
+  if (tail == n) {
+    free(in);
+    *len = n;
+    return 1;
+  }
+
+  t_vertex x = -1;
+  for (t_vertex u = 0; u < n; u++) {
+    if (in[u] == 0) continue;
+    x = u;
+    cursor_init(g, u, &c);
+    while (cursor_next(g, u, &c, &v)) {
+      if (in[v] != 0) in[v] = -1 - u;
+    }
+  }
+  for (int i = 0; i < n; i++) x = -1 - in[x];
+  // x est sur le circuit ; on le parcourt à rebours, puis on le remet à l'endroit
+  int k = 0;
+  t_vertex y = x;
+  do {
+    order[k++] = y;
+    y = -1 - in[y];
+  } while (y != x);
+  for (int i = 0, j = k - 1; i < j; i++, j--) {
+    t_vertex t = order[i];
+    order[i] = order[j];
+    order[j] = t;
+  }
+  free(in);
+  *len = k;
+  return 0;
+}
+
+// Fermeture transitive
+// Calcul sur le graphe des CFC : graph_scc numérote les CFC dans un ordre
+// topologique, on les traite donc de la dernière à la première en faisant
+// l'union (OU bit à bit, par mots de 64 bits) des lignes de leurs successeurs.
+// Une seule ligne de bits par CFC : u atteint v si la ligne de comp[u]
+// contient le bit comp[v].
+struct bitmatrix {
+  int size;         // nombre de sommets
+  int nb_comp;      // nombre de CFC (lignes et colonnes de la matrice)
+  int * comp;       // CFC de chaque sommet
+  size_t words;     // mots de 64 bits par ligne
+  uint64_t * rows;  // nb_comp lignes de words mots
+};
+
+static void row_or_scalar(uint64_t * dst, const uint64_t * src, size_t words) {
+  for (size_t i = 0; i < words; i++) dst[i] |= src[i];
+}
+
+#ifdef GRAPH_X86_SIMD
+__attribute__((target("avx2")))
+static void row_or_avx2(uint64_t * dst, const uint64_t * src, size_t words) {
+  size_t i = 0;
+  for (; i + 4 <= words; i += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(a, b));
+  }
+  for (; i < words; i++) dst[i] |= src[i];
+}
+
+__attribute__((target("avx512f")))
+static void row_or_avx512(uint64_t * dst, const uint64_t * src, size_t words) {
+  size_t i = 0;
+  for (; i + 8 <= words; i += 8) {
+    __m512i a = _mm512_loadu_si512((const void *)(dst + i));
+    __m512i b = _mm512_loadu_si512((const void *)(src + i));
+    _mm512_storeu_si512((void *)(dst + i), _mm512_or_si512(a, b));
+  }
+  for (; i < words; i++) dst[i] |= src[i];
+}
+#endif
+
+static void (*select_row_or(void))(uint64_t *, const uint64_t *, size_t) {
+#ifdef GRAPH_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return row_or_avx512;
+  if (__builtin_cpu_supports("avx2")) return row_or_avx2;
+#endif
+  return row_or_scalar;
+}
+
+// Sommets regroupés par CFC (tri par dénombrement) : ceux de c sont
+// members[start[c] .. start[c + 1] - 1], par numéros croissants ; start (nb_comp + 1
+// cases) doit être à zéro
+static void comp_members(const int * comp, int n, int nb_comp, int * start, t_vertex * members) {
+  for (int v = 0; v < n; v++) start[comp[v] + 1]++;
+  for (int c = 0; c < nb_comp; c++) start[c + 1] += start[c];
+  for (int v = 0; v < n; v++) members[start[comp[v]]++] = v;
+  for (int c = nb_comp; c > 0; c--) start[c] = start[c - 1];
+  start[0] = 0;
+}
+
+// Lignes de la fermeture (nb_comp lignes de words mots) pour les CFC comp de g,
+// numérotées dans un ordre topologique ; NULL si la mémoire manque
+static uint64_t * closure_rows(const t_graph * g, const int * comp, int nb_comp, size_t words) {
+  int n = g->size;
+  uint64_t * rows = calloc((size_t)nb_comp * words, sizeof(*rows));
+  if (rows == NULL) return NULL;
+  void (*row_or)(uint64_t *, const uint64_t *, size_t) = select_row_or();
+
+  int * start = calloc((size_t)nb_comp + 1, sizeof(*start));
+  t_vertex * members = malloc((size_t)n * sizeof(*members));
+  int * merged = malloc((size_t)nb_comp * sizeof(*merged));
+  assert(start != NULL && members != NULL && merged != NULL);
+  comp_members(comp, n, nb_comp, start, members);
+  for (int c = 0; c < nb_comp; c++) merged[c] = -1;
+
+  for (int c = nb_comp - 1; c >= 0; c--) {
+    uint64_t * row = rows + (size_t)c * words;
+    for (int i = start[c]; i < start[c + 1]; i++) {
+      t_vertex u = members[i], v;
+      t_cursor cur;
+      cursor_init(g, u, &cur);
+      while (cursor_next(g, u, &cur, &v)) {
+        int d = comp[v];
+        row[d / 64] |= (uint64_t)1 << (d % 64); // d == c : CFC cyclique
+        if (d != c && merged[d] != c) {
+          merged[d] = c;
+          row_or(row, rows + (size_t)d * words, words);
+        }
+      }
+    }
+  }
+
+  free(merged);
+  free(members);
+  free(start);
+  return rows;
+}
+
+t_bitmatrix * graph_transitive_closure(const t_graph * g) {
+  assert(g != NULL);
+  int n = g->size;
+  t_bitmatrix * bm = malloc(sizeof(*bm));
+  assert(bm != NULL);
+  bm->size = n;
+  bm->comp = malloc((size_t)n * sizeof(*(bm->comp)));
+  assert(bm->comp != NULL);
+  bm->nb_comp = graph_scc(g, bm->comp);
+  bm->words = ((size_t)bm->nb_comp + 63) / 64;
+  bm->rows = closure_rows(g, bm->comp, bm->nb_comp, bm->words);
+  if (bm->rows == NULL) {
+    fprintf(stderr, "Fermeture transitive : mémoire insuffisante (%d CFC)\n", bm->nb_comp);
+    free(bm->comp);
+    free(bm);
+    return NULL;
+  }
+  return bm;
+}
+
+t_bool bitmatrix_get(const t_bitmatrix * bm, t_vertex from, t_vertex to) {
+  assert(bm != NULL);
+  assert(from >= 0 && from < bm->size);
+  assert(to >= 0 && to < bm->size);
+  int cf = bm->comp[from], ct = bm->comp[to];
+  return (bm->rows[(size_t)cf * bm->words + (size_t)ct / 64] >> (ct % 64)) & 1;
+}
+
+int bitmatrix_size(const t_bitmatrix * bm) {
+  return bm ? bm->size : 0;
+}
+
+void bitmatrix_free(t_bitmatrix * bm) {
+  if (bm == NULL) return;
+  free(bm->rows);
+  free(bm->comp);
+  free(bm);
+}
+
+// Parcours en largeur multi-sources (MS-BFS)
+// Jusqu'à 64 sources sont traitées en un seul parcours : pour chaque sommet, un
+// mot de 64 bits indique quelles sources l'ont déjà atteint (seen) et lesquelles
+// l'ont atteint au niveau courant (frontier). Chaque liste de successeurs est
+// lue une fois par niveau pour toutes les sources du lot.
+#define MS_BFS_BATCH 64
+
+static void ms_bfs_batch(const t_graph * g, const t_vertex * sources, int nb, int * dist,
+                         uint64_t * seen, uint64_t * frontier, uint64_t * next,
+                         t_vertex * active, t_vertex * next_active) {
+  int n = g->size;
+  int nb_active = 0;
+  memset(seen, 0, (size_t)n * sizeof(*seen));
+  memset(frontier, 0, (size_t)n * sizeof(*frontier));
+  memset(next, 0, (size_t)n * sizeof(*next));
+  for (int i = 0; i < nb; i++) {
+    t_vertex s = sources[i];
+    uint64_t bit = (uint64_t)1 << i;
+    if (frontier[s] == 0) active[nb_active++] = s;
+    seen[s] |= bit;
+    frontier[s] |= bit;
+    dist[(size_t)i * (size_t)n + (size_t)s] = 0;
+  }
+
+  for (int level = 1; nb_active > 0; level++) {
+    int nb_next = 0;
+    for (int a = 0; a < nb_active; a++) {
+      t_vertex u = active[a], w;
+      uint64_t bits = frontier[u];
+      t_cursor c;
+      cursor_init(g, u, &c);
+      while (cursor_next(g, u, &c, &w)) {
+        uint64_t fresh = bits & ~seen[w];
+        if (fresh == 0) continue;
+        if (next[w] == 0) next_active[nb_next++] = w;
+        next[w] |= fresh;
+        seen[w] |= fresh;
+        while (fresh) {
+          int i = __builtin_ctzll(fresh);
+          dist[(size_t)i * (size_t)n + (size_t)w] = level;
+          fresh &= fresh - 1;
+        }
+      }
+      frontier[u] = 0;
+    }
+    for (int a = 0; a < nb_next; a++) {
+      t_vertex w = next_active[a];
+      frontier[w] = next[w];
+      next[w] = 0;
+    }
+    t_vertex * tmp = active;
+    active = next_active;
+    next_active = tmp;
+    nb_active = nb_next;
+  }
+}
+
+void graph_ms_bfs(const t_graph * g, const t_vertex * sources, int nb_sources, int * dist) {
+  assert(g != NULL);
+  assert(nb_sources >= 0);
+  assert(nb_sources == 0 || (sources != NULL && dist != NULL));
+  int n = g->size;
+  for (int i = 0; i < nb_sources; i++) {
+    assert(sources[i] >= 0 && sources[i] < n);
+  }
+  for (size_t i = 0; i < (size_t)nb_sources * (size_t)n; i++) dist[i] = -1;
+
+  uint64_t * seen = malloc((size_t)n * sizeof(*seen));
+  uint64_t * frontier = malloc((size_t)n * sizeof(*frontier));
+  uint64_t * next = malloc((size_t)n * sizeof(*next));
+  t_vertex * active = malloc((size_t)n * sizeof(*active));
+  t_vertex * next_active = malloc((size_t)n * sizeof(*next_active));
+  assert(seen != NULL && frontier != NULL && next != NULL && active != NULL && next_active != NULL);
+
+  for (int first = 0; first < nb_sources; first += MS_BFS_BATCH) {
+    int nb = nb_sources - first < MS_BFS_BATCH ? nb_sources - first : MS_BFS_BATCH;
+    ms_bfs_batch(g, sources + first, nb, dist + (size_t)first * (size_t)n,
+                 seen, frontier, next, active, next_active);
+  }
+
+  free(next_active);
+  free(active);
+  free(next);
+  free(frontier);
+  free(seen);
+}
+
+// Plus court chemin pondéré (Dijkstra, tas à base)
+// Les distances sont des doubles positifs : leur représentation binaire, lue
+// comme un entier de 64 bits, est dans le même ordre. Dijkstra extrait des clés
+// croissantes, ce qui permet un tas à base (radix heap) : une clé k va dans le
+// seau du bit de poids fort où elle diffère de la dernière clé extraite ; à
+// chaque extraction, seul le premier seau non vide est redistribué, et chaque
+// élément descend au plus 64 fois. Les entrées périmées (distance améliorée
+// depuis) sont ignorées à l'extraction. L'espace de travail garde ses tableaux
+// entre deux requêtes ; un numéro de génération évite de les remettre à zéro.
+#define RADIX_BUCKETS 65
+
+typedef struct {
+  uint64_t key;
+  t_vertex v;
+} t_radix_item;
+
+typedef struct {
+  t_radix_item * a;
+  size_t len;
+  size_t cap;
+} t_radix_bucket;
+
+struct path_ws {
+  int size;
+  double * dist;
+  t_vertex * pred;
+  unsigned * stamp; // dist[v] et pred[v] valent pour la requête en cours si stamp[v] == gen
+  unsigned gen;
+  t_radix_bucket b[RADIX_BUCKETS];
+  uint64_t last;    // dernière clé extraite
+  size_t count;     // éléments dans le tas
+};
+
+t_path_ws * graph_path_ws_new(int size) {
+  assert(size > 0);
+  t_path_ws * ws = calloc(1, sizeof(*ws));
+  assert(ws != NULL);
+  ws->size = size;
+  ws->dist = malloc((size_t)size * sizeof(*(ws->dist)));
+  ws->pred = malloc((size_t)size * sizeof(*(ws->pred)));
+  ws->stamp = calloc((size_t)size, sizeof(*(ws->stamp)));
+  assert(ws->dist != NULL && ws->pred != NULL && ws->stamp != NULL);
+  return ws;
+}
+
+void graph_path_ws_free(t_path_ws * ws) {
+  if (ws == NULL) return;
+  for (int i = 0; i < RADIX_BUCKETS; i++) free(ws->b[i].a);
+  free(ws->dist);
+  free(ws->pred);
+  free(ws->stamp);
+  free(ws);
+}
+
+// Nouvelle requête : toutes les marques deviennent périmées
+static void path_ws_next_gen(t_path_ws * ws) {
+  if (++ws->gen == 0) {
+    // Tour complet du compteur : on remet les marques à zéro
+    memset(ws->stamp, 0, (size_t)ws->size * sizeof(*(ws->stamp)));
+    ws->gen = 1;
+  }
+}
+
+static uint64_t dist_key(double d) {
+  uint64_t k;
+  memcpy(&k, &d, sizeof(k));
+  return k;
+}
+
+// Seau de la clé k : 0 si k vaut la dernière clé extraite, sinon 1 + le rang
+// du bit de poids fort qui les distingue
+static int radix_bucket(uint64_t k, uint64_t last) {
+  uint64_t x = k ^ last;
+  if (x == 0) return 0;
+#ifdef __GNUC__
+  return 64 - __builtin_clzll(x);
+#else
+  int b = 0;
+  while (x != 0) {
+    x >>= 1;
+    b++;
+  }
+  return b;
+#endif
+}
+
+static void radix_push(t_path_ws * ws, uint64_t key, t_vertex v) {
+  t_radix_bucket * b = &ws->b[radix_bucket(key, ws->last)];
+  if (b->len == b->cap) {
+    b->cap = b->cap ? 2 * b->cap : 64;
+    b->a = realloc(b->a, b->cap * sizeof(*(b->a)));
+    assert(b->a != NULL);
+  }
+  b->a[b->len++] = (t_radix_item){ key, v };
+  ws->count++;
+}
+
+// Extrait un élément de clé minimale (le tas ne doit pas être vide)
+static t_radix_item radix_pop(t_path_ws * ws) {
+  if (ws->b[0].len == 0) {
+    int i = 1;
+    while (ws->b[i].len == 0) i++;
+    t_radix_bucket * b = &ws->b[i];
+    uint64_t min = b->a[0].key;
+    for (size_t j = 1; j < b->len; j++) {
+      if (b->a[j].key < min) min = b->a[j].key;
+    }
+    ws->last = min;
+    // Les éléments du seau i vont tous dans des seaux plus bas
+    size_t n = b->len;
+    b->len = 0;
+    ws->count -= n;
+    for (size_t j = 0; j < n; j++) radix_push(ws, b->a[j].key, b->a[j].v);
+  }
+  ws->count--;
+  return ws->b[0].a[--ws->b[0].len];
+}
+
+struct relax_ctx {
+  t_path_ws * ws;
+  t_vertex u;
+  double du;
+};
+
+static void relax_cb(t_vertex v, float w, void * ctx) {
+  struct relax_ctx * c = ctx;
+  t_path_ws * ws = c->ws;
+  double d = c->du + w;
+  if (ws->stamp[v] != ws->gen || d < ws->dist[v]) {
+    ws->stamp[v] = ws->gen;
+    ws->dist[v] = d;
+    ws->pred[v] = c->u;
+    radix_push(ws, dist_key(d), v);
+  }
+}
+
+double graph_shortest_path(const t_graph * g, t_path_ws * ws, t_vertex from, t_vertex to,
+                           t_vertex * path, int * len) {
+  assert(g != NULL && ws != NULL && ws->size == g->size);
+  assert(from >= 0 && from < g->size);
+  assert(to >= 0 && to < g->size);
+  path_ws_next_gen(ws);
+  for (int i = 0; i < RADIX_BUCKETS; i++) ws->b[i].len = 0;
+  ws->count = 0;
+  ws->last = 0;
+
+  ws->stamp[from] = ws->gen;
+  ws->dist[from] = 0;
+  ws->pred[from] = -1;
+  radix_push(ws, dist_key(0), from);
+  t_bool found = 0;
+  while (ws->count > 0) {
+    t_radix_item it = radix_pop(ws);
+    if (it.key != dist_key(ws->dist[it.v])) continue; // entrée périmée
+    if (it.v == to) {
+      found = 1;
+      break;
+    }
+    struct relax_ctx ctx = { ws, it.v, ws->dist[it.v] };
+    graph_for_each_succ_weighted(g, it.v, relax_cb, &ctx);
+  }
+
+  if (len != NULL) *len = 0;
+  if (!found) return -1;
+  int n = 0;
+  for (t_vertex v = to; v != -1; v = ws->pred[v]) n++;
+  if (len != NULL) *len = n;
+  if (path != NULL) {
+    for (t_vertex v = to; v != -1; v = ws->pred[v]) path[--n] = v;
+  }
+  return ws->dist[to];
+}
+
+// Voisinage à k arcs et sous-graphe induit
+// Le parcours en largeur borné marque les sommets vus avec le numéro de
+// génération de l'espace de travail (pas de remise à zéro) et avance niveau par
+// niveau dans out, qui sert de file. Le sous-graphe induit numérote ses sommets
+// 0..n-1 dans l'ordre de vertices : la correspondance ancien -> nouveau numéro
+// est gardée dans pred, valable pour les sommets marqués. Seuls les successeurs
+// des sommets retenus sont lus (sauf matrice : un test par couple si n < V),
+// et le résultat n'alloue que pour ses n sommets.
+struct khop_ctx {
+  t_path_ws * ws;
+  t_vertex * out;
+  int n;
+};
+
+static void khop_cb(t_vertex v, void * ctx) {
+  struct khop_ctx * c = ctx;
+  if (c->ws->stamp[v] != c->ws->gen) {
+    c->ws->stamp[v] = c->ws->gen;
+    c->out[c->n++] = v;
+  }
+}
+
+int graph_khop(const t_graph * g, const t_graph * rev, t_path_ws * ws, t_vertex center, int hops,
+               t_vertex * out) {
+  assert(g != NULL && ws != NULL && out != NULL && ws->size == g->size);
+  assert(rev == NULL || rev->size == g->size);
+  assert(center >= 0 && center < g->size);
+  path_ws_next_gen(ws);
+  struct khop_ctx ctx = { ws, out, 0 };
+  khop_cb(center, &ctx);
+  int level_start = 0;
+  for (int h = 0; h < hops && level_start < ctx.n; h++) {
+    int level_end = ctx.n;
+    for (int i = level_start; i < level_end; i++) {
+      graph_for_each_succ(g, out[i], khop_cb, &ctx);
+      if (rev != NULL) graph_for_each_succ(rev, out[i], khop_cb, &ctx);
+    }
+    level_start = level_end;
+  }
+  return ctx.n;
+}
+
+struct induced_ctx {
+  const t_path_ws * ws;
+  t_graph * sub;
+  t_vertex from;    // nouveau numéro de l'origine
+  t_wsucc * row;    // CSR : ligne en cours
+  long long len;
+};
+
+static void induced_cb(t_vertex v, float w, void * ctx) {
+  struct induced_ctx * c = ctx;
+  if (c->ws->stamp[v] != c->ws->gen) return;
+  t_vertex to = c->ws->pred[v];
+  if (c->row != NULL) {
+    c->row[c->len++] = (t_wsucc){ to, w };
+  } else if (c->sub->kind == GRAPH_LIST) {
+    // Pas de doublon possible : insertion directe en tête
+    c->sub->repr.adj[c->from] = list_add_head(to, w, c->sub->repr.adj[c->from]);
+  } else {
+    graph_put_edge(c->sub, c->from, to, w);
+  }
+}
+
+static void induced_count_cb(t_vertex v, float w, void * ctx) {
+  (void)w;
+  struct induced_ctx * c = ctx;
+  if (c->ws->stamp[v] == c->ws->gen) c->len++;
+}
+
+t_graph * graph_induced_subgraph(const t_graph * g, t_path_ws * ws, const t_vertex * vertices, int n) {
+  assert(g != NULL && ws != NULL && vertices != NULL && ws->size == g->size);
+  assert(n > 0 && n <= g->size);
+  path_ws_next_gen(ws);
+  for (int i = 0; i < n; i++) {
+    assert(vertices[i] >= 0 && vertices[i] < g->size && ws->stamp[vertices[i]] != ws->gen);
+    ws->stamp[vertices[i]] = ws->gen;
+    ws->pred[vertices[i]] = i;
+  }
+
+  t_graph * sub = graph_new(n, 0, g->kind);
+  assert(sub != NULL);
+  graph_share_names(sub, g, vertices);
+  struct induced_ctx ctx = { ws, sub, 0, NULL, 0 };
+
+  if (g->kind == GRAPH_CSR) {
+    // Deux passes : taille des lignes, puis lignes triées (numéros renumérotés)
+    struct csr * c = sub->repr.csr;
+    for (int i = 0; i < n; i++) {
+      ctx.len = 0;
+      graph_for_each_succ_weighted(g, vertices[i], induced_count_cb, &ctx);
+      c->off[i + 1] = c->off[i] + ctx.len;
+    }
+    long long m = c->off[n];
+    c->succ = malloc((size_t)(m > 0 ? m : 1) * sizeof(*(c->succ)));
+    ctx.row = malloc((size_t)(m > 0 ? m : 1) * sizeof(*(ctx.row)));
+    assert(c->succ != NULL && ctx.row != NULL);
+    STAT_BYTES((size_t)m * sizeof(*(c->succ)));
+    ctx.len = 0;
+    for (int i = 0; i < n; i++) graph_for_each_succ_weighted(g, vertices[i], induced_cb, &ctx);
+    t_bool weighted = 0;
+    for (int i = 0; i < n; i++) {
+      qsort(ctx.row + c->off[i], (size_t)(c->off[i + 1] - c->off[i]), sizeof(*(ctx.row)), cmp_wsucc);
+    }
+    for (long long k = 0; k < m; k++) {
+      c->succ[k] = ctx.row[k].v;
+      weighted = weighted || ctx.row[k].w != 1.0f;
+    }
+    if (weighted) {
+      float * w = csr_weights(c, n);
+      for (long long k = 0; k < m; k++) w[k] = ctx.row[k].w;
+    }
+    free(ctx.row);
+  } else if (g->kind == GRAPH_MATRIX && n < g->size) {
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        if (g->repr.m[vertices[i]][vertices[j]]) {
+          graph_put_edge(sub, i, j, matrix_weight(g, vertices[i], vertices[j]));
+        }
+      }
+    }
+  } else {
+    for (int i = 0; i < n; i++) {
+      ctx.from = i;
+      graph_for_each_succ_weighted(g, vertices[i], induced_cb, &ctx);
+    }
+  }
+  return sub;
+}
+
+// Sortie des CFC
+// Les écritures passent par un tampon de OUT_BUF_SIZE octets vidé par fwrite,
+// sans printf par sommet. Les sommets sont regroupés par CFC (tri par comptage).
+#define OUT_BUF_SIZE (1 << 20)
+
+typedef struct {
+  FILE * out;
+  char * buf;
+  size_t len;
+  t_bool ok;
+} t_out_buf;
+
+static void out_flush(t_out_buf * o) {
+  if (o->len > 0 && fwrite(o->buf, 1, o->len, o->out) != o->len) o->ok = 0;
+  o->len = 0;
+}
+
+static void out_bytes(t_out_buf * o, const void * p, size_t n) {
+  if (o->len + n > OUT_BUF_SIZE) {
+    out_flush(o);
+    if (n > OUT_BUF_SIZE) {
+      if (fwrite(p, 1, n, o->out) != n) o->ok = 0;
+      return;
+    }
+  }
+  memcpy(o->buf + o->len, p, n);
+  o->len += n;
+}
+
+static void out_str(t_out_buf * o, const char * s) {
+  out_bytes(o, s, strlen(s));
+}
+
+static void out_char(t_out_buf * o, char c) {
+  if (o->len == OUT_BUF_SIZE) out_flush(o);
+  o->buf[o->len++] = c;
+}
+
+static void out_int(t_out_buf * o, long long v) {
+  char tmp[24];
+  int i = (int)sizeof(tmp);
+  unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+  do {
+    tmp[--i] = (char)('0' + u % 10);
+    u /= 10;
+  } while (u > 0);
+  if (v < 0) tmp[--i] = '-';
+  out_bytes(o, tmp + i, sizeof(tmp) - (size_t)i);
+}
+
+// Chaîne JSON entre guillemets
+static void out_json_str(t_out_buf * o, const char * s) {
+  out_char(o, '"');
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      out_char(o, '\\');
+      out_char(o, (char)c);
+    } else if (c < 0x20) {
+      static const char hex[] = "0123456789abcdef";
+      out_str(o, "\\u00");
+      out_char(o, hex[c >> 4]);
+      out_char(o, hex[c & 15]);
+    } else {
+      out_char(o, (char)c);
+    }
+  }
+  out_char(o, '"');
+}
+
+// Champ CSV, entre guillemets seulement si nécessaire
+static void out_csv_str(t_out_buf * o, const char * s) {
+  if (strpbrk(s, ",\"\r\n") == NULL) {
+    out_str(o, s);
+    return;
+  }
+  out_char(o, '"');
+  for (; *s; s++) {
+    if (*s == '"') out_char(o, '"');
+    out_char(o, *s);
+  }
+  out_char(o, '"');
+}
+
+// Nom d'un sommet pour l'écriture des CFC (graphe ou cache), NULL sans noms
+typedef const char * (*t_name_fn)(const void * src, t_vertex v);
+
+static const char * graph_name_fn(const void * src, t_vertex v) {
+  return graph_vertex_name(src, v);
+}
+
+// Sommet : nom (selon le format) ou numéro
+static void out_vertex(t_out_buf * o, t_name_fn name_of, const void * src, t_vertex v,
+                       t_scc_format format) {
+  const char * name = name_of(src, v);
+  if (name == NULL) {
+    out_int(o, v);
+  } else if (format == GRAPH_SCC_JSON) {
+    out_json_str(o, name);
+  } else if (format == GRAPH_SCC_CSV) {
+    out_csv_str(o, name);
+  } else {
+    out_str(o, name);
+  }
+}
+
+typedef struct {
+  int size;
+  int id;
+} t_scc_rank;
+
+static int scc_rank_cmp(const void * a, const void * b) {
+  const t_scc_rank * x = a;
+  const t_scc_rank * y = b;
+  if (x->size != y->size) return x->size > y->size ? -1 : 1;
+  return (x->id > y->id) - (x->id < y->id);
+}
+
+static t_bool write_scc(FILE * out, int n, t_name_fn name_of, const void * src, const int * comp,
+                        int nb_comp, t_scc_format format, int top) {
+  // Sommets par CFC : members[start[c] .. start[c + 1] - 1], numéros croissants
+  int * start = calloc((size_t)nb_comp + 1, sizeof(int));
+  int * members = malloc((size_t)n * sizeof(int));
+  t_scc_rank * ranks = malloc(((size_t)nb_comp + 1) * sizeof(t_scc_rank));
+  t_bool * kept = malloc(((size_t)nb_comp + 1) * sizeof(t_bool));
+  t_out_buf o = { out, malloc(OUT_BUF_SIZE), 0, 1 };
+  if (start == NULL || members == NULL || ranks == NULL || kept == NULL || o.buf == NULL) {
+    free(start);
+    free(members);
+    free(ranks);
+    free(kept);
+    free(o.buf);
+    return 0;
+  }
+
+  comp_members(comp, n, nb_comp, start, members);
+
+  // CFC retenues, dans l'ordre d'écriture
+  int nb_kept = nb_comp;
+  for (int c = 0; c < nb_comp; c++) {
+    ranks[c].size = start[c + 1] - start[c];
+    ranks[c].id = c;
+  }
+  if (top > 0 && top < nb_comp) {
+    qsort(ranks, (size_t)nb_comp, sizeof(t_scc_rank), scc_rank_cmp);
+    nb_kept = top;
+  }
+  for (int c = 0; c < nb_comp; c++) kept[c] = 0;
+  for (int k = 0; k < nb_kept; k++) kept[ranks[k].id] = 1;
+
+  switch (format) {
+  case GRAPH_SCC_TEXT:
+    for (int k = 0; k < nb_kept; k++) {
+      int c = ranks[k].id;
+      for (int i = start[c]; i < start[c + 1]; i++) {
+        if (i > start[c]) out_char(&o, ' ');
+        out_vertex(&o, name_of, src, members[i], format);
+      }
+      out_char(&o, '\n');
+    }
+    break;
+  case GRAPH_SCC_CSV:
+    out_str(&o, "vertex,component\n");
+    for (int v = 0; v < n; v++) {
+      if (!kept[comp[v]]) continue;
+      out_vertex(&o, name_of, src, v, format);
+      out_char(&o, ',');
+      out_int(&o, comp[v]);
+      out_char(&o, '\n');
+    }
+    break;
+  case GRAPH_SCC_JSON:
+    out_str(&o, "{\"nb_vertices\":");
+    out_int(&o, n);
+    out_str(&o, ",\"nb_components\":");
+    out_int(&o, nb_comp);
+    out_str(&o, ",\"components\":[");
+    for (int k = 0; k < nb_kept; k++) {
+      int c = ranks[k].id;
+      out_str(&o, k > 0 ? ",\n{\"id\":" : "\n{\"id\":");
+      out_int(&o, c);
+      out_str(&o, ",\"size\":");
+      out_int(&o, start[c + 1] - start[c]);
+      out_str(&o, ",\"vertices\":[");
+      for (int i = start[c]; i < start[c + 1]; i++) {
+        if (i > start[c]) out_char(&o, ',');
+        out_vertex(&o, name_of, src, members[i], format);
+      }
+      out_str(&o, "]}");
+    }
+    out_str(&o, "\n]}\n");
+    break;
+  case GRAPH_SCC_BINARY:
+    for (int v = 0; v < n; v++) {
+      int32_t id = kept[comp[v]] ? (int32_t)comp[v] : -1;
+      out_bytes(&o, &id, sizeof(id));
+    }
+    break;
+  }
+  out_flush(&o);
+
+  free(start);
+  free(members);
+  free(ranks);
+  free(kept);
+  free(o.buf);
+  return o.ok;
+}
+
+t_bool graph_write_scc(FILE * out, const t_graph * g, const int * comp, int nb_comp,
+                       t_scc_format format, int top) {
+  assert(out != NULL && g != NULL && comp != NULL && nb_comp >= 0);
+  return write_scc(out, g->size, graph_name_fn, g, comp, nb_comp, format, top);
+}
+
+t_bool graph_write_scc_histogram(FILE * out, const int * comp, int n, int nb_comp) {
+  assert(out != NULL && comp != NULL && nb_comp >= 0);
+  int * size = calloc((size_t)nb_comp + 1, sizeof(int));
+  if (size == NULL) return 0;
+  for (int v = 0; v < n; v++) size[comp[v]]++;
+
+  // Classe k : tailles de 2^k à 2^(k+1) - 1
+  long long count[32] = { 0 };
+  long long vertices[32] = { 0 };
+  int last = 0;
+  for (int c = 0; c < nb_comp; c++) {
+    int k = 0;
+    while ((size[c] >> (k + 1)) > 0) k++;
+    count[k]++;
+    vertices[k] += size[c];
+    if (k > last) last = k;
+  }
+  free(size);
+
+  t_bool ok = fprintf(out, "%-21s %12s %12s\n", "taille", "CFC", "sommets") > 0;
+  for (int k = 0; k <= last && ok; k++) {
+    char range[32];
+    long long lo = 1LL << k;
+    if (lo == 1) snprintf(range, sizeof(range), "1");
+    else snprintf(range, sizeof(range), "%lld-%lld", lo, 2 * lo - 1);
+    ok = fprintf(out, "%-21s %12lld %12lld\n", range, count[k], vertices[k]) > 0;
+  }
+  return ok;
+}
+
+// Cache des CFC sur disque. Le fichier est l'image exacte des tableaux, dans
+// l'ordre natif de la machine : une fois projeté par mmap, il sert tel quel,
+// sans lecture ni conversion. Après l'en-tête viennent, chacun aligné sur 8 octets :
+//   comp      int32[size]          numéro de CFC de chaque sommet
+//   dag_off   int64[nb_comp + 1]   graphe des CFC : successeurs de c (triés) dans
+//   dag_succ  int32[nb_dag_edges]  dag_succ[dag_off[c] .. dag_off[c + 1] - 1]
+//   name_off  int64[size + 1]      si names_bytes > 0 : nom de v (terminé par 0)
+//   names     char[names_bytes]    à names + name_off[v]
+//   closure   uint64[nb_comp * closure_words]  si closure_words > 0 : ligne de
+//                                  bits de chaque CFC (voir graph_transitive_closure)
+#define CACHE_MAGIC "GRSCC01"
+#define CACHE_BLOCK (1 << 16)
+
+_Static_assert(sizeof(int) == sizeof(int32_t), "comp est projeté directement en int");
+
+struct cache_header {
+  char magic[8];
+  uint64_t key;
+  int32_t size;
+  int32_t nb_comp;
+  int64_t nb_dag_edges;
+  int64_t names_bytes;
+  int64_t closure_words;
+};
+
+struct scc_cache {
+  void * map;
+  size_t map_len;
+  const struct cache_header * h;
+  const int32_t * comp;
+  const int64_t * dag_off;
+  const int32_t * dag_succ;
+  const int64_t * name_off;  // NULL sans noms
+  const char * names;
+  const uint64_t * closure;  // NULL sans fermeture
+};
+
+static size_t align8(size_t n) {
+  return (n + 7) & ~(size_t)7;
+}
+
+// Mélange final (splitmix64)
+static uint64_t mix64(uint64_t h) {
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+// Empreinte par mots de 8 octets (rotation et multiplication), taille comprise
+t_bool graph_file_digest(const char * filename, unsigned long long * digest) {
+  assert(filename != NULL && digest != NULL);
+  FILE * f = fopen(filename, "rb");
+  if (f == NULL) return 0;
+  unsigned char * block = malloc(CACHE_BLOCK);
+  if (block == NULL) {
+    fclose(f);
+    return 0;
+  }
+  uint64_t h = 0x9e3779b97f4a7c15ULL;
+  uint64_t total = 0;
+  size_t got;
+  while ((got = fread(block, 1, CACHE_BLOCK, f)) > 0) {
+    total += got;
+    size_t i = 0;
+    for (; i + 8 <= got; i += 8) {
+      uint64_t w;
+      memcpy(&w, block + i, 8);
+      h = ((h << 27) | (h >> 37)) ^ (w * 0xff51afd7ed558ccdULL);
+      h *= 0xc4ceb9fe1a85ec53ULL;
+    }
+    if (i < got) {
+      uint64_t w = 0;
+      memcpy(&w, block + i, got - i);
+      h = ((h << 27) | (h >> 37)) ^ (w * 0xff51afd7ed558ccdULL);
+      h *= 0xc4ceb9fe1a85ec53ULL;
+    }
+  }
+  t_bool ok = !ferror(f);
+  fclose(f);
+  free(block);
+  *digest = mix64(h ^ total);
+  return ok;
+}
+
+// Bourrage d'une section de n octets jusqu'au multiple de 8 suivant
+static t_bool cache_pad(FILE * out, size_t n) {
+  static const char zero[8] = { 0 };
+  size_t pad = align8(n) - n;
+  return pad == 0 || fwrite(zero, 1, pad, out) == pad;
+}
+
+// Section de n octets, bourrage compris
+static t_bool cache_put(FILE * out, const void * p, size_t n) {
+  return (n == 0 || fwrite(p, 1, n, out) == n) && cache_pad(out, n);
+}
+
+t_bool graph_scc_cache_save(const char * path, unsigned long long key, const t_graph * g,
+                            const int * comp, int nb_comp) {
+  assert(path != NULL && g != NULL && comp != NULL && nb_comp >= 0);
+  int n = g->size;
+  struct cache_header h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, CACHE_MAGIC, sizeof(h.magic));
+  h.key = key;
+  h.size = n;
+  h.nb_comp = nb_comp;
+
+  // Graphe des CFC : successeurs distincts de chaque CFC, triés
+  int * start = calloc((size_t)nb_comp + 1, sizeof(*start));
+  t_vertex * members = malloc((size_t)(n > 0 ? n : 1) * sizeof(*members));
+  int * seen = malloc((size_t)(nb_comp > 0 ? nb_comp : 1) * sizeof(*seen));
+  int64_t * dag_off = malloc(((size_t)nb_comp + 1) * sizeof(*dag_off));
+  size_t cap = 1024;
+  int32_t * dag_succ = malloc(cap * sizeof(*dag_succ));
+  assert(start != NULL && members != NULL && seen != NULL && dag_off != NULL && dag_succ != NULL);
+  comp_members(comp, n, nb_comp, start, members);
+  for (int c = 0; c < nb_comp; c++) seen[c] = -1;
+  size_t len = 0;
+  for (int c = 0; c < nb_comp; c++) {
+    dag_off[c] = (int64_t)len;
+    for (int i = start[c]; i < start[c + 1]; i++) {
+      t_vertex u = members[i], v;
+      t_cursor cur;
+      cursor_init(g, u, &cur);
+      while (cursor_next(g, u, &cur, &v)) {
+        int d = comp[v];
+        if (d == c || seen[d] == c) continue;
+        seen[d] = c;
+        if (len == cap) {
+          cap *= 2;
+          dag_succ = realloc(dag_succ, cap * sizeof(*dag_succ));
+          assert(dag_succ != NULL);
+        }
+        dag_succ[len++] = d;
+      }
+    }
+    qsort(dag_succ + dag_off[c], len - (size_t)dag_off[c], sizeof(*dag_succ), cmp_vertex);
+  }
+  dag_off[nb_comp] = (int64_t)len;
+  h.nb_dag_edges = (int64_t)len;
+  free(seen);
+  free(members);
+  free(start);
+
+  // Noms
+  int64_t * name_off = NULL;
+  if (graph_has_names(g)) {
+    name_off = malloc(((size_t)n + 1) * sizeof(*name_off));
+    assert(name_off != NULL);
+    name_off[0] = 0;
+    for (int v = 0; v < n; v++) {
+      const char * name = graph_vertex_name(g, v);
+      name_off[v + 1] = name_off[v] + (int64_t)strlen(name != NULL ? name : "") + 1;
+    }
+    h.names_bytes = name_off[n];
+  }
+
+  // Fermeture, seulement pour un graphe des CFC de taille raisonnable
+  uint64_t * rows = NULL;
+  if (nb_comp > 0 && nb_comp <= GRAPH_CACHE_CLOSURE_MAX) {
+    size_t words = ((size_t)nb_comp + 63) / 64;
+    rows = closure_rows(g, comp, nb_comp, words);
+    if (rows != NULL) h.closure_words = (int64_t)words;
+  }
+
+  // Écriture dans un fichier temporaire, renommé à la fin : un cache n'est
+  // jamais visible à moitié écrit
+  size_t tmp_len = strlen(path) + 5;
+  char * tmp = malloc(tmp_len);
+  assert(tmp != NULL);
+  snprintf(tmp, tmp_len, "%s.tmp", path);
+  FILE * out = fopen(tmp, "wb");
+  t_bool ok = out != NULL;
+  if (ok) {
+    ok = cache_put(out, &h, sizeof(h))
+         && cache_put(out, comp, (size_t)n * sizeof(int32_t))
+         && cache_put(out, dag_off, ((size_t)nb_comp + 1) * sizeof(*dag_off))
+         && cache_put(out, dag_succ, len * sizeof(*dag_succ));
+    if (ok && name_off != NULL) {
+      ok = cache_put(out, name_off, ((size_t)n + 1) * sizeof(*name_off));
+      for (int v = 0; v < n && ok; v++) {
+        const char * name = graph_vertex_name(g, v);
+        if (name == NULL) name = "";
+        ok = fwrite(name, 1, strlen(name) + 1, out) == strlen(name) + 1;
+      }
+      ok = ok && cache_pad(out, (size_t)h.names_bytes);
+    }
+    if (ok && rows != NULL) {
+      ok = cache_put(out, rows, (size_t)nb_comp * (size_t)h.closure_words * sizeof(*rows));
+    }
+    ok = (fclose(out) == 0) && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) remove(tmp);
+  }
+  free(tmp);
+  free(rows);
+  free(name_off);
+  free(dag_succ);
+  free(dag_off);
+  return ok;
+}
+
+// Contenu des sections, qui sera lu sans autre contrôle : numéros de CFC
+// inférieurs à nb_comp, positions du graphe des CFC croissantes et dans
+// dag_succ, successeurs valides, noms dans la réserve et terminés par 0. Un
+// cache abîmé ou d'une autre version de même taille est ainsi écarté, au prix
+// d'un parcours linéaire de la projection.
+static t_bool cache_sections_valid(const struct scc_cache * c) {
+  const struct cache_header * h = c->h;
+  for (int v = 0; v < h->size; v++) {
+    if (c->comp[v] < 0 || c->comp[v] >= h->nb_comp) return 0;
+  }
+  if (c->dag_off[0] != 0 || c->dag_off[h->nb_comp] != h->nb_dag_edges) return 0;
+  for (int k = 0; k < h->nb_comp; k++) {
+    if (c->dag_off[k] > c->dag_off[k + 1]) return 0;
+  }
+  for (int64_t i = 0; i < h->nb_dag_edges; i++) {
+    if (c->dag_succ[i] < 0 || c->dag_succ[i] >= h->nb_comp) return 0;
+  }
+  if (c->name_off != NULL) {
+    if (c->name_off[0] != 0 || c->name_off[h->size] > h->names_bytes) return 0;
+    for (int v = 0; v < h->size; v++) {
+      if (c->name_off[v] >= c->name_off[v + 1] || c->names[c->name_off[v + 1] - 1] != '\0') return 0;
+    }
+  }
+  return 1;
+}
+
+t_scc_cache * graph_scc_cache_open(const char * path, unsigned long long key) {
+  assert(path != NULL);
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat st;
+  void * map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(struct cache_header)) {
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) return NULL;
+
+  // En-tête cohérent avec la taille du fichier, sinon le cache est ignoré ;
+  // chaque champ est d'abord borné par la taille pour que la somme ne déborde pas
+  const struct cache_header * h = map;
+  size_t len = (size_t)st.st_size;
+  t_bool ok = memcmp(h->magic, CACHE_MAGIC, sizeof(h->magic)) == 0 && h->key == key
+              && h->size >= 0 && h->nb_comp >= 0 && h->nb_dag_edges >= 0
+              && h->names_bytes >= 0 && h->closure_words >= 0
+              && (uint64_t)h->nb_dag_edges <= len && (uint64_t)h->names_bytes <= len
+              && (uint64_t)h->closure_words <= len
+              && (h->closure_words == 0 || h->closure_words == ((int64_t)h->nb_comp + 63) / 64);
+  size_t expected = 0;
+  if (ok) {
+    expected = align8(sizeof(*h)) + align8((size_t)h->size * sizeof(int32_t))
+               + align8(((size_t)h->nb_comp + 1) * sizeof(int64_t))
+               + align8((size_t)h->nb_dag_edges * sizeof(int32_t))
+               + (size_t)h->nb_comp * (size_t)h->closure_words * sizeof(uint64_t);
+    if (h->names_bytes > 0) {
+      expected += align8(((size_t)h->size + 1) * sizeof(int64_t)) + align8((size_t)h->names_bytes);
+    }
+    ok = expected == len;
+  }
+  if (!ok) {
+    munmap(map, len);
+    return NULL;
+  }
+
+  t_scc_cache * c = malloc(sizeof(*c));
+  assert(c != NULL);
+  const char * p = map;
+  c->map = map;
+  c->map_len = len;
+  c->h = h;
+  p += align8(sizeof(*h));
+  c->comp = (const int32_t *)p;
+  p += align8((size_t)h->size * sizeof(int32_t));
+  c->dag_off = (const int64_t *)p;
+  p += align8(((size_t)h->nb_comp + 1) * sizeof(int64_t));
+  c->dag_succ = (const int32_t *)p;
+  p += align8((size_t)h->nb_dag_edges * sizeof(int32_t));
+  c->name_off = NULL;
+  c->names = NULL;
+  if (h->names_bytes > 0) {
+    c->name_off = (const int64_t *)p;
+    p += align8(((size_t)h->size + 1) * sizeof(int64_t));
+    c->names = p;
+    p += align8((size_t)h->names_bytes);
+  }
+  c->closure = h->closure_words > 0 ? (const uint64_t *)p : NULL;
+  if (!cache_sections_valid(c)) {
+    graph_scc_cache_close(c);
+    return NULL;
+  }
+  return c;
+}
+
+void graph_scc_cache_close(t_scc_cache * c) {
+  if (c == NULL) return;
+  munmap(c->map, c->map_len);
+  free(c);
+}
+
+int graph_scc_cache_size(const t_scc_cache * c) {
+  assert(c != NULL);
+  return c->h->size;
+}
+
+int graph_scc_cache_nb_comp(const t_scc_cache * c) {
+  assert(c != NULL);
+  return c->h->nb_comp;
+}
+
+const int * graph_scc_cache_comp(const t_scc_cache * c) {
+  assert(c != NULL);
+  return (const int *)c->comp;
+}
+
+const char * graph_scc_cache_name(const t_scc_cache * c, t_vertex v) {
+  assert(c != NULL && v >= 0 && v < c->h->size);
+  return c->names != NULL ? c->names + c->name_off[v] : NULL;
+}
+
+int graph_scc_cache_succ(const t_scc_cache * c, int comp, const int ** succ) {
+  assert(c != NULL && succ != NULL && comp >= 0 && comp < c->h->nb_comp);
+  *succ = (const int *)c->dag_succ + c->dag_off[comp];
+  return (int)(c->dag_off[comp + 1] - c->dag_off[comp]);
+}
+
+int graph_scc_cache_reaches(const t_scc_cache * c, t_vertex from, t_vertex to) {
+  assert(c != NULL && from >= 0 && from < c->h->size && to >= 0 && to < c->h->size);
+  if (c->closure == NULL) return -1;
+  int cf = c->comp[from], ct = c->comp[to];
+  return (c->closure[(size_t)cf * (size_t)c->h->closure_words + (size_t)ct / 64] >> (ct % 64)) & 1;
+}
+
+static const char * cache_name_fn(const void * src, t_vertex v) {
+  return graph_scc_cache_name(src, v);
+}
+
+t_bool graph_scc_cache_write(FILE * out, const t_scc_cache * c, t_scc_format format, int top) {
+  assert(out != NULL && c != NULL);
+  return write_scc(out, c->h->size, cache_name_fn, c, (const int *)c->comp, c->h->nb_comp, format,
+                   top);
+}
+
+// Affichage façon liste d'adjacence
+struct show_ctx {
+  const t_graph * g;
+};
+
+static void graph_show_cb(t_vertex v, void * ctx) {
+  const struct show_ctx * c = ctx;
+  const char * name = graph_vertex_name(c->g, v);
+  if (name) {
+    printf(" %s", name);
+  } else {
+    printf(" %d", v);
+  }
+}
+
+void graph_show(const t_graph * g) {
+  assert(g != NULL);
+  for (int i = 0; i < g->size; i++) {
+    const char * name = graph_vertex_name(g, i);
+    if (name) {
+      printf("%s:", name);
+    } else {
+      printf("%d:", i);
+    }
+    struct show_ctx ctx = { g };
+    graph_for_each_succ(g, i, graph_show_cb, &ctx);
+    printf("\n");
+  }
+}
+
+// Découpage vectorisé du format 1
+// Les lignes sont lues par blocs (fread) puis découpées sans fgets ni sscanf :
+// recherche des fins de ligne et des suites de chiffres 16 ou 32 octets à la
+// fois (SSE4.2 / AVX2, choisi à l'exécution), conversion des nombres à la main.
+// Chaque morceau de ligne fait au plus MAX_READ_LINE - 1 octets, comme avec
+// fgets, pour que les messages d'erreur restent identiques.
+#define SCAN_BLOCK (1 << 20)
+#define SCAN_PAD 64
+
+static t_bool is_space_c(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static size_t find_newline_scalar(const char * p, size_t n) {
+  const char * nl = memchr(p, '\n', n);
+  return nl ? (size_t)(nl - p) : n;
+}
+
+// Longueur de la suite de chiffres commençant en p (s'arrête au moins sur '\0')
+static size_t digit_run_scalar(const char * p) {
+  size_t n = 0;
+  while ((unsigned char)(p[n] - '0') < 10) n++;
+  return n;
+}
+
+#ifdef GRAPH_X86_SIMD
+__attribute__((target("sse4.2")))
+static size_t find_newline_sse42(const char * p, size_t n) {
+  const __m128i nl = _mm_set1_epi8('\n');
+  for (size_t i = 0; i < n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+    if (mask) {
+      size_t idx = i + (size_t)__builtin_ctz(mask);
+      return idx < n ? idx : n;
+    }
+  }
+  return n;
+}
+
+__attribute__((target("sse4.2")))
+static size_t digit_run_sse42(const char * p) {
+  const __m128i range = _mm_setr_epi8('0', '9', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  size_t n = 0;
+  for (;;) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + n));
+    int idx = _mm_cmpistri(range, v, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY);
+    if (idx < 16) return n + (size_t)idx;
+    n += 16;
+  }
+}
+
+__attribute__((target("avx2")))
+static size_t find_newline_avx2(const char * p, size_t n) {
+  const __m256i nl = _mm256_set1_epi8('\n');
+  for (size_t i = 0; i < n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+    unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+    if (mask) {
+      size_t idx = i + (size_t)__builtin_ctz(mask);
+      return idx < n ? idx : n;
+    }
+  }
+  return n;
+}
+
+__attribute__((target("avx2")))
+static size_t digit_run_avx2(const char * p) {
+  const __m256i zero = _mm256_set1_epi8('0');
+  const __m256i nine = _mm256_set1_epi8(9);
+  size_t n = 0;
+  for (;;) {
+    __m256i d = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i *)(p + n)), zero);
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, nine), d);
+    unsigned mask = ~(unsigned)_mm256_movemask_epi8(is_digit);
+    if (mask) return n + (size_t)__builtin_ctz(mask);
+    n += 32;
+  }
+}
+#endif
+
+static size_t (*find_newline)(const char *, size_t) = NULL;
+static size_t (*digit_run)(const char *) = NULL;
+
+// Choix des fonctions selon le processeur ; GRAPH_SIMD=scalar|sse42|avx2 force un choix
+static void scan_select_kernels(void) {
+  if (find_newline != NULL) return;
+  const char * force = getenv("GRAPH_SIMD");
+  find_newline = find_newline_scalar;
+  digit_run = digit_run_scalar;
+#ifdef GRAPH_X86_SIMD
+  __builtin_cpu_init();
+  t_bool sse42 = __builtin_cpu_supports("sse4.2");
+  t_bool avx2 = __builtin_cpu_supports("avx2");
+  if (force != NULL && strcmp(force, "avx2") != 0) avx2 = 0;
+  if (force != NULL && strcmp(force, "avx2") != 0 && strcmp(force, "sse42") != 0) sse42 = 0;
+  if (avx2) {
+    find_newline = find_newline_avx2;
+    digit_run = digit_run_avx2;
+  } else if (sse42) {
+    find_newline = find_newline_sse42;
+    digit_run = digit_run_sse42;
+  }
+#else
+  (void)force;
+#endif
+}
+
+typedef struct {
+  FILE * in;
+  char * buf;   // SCAN_BLOCK octets utiles + SCAN_PAD octets nuls
+  size_t len;   // octets valides dans buf
+  size_t pos;   // début de la prochaine ligne
+  t_bool eof;
+} t_line_scanner;
+
+static void scanner_init(t_line_scanner * sc, FILE * in) {
+  scan_select_kernels();
+  sc->in = in;
+  sc->buf = malloc(SCAN_BLOCK + SCAN_PAD);
+  assert(sc->buf != NULL);
+  sc->len = 0;
+  sc->pos = 0;
+  sc->eof = 0;
+  memset(sc->buf, 0, SCAN_PAD);
+}
+
+static void scanner_free(t_line_scanner * sc) {
+  free(sc->buf);
+}
+
+// Recopie la ligne commencée en tête du tampon puis le complète
+static void scanner_refill(t_line_scanner * sc) {
+  size_t rest = sc->len - sc->pos;
+  memmove(sc->buf, sc->buf + sc->pos, rest);
+  size_t got = fread(sc->buf + rest, 1, SCAN_BLOCK - rest, sc->in);
+  if (got == 0) sc->eof = 1;
+  sc->len = rest + got;
+  sc->pos = 0;
+  memset(sc->buf + sc->len, 0, SCAN_PAD);
+}
+
+// Ligne suivante non vide, blancs finaux retirés (équivalent de read_line_skip_empty)
+static t_bool scanner_next_line(t_line_scanner * sc, const char ** line, size_t * len) {
+  const size_t limit = MAX_READ_LINE - 1;
+  for (;;) {
+    size_t avail = sc->len - sc->pos;
+    size_t window = avail < limit ? avail : limit;
+    const char * start = sc->buf + sc->pos;
+    size_t piece = find_newline(start, window);
+    if (piece == window && window < limit && !sc->eof) {
+      // Ligne incomplète dans le tampon : lire la suite du flux
+      scanner_refill(sc);
+      continue;
+    }
+    if (avail == 0) return 0;
+    if (piece < window) piece++; // inclut le '\n'
+    sc->pos += piece;
+
+    while (piece > 0 && is_space_c(start[piece - 1])) piece--;
+    size_t first = 0;
+    while (first < piece && is_space_c(start[first])) first++;
+    if (first < piece) {
+      *line = start;
+      *len = piece;
+      return 1;
+    }
+  }
+}
+
+// Lit un entier comme "%d" ; retourne la position suivante ou NULL si aucun entier
+static const char * scan_int(const char * p, const char * end, long long * out) {
+  while (p < end && is_space_c(*p)) p++;
+  t_bool neg = 0;
+  if (p < end && (*p == '+' || *p == '-')) {
+    neg = (*p == '-');
+    p++;
+  }
+  size_t run = p < end ? digit_run(p) : 0;
+  if (run > (size_t)(end - p)) run = (size_t)(end - p);
+  if (run == 0) return NULL;
+  long long v = 0;
+  for (size_t i = 0; i < run; i++) {
+    if (v <= INT32_MAX) v = v * 10 + (p[i] - '0');
+  }
+  *out = neg ? -v : v;
+  return p + run;
+}
+
+// Copie d'une ligne dans buf pour les messages d'erreur
+static const char * line_copy(char * buf, const char * line, size_t len) {
+  memcpy(buf, line, len);
+  buf[len] = '\0';
+  return buf;
+}
+
+// Poids facultatif en fin de ligne (1 s'il est absent) ; retourne 0 s'il est
+// illisible, négatif ou infini
+static t_bool parse_weight(const char * s, float * w) {
+  while (is_space_c(*s)) s++;
+  if (*s == '\0') {
+    *w = 1.0f;
+    return 1;
+  }
+  char * end;
+  float v = strtof(s, &end);
+  if (end == s) return 0;
+  while (is_space_c(*end)) end++;
+  if (*end != '\0' || !(v >= 0 && v <= FLT_MAX)) return 0;
+  *w = v;
+  return 1;
+}
+
+// Destination des arêtes lues : insertion directe ou lot de l'anneau du chargement en pipeline
+typedef void (*t_edge_sink)(void * ctx, t_vertex from, t_vertex to, float w);
+
+static void sink_add_edge(void * ctx, t_vertex from, t_vertex to, float w) {
+  STAT_PHASE_BEGIN(GRAPH_PHASE_BUILD);
+  graph_add_weighted_edge((t_graph *)ctx, from, to, w);
+  STAT_PHASE_END(GRAPH_PHASE_BUILD);
+}
+
+// Arêtes du format 1 (après la ligne du nombre de sommets), "u v" ou "u v poids"
+static void format1_scan_edges(FILE * in, int size, t_edge_sink sink, void * ctx) {
+  char buf[MAX_READ_LINE], wbuf[MAX_READ_LINE];
+  t_line_scanner sc;
+  scanner_init(&sc, in);
+  const char * line;
+  size_t len;
+  STAT_PHASE_BEGIN(GRAPH_PHASE_PARSE);
+  while (scanner_next_line(&sc, &line, &len)) {
+    long long from, to;
+    const char * p, * q;
+    float w = 1.0f;
+    STAT_ADD(edges_scanned, 1);
+    if ((p = scan_int(line, line + len, &from)) != NULL && (q = scan_int(p, line + len, &to)) != NULL) {
+      if (q < line + len && !parse_weight(line_copy(wbuf, q, (size_t)(line + len - q)), &w)) {
+        fprintf(stderr, "Format 1 : poids invalide, ligne ignorée \"%s\"\n", line_copy(buf, line, len));
+      } else if (from >= 0 && from < size && to >= 0 && to < size) {
+        STAT_PHASE_END(GRAPH_PHASE_PARSE);
+        sink(ctx, (t_vertex)from, (t_vertex)to, w);
+        STAT_PHASE_BEGIN(GRAPH_PHASE_PARSE);
+      } else {
+        fprintf(stderr, "Format 1 : arête hors limites ignorée \"%s\"\n", line_copy(buf, line, len));
+      }
+    } else {
+      fprintf(stderr, "Format 1 : ligne ignorée car illisible \"%s\"\n", line_copy(buf, line, len));
+    }
+  }
+  STAT_PHASE_END(GRAPH_PHASE_PARSE);
+  scanner_free(&sc);
+}
+
+// Arêtes du format 2 (après les noms), "a b" ou "a b poids" ; ne lit que les noms de g
+static void format2_scan_edges(FILE * in, const t_graph * g, t_edge_sink sink, void * ctx) {
+  char buf[MAX_READ_LINE];
+  // On suppose des noms sans espace, séparés par des blancs
+  STAT_PHASE_BEGIN(GRAPH_PHASE_PARSE);
+  while (read_line_skip_empty(in, buf, sizeof(buf))) {
+    char name_from[MAX_READ_LINE], name_to[MAX_READ_LINE];
+    int used = 0;
+    float w = 1.0f;
+    STAT_ADD(edges_scanned, 1);
+    if (sscanf(buf, "%s %s%n", name_from, name_to, &used) == 2 && !parse_weight(buf + used, &w)) {
+      fprintf(stderr, "Format 2 : poids invalide, ligne ignorée \"%s\"\n", buf);
+    } else if (used > 0) {
+      STAT_PHASE_END(GRAPH_PHASE_PARSE);
+      STAT_PHASE_BEGIN(GRAPH_PHASE_LOOKUP);
+      t_vertex from = graph_vertex_from_name(g, name_from);
+      t_vertex to = graph_vertex_from_name(g, name_to);
+      STAT_PHASE_END(GRAPH_PHASE_LOOKUP);
+      if (from >= 0 && to >= 0) {
+        sink(ctx, from, to, w);
+      } else {
+        fprintf(stderr, "Format 2 : arête ignorée, sommets inconnus \"%s\"\n", buf);
+      }
+      STAT_PHASE_BEGIN(GRAPH_PHASE_PARSE);
+    } else {
+      fprintf(stderr, "Format 2 : ligne ignorée car illisible \"%s\"\n", buf);
+    }
+  }
+  STAT_PHASE_END(GRAPH_PHASE_PARSE);
+}
+
+// Chargement en pipeline : un fil lecteur analyse le flux et remplit un anneau
+// de lots d'arêtes (un producteur, un consommateur, sans verrou) pendant que le
+// fil appelant les insère. Le flux est lu séquentiellement : stdin et les tubes
+// conviennent. Messages d'erreur et graphe obtenu sont les mêmes qu'en lecture directe.
+static int pipeline_mode = -1; // -1 : pas encore lu, 0 : direct, 1 : pipeline
+
+void graph_set_pipelined_load(t_bool on) {
+  pipeline_mode = on ? 1 : 0;
+}
+
+static t_bool pipeline_on(void) {
+  if (pipeline_mode < 0) {
+    const char * env = getenv("GRAPH_PIPELINE");
+    pipeline_mode = (env != NULL && env[0] != '\0' && strcmp(env, "0") != 0);
+  }
+  return pipeline_mode;
+}
+
+#ifndef GRAPH_NO_THREADS
+#define PIPE_BATCH 4096 // arêtes par lot
+#define PIPE_SLOTS 64   // lots dans l'anneau (puissance de 2)
+
+// w n'est écrit (et ses pages touchées) que pour un lot ayant un poids différent de 1
+struct edge_batch {
+  int count;
+  t_bool weighted;
+  t_vertex from[PIPE_BATCH];
+  t_vertex to[PIPE_BATCH];
+  float w[PIPE_BATCH];
+};
+
+typedef struct {
+  struct edge_batch * slots;
+  atomic_size_t head;  // lots publiés par le lecteur
+  atomic_size_t tail;  // lots libérés par le constructeur
+  atomic_int done;     // le lecteur a fini (tous les lots sont publiés)
+  struct edge_batch * cur; // lot en cours de remplissage (lecteur seulement)
+  size_t produced;         // copie locale de head (lecteur seulement)
+  // Travail du lecteur
+  FILE * in;
+  const t_graph * g;
+  int format;
+} t_edge_ring;
+
+static void ring_publish(t_edge_ring * r) {
+  r->produced++;
+  atomic_store_explicit(&r->head, r->produced, memory_order_release);
+  r->cur = NULL;
+}
+
+static void sink_ring(void * ctx, t_vertex from, t_vertex to, float w) {
+  t_edge_ring * r = ctx;
+  if (r->cur == NULL) {
+    unsigned spins = 0;
+    while (r->produced - atomic_load_explicit(&r->tail, memory_order_acquire) == PIPE_SLOTS) {
+      spin_pause(&spins);
+    }
+    r->cur = &r->slots[r->produced & (PIPE_SLOTS - 1)];
+    r->cur->count = 0;
+    r->cur->weighted = 0;
+  }
+  if (w != 1.0f && !r->cur->weighted) {
+    for (int i = 0; i < r->cur->count; i++) r->cur->w[i] = 1.0f;
+    r->cur->weighted = 1;
+  }
+  if (r->cur->weighted) r->cur->w[r->cur->count] = w;
+  r->cur->from[r->cur->count] = from;
+  r->cur->to[r->cur->count] = to;
+  if (++r->cur->count == PIPE_BATCH) ring_publish(r);
+}
+
+static void * pipeline_reader(void * arg) {
+  t_edge_ring * r = arg;
+  if (r->format == 1) {
+    format1_scan_edges(r->in, graph_size(r->g), sink_ring, r);
+  } else {
+    format2_scan_edges(r->in, r->g, sink_ring, r);
+  }
+  if (r->cur != NULL) ring_publish(r);
+  atomic_store_explicit(&r->done, 1, memory_order_release);
+  return NULL;
+}
+
+// Lit les arêtes restantes de in vers sink ; retourne 0 si le fil n'a pu être lancé
+static t_bool pipeline_load(FILE * in, const t_graph * g, int format, t_edge_sink sink, void * ctx) {
+  t_edge_ring r;
+  r.slots = malloc(PIPE_SLOTS * sizeof(struct edge_batch));
+  if (r.slots == NULL) return 0;
+  atomic_init(&r.head, 0);
+  atomic_init(&r.tail, 0);
+  atomic_init(&r.done, 0);
+  r.cur = NULL;
+  r.produced = 0;
+  r.in = in;
+  r.g = g;
+  r.format = format;
+
+  pthread_t reader;
+  if (pthread_create(&reader, NULL, pipeline_reader, &r) != 0) {
+    free(r.slots);
+    return 0;
+  }
+
+  // Le lecteur ne touche qu'aux noms de g, sink qu'aux adjacences
+  size_t consumed = 0;
+  unsigned spins = 0;
+  for (;;) {
+    size_t ready = atomic_load_explicit(&r.head, memory_order_acquire);
+    if (consumed == ready) {
+      if (atomic_load_explicit(&r.done, memory_order_acquire)
+          && atomic_load_explicit(&r.head, memory_order_acquire) == consumed) {
+        break;
+      }
+      spin_pause(&spins);
+      continue;
+    }
+    spins = 0;
+    for (; consumed < ready; consumed++) {
+      const struct edge_batch * b = &r.slots[consumed & (PIPE_SLOTS - 1)];
+      for (int i = 0; i < b->count; i++) sink(ctx, b->from[i], b->to[i], b->weighted ? b->w[i] : 1.0f);
+      atomic_store_explicit(&r.tail, consumed + 1, memory_order_release);
+    }
+  }
+
+  pthread_join(reader, NULL);
+  free(r.slots);
+  return 1;
+}
+#else
+static t_bool pipeline_load(FILE * in, const t_graph * g, int format, t_edge_sink sink, void * ctx) {
+  (void)in;
+  (void)g;
+  (void)format;
+  (void)sink;
+  (void)ctx;
+  return 0;
+}
+#endif
+
+// Arêtes restantes de in (format 1 ou 2, noms lus dans g) vers sink
+static void read_edges(FILE * in, const t_graph * g, int format, t_edge_sink sink, void * ctx) {
+  if (pipeline_on() && pipeline_load(in, g, format, sink, ctx)) return;
+  if (format == 1) {
+    format1_scan_edges(in, g->size, sink, ctx);
+  } else {
+    format2_scan_edges(in, g, sink, ctx);
+  }
+}
+
+// Représentation automatique et CSR : les arêtes sont d'abord gardées dans un
+// tableau (8 octets par arête) pour les compter, même sur stdin ou un tube, puis
+// insérées dans la représentation choisie par graph_choose_representation ; le
+// CSR est alors construit en bloc, sans passer par les tampons d'insertion. Les
+// poids n'ont leur tableau (4 octets par arête) qu'à partir du premier différent de 1.
+typedef struct {
+  t_vertex * e;
+  float * w; // NULL tant que tous les poids valent 1
+  size_t len;
+  size_t cap;
+  t_bool ok;
+} t_edge_buf;
+
+static void sink_collect(void * ctx, t_vertex from, t_vertex to, float w) {
+  t_edge_buf * b = ctx;
+  if (!b->ok) return;
+  if (w != 1.0f && b->w == NULL) {
+    b->w = malloc((b->cap > 0 ? b->cap : 1) * sizeof(*(b->w)));
+    if (b->w == NULL) {
+      b->ok = 0;
+      return;
+    }
+    for (size_t i = 0; i < b->len; i++) b->w[i] = 1.0f;
+  }
+  if (b->len == b->cap) {
+    size_t cap = b->cap ? 2 * b->cap : 4096;
+    t_vertex * e = realloc(b->e, 2 * cap * sizeof(t_vertex));
+    if (e == NULL) {
+      b->ok = 0;
+      return;
+    }
+    b->e = e;
+    if (b->w != NULL) {
+      float * bw = realloc(b->w, cap * sizeof(*bw));
+      if (bw == NULL) {
+        b->ok = 0;
+        return;
+      }
+      b->w = bw;
+    }
+    b->cap = cap;
+  }
+  if (b->w != NULL) b->w[b->len] = w;
+  b->e[2 * b->len] = from;
+  b->e[2 * b->len + 1] = to;
+  b->len++;
+}
+
+// Insère les arêtes du tableau dans g (vide), représentation repr (GRAPH_AUTO :
+// selon leur nombre) ; g peut être remplacé, ses noms étant alors partagés.
+// Le nombre d'arêtes étant connu, le budget mémoire est vérifié ici : NULL (g
+// libéré) si même le CSR le dépasse.
+static t_graph * graph_fill(t_graph * g, int repr, const t_edge_buf * b) {
+  if (repr == GRAPH_AUTO) repr = graph_choose_representation(g->size, (long long)b->len);
+  repr = budget_representation("Lecture", repr, g->size, (long long)b->len, graph_has_names(g));
+  if (repr == GRAPH_REPR_INVALID) {
+    graph_free(g);
+    return NULL;
+  }
+  if (repr != g->kind) {
+    t_graph * other = graph_new(g->size, 0, repr);
+    if (other == NULL) {
+      graph_free(g);
+      return NULL;
+    }
+    graph_share_names(other, g, NULL);
+    graph_free(g);
+    g = other;
+  }
+  STAT_PHASE_BEGIN(GRAPH_PHASE_BUILD);
+  if (g->kind == GRAPH_CSR) {
+    csr_build(g->repr.csr, g->size, b->e, b->w, b->len);
+  } else {
+    for (size_t i = 0; i < b->len; i++) {
+      graph_add_weighted_edge(g, b->e[2 * i], b->e[2 * i + 1], b->w != NULL ? b->w[i] : 1.0f);
+    }
+  }
+  STAT_PHASE_END(GRAPH_PHASE_BUILD);
+  return g;
+}
+
+// Lit les arêtes de in dans g (créé en CSR si repr vaut GRAPH_AUTO, et alors
+// éventuellement remplacé) ; retourne le graphe, ou NULL si la mémoire manque
+static t_graph * read_edges_into(FILE * in, t_graph * g, int format, int repr) {
+  if (repr != GRAPH_AUTO && repr != GRAPH_CSR) {
+    read_edges(in, g, format, sink_add_edge, g);
+    return g;
+  }
+
+  t_edge_buf b = { NULL, NULL, 0, 0, 1 };
+  read_edges(in, g, format, sink_collect, &b);
+  if (!b.ok) {
+    fprintf(stderr, "Format %d : mémoire insuffisante pour compter les arêtes\n", format);
+    free(b.e);
+    free(b.w);
+    graph_free(g);
+    return NULL;
+  }
+  g = graph_fill(g, repr, &b);
+  free(b.e);
+  free(b.w);
+  return g;
+}
+
+// Nombre de sommets de la première ligne non vide (format 1 ou 2), 0 si elle
+// manque ou est illisible
+static int read_header_size(FILE * in, int format) {
+  char buf[MAX_READ_LINE];
+  if (!read_line_skip_empty(in, buf, sizeof(buf))) {
+    return 0;
+  }
+
+  int size = 0;
+  char tag = '\0';
+  int read = format == 1 ? sscanf(buf, "%d", &size) : sscanf(buf, "%d %c", &size, &tag);
+  if (read < 1 || size <= 0) {
+    fprintf(stderr, "Format %d : échec de lecture du nombre de sommets\n", format);
+    return 0;
+  }
+  if (read == 2 && tag != 'n') {
+    fprintf(stderr, "Format 2 : le second champ doit être 'n', lu '%c'\n", tag);
+    return 0;
+  }
+  return size;
+}
+
+// Noms des sommets de g (format 2, un par ligne) ; 0 s'il en manque
+static t_bool format2_read_names(FILE * in, t_graph * g) {
+  char buf[MAX_READ_LINE];
+  STAT_PHASE_BEGIN(GRAPH_PHASE_PARSE);
+  for (int i = 0; i < g->size; i++) {
+    if (!read_line_skip_empty(in, buf, sizeof(buf))) {
+      fprintf(stderr, "Format 2 : pas assez de noms de sommets, %d/%d lus\n", i, g->size);
+      STAT_PHASE_END(GRAPH_PHASE_PARSE);
+      return 0;
+    }
+    g->name_off[i] = name_pool_add(g->pool, buf);
+  }
+  // Dictionnaire (si demandé) avant les arêtes, dont les noms y sont cherchés ;
+  // faute de mémoire, la réserve reste en place
+  if (name_dict_on()) graph_compress_names(g);
+  STAT_PHASE_END(GRAPH_PHASE_PARSE);
+  return 1;
+}
+
+// Lecture format 1 (numéros)
+t_graph * graph_read_format1_file(FILE * in, int repr) {
+  if (in == NULL) return NULL;
+  int size = read_header_size(in, 1);
+  if (size == 0) return NULL;
+
+  // Borne basse sans les arêtes : écarte surtout les matrices trop grandes
+  int kind = budget_representation("Format 1", repr == GRAPH_AUTO ? GRAPH_CSR : repr, size, 0, 0);
+  if (kind == GRAPH_REPR_INVALID) return NULL;
+  if (repr != GRAPH_AUTO) repr = kind;
+  t_graph * g = graph_new(size, 0, kind);
+  if (g == NULL) return NULL;
+  return read_edges_into(in, g, 1, repr);
+}
+
+// Lecture format 2 (noms)
+t_graph * graph_read_format2_file(FILE * in, int repr) {
+  if (in == NULL) return NULL;
+  int size = read_header_size(in, 2);
+  if (size == 0) return NULL;
+
+  int kind = budget_representation("Format 2", repr == GRAPH_AUTO ? GRAPH_CSR : repr, size, 0, 1);
+  if (kind == GRAPH_REPR_INVALID) return NULL;
+  if (repr != GRAPH_AUTO) repr = kind;
+  t_graph * g = graph_new(size, 1, kind);
+  if (g == NULL) return NULL;
+  if (!format2_read_names(in, g)) {
+    graph_free(g);
+    return NULL;
+  }
+
+  return read_edges_into(in, g, 2, repr);
+}
+
+// Enveloppe avec nom de fichier
+static t_graph * graph_read_with_file(const char * filename, int repr,
+                                      t_graph * (*reader)(FILE *, int)) {
+  t_graph * g = NULL;
+  if (filename == NULL || strcmp(filename, "-") == 0) {
+    g = reader(stdin, repr);
+  } else {
+    FILE * f = fopen(filename, "r");
+    if (f == NULL) {
+      fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", filename);
+      return NULL;
+    }
+    g = reader(f, repr);
+    fclose(f);
+  }
+  return g;
+}
+
+t_graph * graph_read_format1(const char * filename, int repr) {
+  return graph_read_with_file(filename, repr, graph_read_format1_file);
+}
+
+t_graph * graph_read_format2(const char * filename, int repr) {
+  return graph_read_with_file(filename, repr, graph_read_format2_file);
+}
+
+// Construction concurrente
+// Entre graph_begin_concurrent et graph_end_concurrent, plusieurs fils insèrent
+// dans le même graphe par graph_add_edge_concurrent. Chaque sommet d'origine
+// relève d'un verrou à attente active parmi GRAPH_SHARDS : le test de doublon et
+// l'insertion se font sous ce verrou, la ligne (liste, ligne de matrice ou
+// tampon d'insertion CSR) de u n'étant modifiée que par son détenteur. Le CSR
+// est compacté au début et ne l'est plus jusqu'à la fin, pour que sa partie
+// compacte reste en lecture seule. graph_end_concurrent prend puis rend chaque
+// verrou : toute insertion terminée avant l'appel est alors visible du fil
+// appelant (barrière de publication), et les parcours redeviennent permis.
+// Les tableaux de poids partagés (lignes de la matrice, poids compactés du CSR)
+// sont créés au début plutôt qu'au premier poids, et rendus à la fin s'ils ne
+// servent pas ; une ligne de poids n'est créée que par le détenteur du verrou.
+#define GRAPH_SHARDS 1024
+
+#ifndef GRAPH_NO_THREADS
+struct shard {
+  _Alignas(64) atomic_flag busy; // un verrou par ligne de cache
+};
+
+static void shard_lock(struct shard * s) {
+  unsigned spins = 0;
+  while (atomic_flag_test_and_set_explicit(&s->busy, memory_order_acquire)) spin_pause(&spins);
+}
+
+static void shard_unlock(struct shard * s) {
+  atomic_flag_clear_explicit(&s->busy, memory_order_release);
+}
+
+static size_t locks_bytes(const t_graph * g) {
+  return g->locks != NULL ? GRAPH_SHARDS * sizeof(struct shard) : 0;
+}
+
+void graph_begin_concurrent(t_graph * g) {
+  assert(g != NULL && g->locks == NULL);
+  g->locks = aligned_alloc(_Alignof(struct shard), GRAPH_SHARDS * sizeof(struct shard));
+  assert(g->locks != NULL);
+  for (int i = 0; i < GRAPH_SHARDS; i++) atomic_flag_clear(&g->locks[i].busy);
+  if (g->kind == GRAPH_MATRIX) {
+    matrix_alloc_weight_rows(g);
+  } else if (g->kind == GRAPH_CSR) {
+    struct csr * c = g->repr.csr;
+    csr_compact(c, g->size);
+    csr_alloc_delta(c, g->size);
+    if (c->off[g->size] > 0) csr_weights(c, g->size);
+  }
+}
+
+void graph_add_edge_concurrent(t_graph * g, t_vertex from, t_vertex to) {
+  graph_add_weighted_edge_concurrent(g, from, to, 1.0f);
+}
+
+void graph_add_weighted_edge_concurrent(t_graph * g, t_vertex from, t_vertex to, float w) {
+  assert(g != NULL && g->locks != NULL);
+  assert(from >= 0 && from < g->size);
+  assert(to >= 0 && to < g->size);
+  assert(w >= 0 && w <= FLT_MAX);
+  struct shard * s = &g->locks[from & (GRAPH_SHARDS - 1)];
+  STAT_ADD(dedup_checks, 1);
+  shard_lock(s);
+  if (g->kind == GRAPH_CSR) {
+    csr_put(g->repr.csr, g->size, from, to, w); // ni suppression ni compteur partagé
+  } else {
+    graph_put_edge(g, from, to, w);
+  }
+  shard_unlock(s);
+}
+
+void graph_end_concurrent(t_graph * g) {
+  assert(g != NULL && g->locks != NULL);
+  for (int i = 0; i < GRAPH_SHARDS; i++) {
+    shard_lock(&g->locks[i]);
+    shard_unlock(&g->locks[i]);
+  }
+  free(g->locks);
+  g->locks = NULL;
+  if (g->kind == GRAPH_MATRIX) {
+    t_bool used = 0;
+    for (int u = 0; u < g->size && !used; u++) used = g->mw[u] != NULL;
+    if (!used) matrix_drop_weights(g);
+  } else if (g->kind == GRAPH_CSR) {
+    struct csr * c = g->repr.csr;
+    c->nb_delta = 0;
+    for (int u = 0; u < g->size; u++) c->nb_delta += c->delta[u].len;
+    t_bool used = 0;
+    for (long long i = 0; c->w != NULL && i < c->off[g->size] && !used; i++) used = c->w[i] != 1.0f;
+    if (c->w != NULL && !used) {
+      STAT_BYTES(-(long long)((size_t)c->off[g->size] * sizeof(float)));
+      free(c->w);
+      c->w = NULL;
+    }
+    csr_maybe_compact(c, g->size);
+  }
+}
+#else
+static size_t locks_bytes(const t_graph * g) {
+  (void)g;
+  return 0;
+}
+
+void graph_begin_concurrent(t_graph * g) {
+  (void)g;
+}
+
+void graph_add_edge_concurrent(t_graph * g, t_vertex from, t_vertex to) {
+  graph_add_edge(g, from, to);
+}
+
+void graph_add_weighted_edge_concurrent(t_graph * g, t_vertex from, t_vertex to, float w) {
+  graph_add_weighted_edge(g, from, to, w);
+}
+
+void graph_end_concurrent(t_graph * g) {
+  (void)g;
+}
+#endif
+
+// Lecture de plusieurs fichiers au format 1 en parallèle : chaque fil prend le
+// fichier suivant et l'analyse. Listes et matrice : insertion concurrente dans
+// le graphe ; CSR et GRAPH_AUTO : un tableau d'arêtes par fichier, réunis puis
+// construits en bloc.
+struct ingest_job {
+  t_graph * g;
+  FILE ** in;
+  const int * sizes;
+  int nb_files;
+  t_edge_buf * bufs; // NULL : insertion concurrente
+#ifndef GRAPH_NO_THREADS
+  atomic_int next;
+#else
+  int next;
+#endif
+};
+
+static void sink_add_concurrent(void * ctx, t_vertex from, t_vertex to, float w) {
+  graph_add_weighted_edge_concurrent((t_graph *)ctx, from, to, w);
+}
+
+static void * ingest_worker(void * arg) {
+  struct ingest_job * job = arg;
+  for (;;) {
+#ifndef GRAPH_NO_THREADS
+    int i = atomic_fetch_add(&job->next, 1);
+#else
+    int i = job->next++;
+#endif
+    if (i >= job->nb_files) break;
+    if (job->bufs != NULL) {
+      format1_scan_edges(job->in[i], job->sizes[i], sink_collect, &job->bufs[i]);
+    } else {
+      format1_scan_edges(job->in[i], job->sizes[i], sink_add_concurrent, job->g);
+    }
+  }
+  return NULL;
+}
+
+// Ouvre un fichier au format 1 et lit son nombre de sommets ; NULL si échec
+static FILE * open_format1(const char * filename, int * size) {
+  FILE * f = (filename == NULL || strcmp(filename, "-") == 0) ? stdin : fopen(filename, "r");
+  if (f == NULL) {
+    fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", filename);
+    return NULL;
+  }
+  char buf[MAX_READ_LINE];
+  if (!read_line_skip_empty(f, buf, sizeof(buf)) || sscanf(buf, "%d", size) != 1 || *size <= 0) {
+    fprintf(stderr, "Format 1 : échec de lecture du nombre de sommets\n");
+    if (f != stdin) fclose(f);
+    return NULL;
+  }
+  return f;
+}
+
+t_graph * graph_read_format1_files(const char * const * filenames, int nb_files, int repr, int nb_threads) {
+  assert(filenames != NULL && nb_files > 0);
+  FILE ** in = calloc((size_t)nb_files, sizeof(*in));
+  int * sizes = calloc((size_t)nb_files, sizeof(*sizes));
+  assert(in != NULL && sizes != NULL);
+  int size = 0;
+  t_bool ok = 1;
+  for (int i = 0; i < nb_files && ok; i++) {
+    in[i] = open_format1(filenames[i], &sizes[i]);
+    ok = in[i] != NULL;
+    if (ok && sizes[i] > size) size = sizes[i];
+  }
+
+  t_graph * g = NULL;
+  t_bool bulk = (repr == GRAPH_AUTO || repr == GRAPH_CSR);
+  if (ok) {
+    int kind = budget_representation("Format 1", bulk ? GRAPH_CSR : repr, size, 0, 0);
+    if (kind == GRAPH_CSR && !bulk) {
+      bulk = 1;
+      repr = GRAPH_CSR;
+    }
+    if (kind != GRAPH_REPR_INVALID) g = graph_new(size, 0, kind);
+    ok = g != NULL;
+  }
+  if (ok) {
+    struct ingest_job job;
+    job.g = g;
+    job.in = in;
+    job.sizes = sizes;
+    job.nb_files = nb_files;
+    job.bufs = NULL;
+    if (bulk) {
+      job.bufs = calloc((size_t)nb_files, sizeof(t_edge_buf));
+      assert(job.bufs != NULL);
+      for (int i = 0; i < nb_files; i++) job.bufs[i].ok = 1;
+    } else {
+      graph_begin_concurrent(g);
+    }
+    scan_select_kernels();
+#ifndef GRAPH_NO_THREADS
+    atomic_init(&job.next, 0);
+    if (nb_threads <= 0) nb_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nb_threads > nb_files) nb_threads = nb_files;
+    pthread_t * workers = malloc((size_t)(nb_threads > 1 ? nb_threads : 1) * sizeof(*workers));
+    assert(workers != NULL);
+    int started = 0;
+    while (started + 1 < nb_threads
+           && pthread_create(&workers[started], NULL, ingest_worker, &job) == 0) {
+      started++;
+    }
+    ingest_worker(&job); // le fil appelant travaille aussi
+    for (int t = 0; t < started; t++) pthread_join(workers[t], NULL);
+    free(workers);
+#else
+    (void)nb_threads;
+    job.next = 0;
+    ingest_worker(&job);
+#endif
+
+    if (bulk) {
+      // Réunion des tableaux dans le premier, puis construction en bloc
+      t_edge_buf * all = &job.bufs[0];
+      for (int i = 1; i < nb_files; i++) {
+        for (size_t k = 0; k < job.bufs[i].len && all->ok; k++) {
+          sink_collect(all, job.bufs[i].e[2 * k], job.bufs[i].e[2 * k + 1],
+                       job.bufs[i].w != NULL ? job.bufs[i].w[k] : 1.0f);
+        }
+        all->ok = all->ok && job.bufs[i].ok;
+        free(job.bufs[i].e);
+        free(job.bufs[i].w);
+      }
+      if (all->ok) {
+        g = graph_fill(g, repr, all);
+      } else {
+        fprintf(stderr, "Format 1 : mémoire insuffisante pour les arêtes\n");
+        graph_free(g);
+        g = NULL;
+      }
+      free(all->e);
+      free(all->w);
+      free(job.bufs);
+    } else {
+      graph_end_concurrent(g);
+    }
+  }
+
+  for (int i = 0; i < nb_files; i++) {
+    if (in[i] != NULL && in[i] != stdin) fclose(in[i]);
+  }
+  free(in);
+  free(sizes);
+  return g;
+}
+
+// Format binaire
+t_bool graph_write_binary_header(FILE * out, int size, long long nb_edges) {
+  int32_t n = size;
+  int64_t m = nb_edges;
+  return fwrite(BINARY_MAGIC, 1, 4, out) == 4
+      && fwrite(&n, sizeof(n), 1, out) == 1
+      && fwrite(&m, sizeof(m), 1, out) == 1;
+}
+
+// En-tête binaire : nombre de sommets, 0 s'il est invalide
+static int binary_read_header(FILE * in, int64_t * nb_edges) {
+  char magic[4];
+  int32_t size;
+  if (fread(magic, 1, 4, in) != 4 || memcmp(magic, BINARY_MAGIC, 4) != 0
+      || fread(&size, sizeof(size), 1, in) != 1 || fread(nb_edges, sizeof(*nb_edges), 1, in) != 1
+      || size <= 0 || *nb_edges < 0) {
+    fprintf(stderr, "Binaire : en-tête invalide\n");
+    return 0;
+  }
+  return size;
+}
+
+// Les nb_edges arêtes qui suivent l'en-tête, vers sink
+static void binary_scan_edges(FILE * in, int size, int64_t nb_edges, t_edge_sink sink, void * ctx) {
+  int32_t block[2 * BINARY_BLOCK];
+  int64_t left = nb_edges;
+  while (left > 0) {
+    size_t want = left < BINARY_BLOCK ? (size_t)left : BINARY_BLOCK;
+    size_t got = fread(block, 2 * sizeof(int32_t), want, in);
+    for (size_t i = 0; i < got; i++) {
+      int32_t from = block[2 * i], to = block[2 * i + 1];
+      if (from >= 0 && from < size && to >= 0 && to < size) {
+        sink(ctx, from, to, 1.0f);
+      } else {
+        fprintf(stderr, "Binaire : arête hors limites ignorée (%d, %d)\n", from, to);
+      }
+    }
+    left -= (int64_t)got;
+    if (got < want) {
+      fprintf(stderr, "Binaire : fichier tronqué, %lld arêtes manquantes\n", (long long)left);
+      break;
+    }
+  }
+}
+
+t_graph * graph_read_binary_file(FILE * in, int repr) {
+  if (in == NULL) return NULL;
+  int64_t nb_edges;
+  int size = binary_read_header(in, &nb_edges);
+  if (size == 0) return NULL;
+
+  // L'en-tête donne le nombre d'arêtes : choix automatique immédiat
+  if (repr == GRAPH_AUTO) repr = graph_choose_representation(size, nb_edges);
+  repr = budget_representation("Binaire", repr, size, nb_edges, 0);
+  if (repr == GRAPH_REPR_INVALID) return NULL;
+  t_graph * g = graph_new(size, 0, repr);
+  if (g == NULL) return NULL;
+  t_edge_buf b = { NULL, NULL, 0, 0, 1 };
+  t_edge_sink sink = g->kind == GRAPH_CSR ? sink_collect : sink_add_edge;
+  void * ctx = g->kind == GRAPH_CSR ? (void *)&b : (void *)g;
+  binary_scan_edges(in, size, nb_edges, sink, ctx);
+
+  if (g->kind == GRAPH_CSR) {
+    if (!b.ok) {
+      fprintf(stderr, "Binaire : mémoire insuffisante pour les arêtes\n");
+      free(b.e);
+      graph_free(g);
+      return NULL;
+    }
+    g = graph_fill(g, GRAPH_CSR, &b);
+    free(b.e);
+  }
+  return g;
+}
+
+t_graph * graph_read_binary(const char * filename, int repr) {
+  if (filename == NULL || strcmp(filename, "-") == 0) {
+    return graph_read_binary_file(stdin, repr);
+  }
+  FILE * f = fopen(filename, "rb");
+  if (f == NULL) {
+    fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", filename);
+    return NULL;
+  }
+  t_graph * g = graph_read_binary_file(f, repr);
+  fclose(f);
+  return g;
+}
+
+struct binary_ctx {
+  int32_t * block;
+  size_t used;
+  FILE * out;
+  t_vertex from;
+  t_bool ok;
+};
+
+static void graph_write_binary_cb(t_vertex v, void * ctx) {
+  struct binary_ctx * c = ctx;
+  c->block[2 * c->used] = c->from;
+  c->block[2 * c->used + 1] = v;
+  if (++c->used == BINARY_BLOCK) {
+    c->ok = c->ok && fwrite(c->block, 2 * sizeof(int32_t), c->used, c->out) == c->used;
+    c->used = 0;
+  }
+}
+
+static void graph_count_cb(t_vertex v, void * ctx) {
+  (void)v;
+  (*(long long *)ctx)++;
+}
+
+t_bool graph_write_binary(const t_graph * g, const char * filename) {
+  assert(g != NULL);
+  FILE * out = fopen(filename, "wb");
+  if (out == NULL) {
+    fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", filename);
+    return 0;
+  }
+  long long nb_edges = 0;
+  for (int u = 0; u < g->size; u++) {
+    graph_for_each_succ(g, u, graph_count_cb, &nb_edges);
+  }
+
+  int32_t block[2 * BINARY_BLOCK];
+  struct binary_ctx ctx = { block, 0, out, 0, 1 };
+  ctx.ok = graph_write_binary_header(out, g->size, nb_edges);
+  for (int u = 0; u < g->size && ctx.ok; u++) {
+    ctx.from = u;
+    graph_for_each_succ(g, u, graph_write_binary_cb, &ctx);
+  }
+  if (ctx.used > 0) {
+    ctx.ok = ctx.ok && fwrite(block, 2 * sizeof(int32_t), ctx.used, out) == ctx.used;
+  }
+  if (fclose(out) != 0) ctx.ok = 0;
+  return ctx.ok;
+}
+
+// Mode externe
+// Tri : chaque arête devient une clé (origine << 32 | destination) de 8 octets.
+// Le tampon de mem octets est trié puis écrit dans <edges_path>.run<i> dès qu'il
+// est plein ; les séries sont ensuite fusionnées par groupes d'au plus fan-in,
+// chacune relue par son propre tampon, jusqu'à la dernière fusion qui écrit le
+// fichier GRB1 sans doublon. Un graphe dont les arêtes tiennent dans un seul
+// tampon est écrit directement, sans série.
+#define EXT_HEADER_SIZE 16              // "GRB1", int32, int64
+#define EXT_DEFAULT_MEM (256 << 20)
+#define EXT_MIN_KEYS 1024
+#define EXT_RUN_BUFFER (32 << 10)       // tampon minimal par série fusionnée
+#define EXT_MAX_FANIN 64
+#define EXT_MIN_BLOCK (64 << 10)        // blocs des passes sur les arêtes
+#define EXT_MAX_BLOCK (16 << 20)
+
+typedef struct {
+  const char * path;
+  int size;
+  size_t mem;
+  uint64_t * keys;
+  size_t len;
+  size_t cap;
+  int * runs;        // séries en attente de fusion, des plus anciennes aux plus récentes
+  int first_run;
+  int nb_runs;
+  int runs_cap;
+  int next_run;
+  t_bool ok;
+} t_ext_sort;
+
+static size_t ext_mem(size_t mem) {
+  if (mem > 0) return mem;
+  size_t budget = graph_memory_budget();
+  return budget > 0 ? budget / 2 : EXT_DEFAULT_MEM;
+}
+
+static void ext_run_path(char * buf, size_t len, const char * path, int run) {
+  snprintf(buf, len, "%s.run%d", path, run);
+}
+
+static int cmp_key(const void * a, const void * b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Trie les clés et retire les doublons ; retourne le nombre restant
+static size_t sort_unique_keys(uint64_t * keys, size_t len) {
+  if (len == 0) return 0;
+  qsort(keys, len, sizeof(*keys), cmp_key);
+  size_t n = 1;
+  for (size_t i = 1; i < len; i++) {
+    if (keys[i] != keys[n - 1]) keys[n++] = keys[i];
+  }
+  return n;
+}
+
+// Écriture des clés : brutes dans une série, en paires (from, to) d'int32 dans
+// le fichier final (même taille : la conversion se fait sur place)
+static t_bool ext_write_keys(FILE * out, uint64_t * keys, size_t len, t_bool pairs) {
+  if (pairs) {
+    for (size_t i = 0; i < len; i++) {
+      int32_t e[2] = { (int32_t)(keys[i] >> 32), (int32_t)(uint32_t)keys[i] };
+      memcpy(&keys[i], e, sizeof(e));
+    }
+  }
+  return fwrite(keys, sizeof(*keys), len, out) == len;
+}
+
+static t_bool ext_add_run(t_ext_sort * s, int run) {
+  if (s->first_run + s->nb_runs == s->runs_cap) {
+    int cap = s->runs_cap ? 2 * s->runs_cap : 16;
+    int * runs = realloc(s->runs, (size_t)cap * sizeof(*runs));
+    if (runs == NULL) return 0;
+    s->runs = runs;
+    s->runs_cap = cap;
+  }
+  s->runs[s->first_run + s->nb_runs++] = run;
+  return 1;
+}
+
+// Trie le tampon plein et l'écrit dans une nouvelle série
+static void ext_spill(t_ext_sort * s) {
+  char path[4096];
+  s->len = sort_unique_keys(s->keys, s->len);
+  ext_run_path(path, sizeof(path), s->path, s->next_run);
+  FILE * out = fopen(path, "wb");
+  if (out == NULL) {
+    fprintf(stderr, "Mode externe : impossible de créer la série %s\n", path);
+    s->ok = 0;
+    return;
+  }
+  t_bool ok = ext_write_keys(out, s->keys, s->len, 0);
+  if (fclose(out) != 0 || !ok || !ext_add_run(s, s->next_run)) {
+    fprintf(stderr, "Mode externe : écriture de la série %s impossible\n", path);
+    remove(path);
+    s->ok = 0;
+    return;
+  }
+  s->next_run++;
+  s->len = 0;
+}
+
+static void sink_ext(void * ctx, t_vertex from, t_vertex to, float w) {
+  t_ext_sort * s = ctx;
+  (void)w;
+  if (!s->ok) return;
+  if (s->len == s->cap) {
+    ext_spill(s);
+    if (!s->ok) return;
+  }
+  s->keys[s->len++] = (uint64_t)(uint32_t)from << 32 | (uint32_t)to;
+}
+
+// Série relue pendant une fusion
+typedef struct {
+  FILE * in;
+  uint64_t * buf;
+  size_t len;
+  size_t pos;
+} t_run_in;
+
+static t_bool run_in_next(t_run_in * r, size_t cap) {
+  if (++r->pos < r->len) return 1;
+  r->len = fread(r->buf, sizeof(*(r->buf)), cap, r->in);
+  r->pos = 0;
+  return r->len > 0;
+}
+
+// Tas des séries par clé courante
+static void run_heap_down(t_run_in * r, int * heap, int n, int i) {
+  for (;;) {
+    int m = i, l = 2 * i + 1;
+    if (l < n && r[heap[l]].buf[r[heap[l]].pos] < r[heap[m]].buf[r[heap[m]].pos]) m = l;
+    if (l + 1 < n && r[heap[l + 1]].buf[r[heap[l + 1]].pos] < r[heap[m]].buf[r[heap[m]].pos]) m = l + 1;
+    if (m == i) return;
+    int t = heap[i];
+    heap[i] = heap[m];
+    heap[m] = t;
+    i = m;
+  }
+}
+
+// Fusionne les k plus anciennes séries en attente dans out (paires si final),
+// sans doublon, puis les supprime ; *nb_out reçoit le nombre de clés écrites
+static t_bool ext_merge(t_ext_sort * s, int k, FILE * out, t_bool final, long long * nb_out) {
+  size_t cap = s->mem / (size_t)(k + 1) / sizeof(uint64_t);
+  if (cap < EXT_RUN_BUFFER / sizeof(uint64_t)) cap = EXT_RUN_BUFFER / sizeof(uint64_t);
+  t_run_in * r = calloc((size_t)k, sizeof(*r));
+  int * heap = malloc((size_t)k * sizeof(*heap));
+  uint64_t * obuf = malloc(cap * sizeof(*obuf));
+  t_bool ok = r != NULL && heap != NULL && obuf != NULL;
+  char path[4096];
+  int n = 0;
+  for (int i = 0; i < k && ok; i++) {
+    ext_run_path(path, sizeof(path), s->path, s->runs[s->first_run + i]);
+    r[i].in = fopen(path, "rb");
+    r[i].buf = malloc(cap * sizeof(*(r[i].buf)));
+    ok = r[i].in != NULL && r[i].buf != NULL;
+    if (ok) {
+      r[i].pos = (size_t)-1;
+      if (run_in_next(&r[i], cap)) heap[n++] = i;
+    }
+  }
+  for (int i = n / 2 - 1; i >= 0 && ok; i--) run_heap_down(r, heap, n, i);
+
+  size_t olen = 0;
+  long long total = 0;
+  uint64_t last = 0;
+  while (n > 0 && ok) {
+    t_run_in * top = &r[heap[0]];
+    uint64_t key = top->buf[top->pos];
+    if (total == 0 || key != last) {
+      obuf[olen++] = key;
+      total++;
+      last = key;
+      if (olen == cap) {
+        ok = ext_write_keys(out, obuf, olen, final);
+        olen = 0;
+      }
+    }
+    if (!run_in_next(top, cap)) heap[0] = heap[--n];
+    run_heap_down(r, heap, n, 0);
+  }
+  if (ok && olen > 0) ok = ext_write_keys(out, obuf, olen, final);
+
+  for (int i = 0; i < k; i++) {
+    if (r != NULL && r[i].in != NULL) {
+      if (ferror(r[i].in)) ok = 0;
+      fclose(r[i].in);
+    }
+    if (r != NULL) free(r[i].buf);
+    ext_run_path(path, sizeof(path), s->path, s->runs[s->first_run + i]);
+    remove(path);
+  }
+  s->first_run += k;
+  s->nb_runs -= k;
+  free(r);
+  free(heap);
+  free(obuf);
+  *nb_out = total;
+  return ok;
+}
+
+// Séries restantes vers le fichier des arêtes
+static t_bool ext_finish(t_ext_sort * s) {
+  FILE * out = NULL;
+  long long nb_edges = 0;
+  t_bool ok = 1;
+  if (s->nb_runs == 0) {
+    // Tout tient dans le tampon
+    s->len = sort_unique_keys(s->keys, s->len);
+    nb_edges = (long long)s->len;
+    out = fopen(s->path, "wb");
+    ok = out != NULL && graph_write_binary_header(out, s->size, nb_edges)
+         && ext_write_keys(out, s->keys, s->len, 1);
+  } else {
+    if (s->len > 0) ext_spill(s);
+    free(s->keys);
+    s->keys = NULL;
+    ok = s->ok;
+    size_t fanin = s->mem / EXT_RUN_BUFFER;
+    int max_k = fanin < 3 ? 2 : fanin > EXT_MAX_FANIN + 1 ? EXT_MAX_FANIN : (int)fanin - 1;
+    while (ok && s->nb_runs > max_k) {
+      char path[4096];
+      ext_run_path(path, sizeof(path), s->path, s->next_run);
+      FILE * run = fopen(path, "wb");
+      ok = run != NULL && ext_merge(s, max_k, run, 0, &nb_edges);
+      if (run != NULL && fclose(run) != 0) ok = 0;
+      ok = ok && ext_add_run(s, s->next_run++);
+      if (!ok) remove(path);
+    }
+    out = ok ? fopen(s->path, "wb") : NULL;
+    ok = out != NULL && graph_write_binary_header(out, s->size, 0)
+         && ext_merge(s, s->nb_runs, out, 1, &nb_edges);
+    // Le nombre d'arêtes distinctes n'est connu qu'à la fin de la fusion
+    ok = ok && fseek(out, 0, SEEK_SET) == 0 && graph_write_binary_header(out, s->size, nb_edges);
+  }
+  if (out != NULL && fclose(out) != 0) ok = 0;
+  if (!ok) {
+    fprintf(stderr, "Mode externe : écriture de %s impossible\n", s->path);
+    remove(s->path);
+  }
+  return ok;
+}
+
+t_graph * graph_external_sort(const char * filename, int format, const char * edges_path, size_t mem) {
+  assert(edges_path != NULL && format >= 1 && format <= 3);
+  FILE * in = stdin;
+  if (filename != NULL && strcmp(filename, "-") != 0) {
+    in = fopen(filename, format == 3 ? "rb" : "r");
+    if (in == NULL) {
+      fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", filename);
+      return NULL;
+    }
+  }
+
+  int64_t nb_edges = 0;
+  int size = format == 3 ? binary_read_header(in, &nb_edges) : read_header_size(in, format);
+  t_graph * g = size > 0 ? graph_new(size, format == 2, GRAPH_CSR) : NULL;
+  if (g != NULL && format == 2 && !format2_read_names(in, g)) {
+    graph_free(g);
+    g = NULL;
+  }
+
+  t_ext_sort s = { edges_path, size, ext_mem(mem), NULL, 0, 0, NULL, 0, 0, 0, 0, 1 };
+  s.cap = s.mem / sizeof(uint64_t);
+  if (s.cap < EXT_MIN_KEYS) s.cap = EXT_MIN_KEYS;
+  if (g != NULL) {
+    s.keys = malloc(s.cap * sizeof(*(s.keys)));
+    if (s.keys == NULL) {
+      fprintf(stderr, "Mode externe : mémoire insuffisante pour le tri\n");
+      s.ok = 0;
+    }
+    else if (format == 3) binary_scan_edges(in, size, nb_edges, sink_ext, &s);
+    else read_edges(in, g, format, sink_ext, &s);
+    if (!s.ok || !ext_finish(&s)) {
+      graph_free(g);
+      g = NULL;
+    }
+  }
+  // Séries restantes après un échec
+  for (int i = 0; i < s.nb_runs; i++) {
+    char path[4096];
+    ext_run_path(path, sizeof(path), edges_path, s.runs[s.first_run + i]);
+    remove(path);
+  }
+  free(s.runs);
+  free(s.keys);
+  if (in != stdin) fclose(in);
+  return g;
+}
+
+// CFC semi-externes, par coloration : chaque sommet restant prend pour couleur
+// son numéro, puis le plus grand numéro parmi ceux qui l'atteignent (passes
+// jusqu'à stabilité), ou le plus petit un tour sur deux : une chaîne de CFC
+// numérotée dans un sens ou dans l'autre est ainsi retirée en un ou deux tours.
+// Un sommet qui garde sa couleur est une racine : sa CFC est
+// l'ensemble des sommets de sa couleur qui l'atteignent, trouvés par passes
+// arrière restreintes à la couleur. Ces CFC sont retirées et on recommence avec
+// le reste. Au préalable, des passes d'élagage retirent les sommets sans
+// prédécesseur ou sans successeur restant, CFC à eux seuls ; ensuite, la
+// première passe de chaque tour note aussi les arcs restants et élague de même
+// les sommets devenus sources ou puits. Les passes vont alternativement du
+// début à la fin du fichier et de la fin au début, pour que les couleurs se
+// propagent dans les deux sens des numéros.
+//
+// Chaque tour retire toutes les CFC sources du reste (leur plus grand ou plus
+// petit sommet garde sa couleur) : il y a au plus d tours, d le nombre de CFC du plus long
+// chemin du graphe des CFC, soit O(d) lectures du fichier. Les sommets élagués
+// en cours de tour peuvent laisser leur couleur à d'autres : ces sommets ne sont
+// pas des racines à ce tour, mais aucune fausse racine n'apparaît (les couleurs
+// ne vont que dans un sens), et l'élagage a retiré au moins un sommet.
+enum { EXT_TRIM, EXT_TRIM_COLOR, EXT_COLOR, EXT_BACK };
+#define EXT_VISITED 1
+#define EXT_HAS_IN 2
+#define EXT_HAS_OUT 4
+
+typedef struct {
+  int fd;
+  int32_t * buf;
+  size_t block;        // arêtes par bloc
+  long long nb_edges;
+  int n;
+  int * comp;          // -1 tant que la CFC n'est pas trouvée, puis numéro de sa racine
+  int * color;
+  uint8_t * flags;
+  int passes;          // lectures complètes du fichier
+  t_bool backward;     // sens de la prochaine passe
+  t_bool min_color;    // tour du plus petit numéro
+} t_ext_scc;
+
+static int ext_max_passes = GRAPH_EXTERNAL_MAX_PASSES;
+
+void graph_set_external_max_passes(int max_passes) {
+  ext_max_passes = max_passes;
+}
+
+// Lit le bloc b (arêtes b * block et suivantes) ; retourne son nombre d'arêtes, 0 si échec
+static size_t ext_read_block(t_ext_scc * e, long long b) {
+  long long first = b * (long long)e->block;
+  size_t want = e->nb_edges - first < (long long)e->block ? (size_t)(e->nb_edges - first) : e->block;
+  size_t bytes = want * 2 * sizeof(int32_t), done = 0;
+  off_t off = (off_t)EXT_HEADER_SIZE + (off_t)first * 2 * (off_t)sizeof(int32_t);
+  while (done < bytes) {
+    ssize_t r = pread(e->fd, (char *)e->buf + done, bytes - done, off + (off_t)done);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return 0;
+    done += (size_t)r;
+  }
+  return want;
+}
+
+// Une passe sur toutes les arêtes ; retourne le nombre de sommets modifiés, -1 si la lecture échoue
+static long long ext_pass(t_ext_scc * e, int step, t_bool backward) {
+  long long nb_blocks = (e->nb_edges + (long long)e->block - 1) / (long long)e->block;
+  long long changed = 0;
+  const int * comp = e->comp;
+  int * color = e->color;
+  uint8_t * flags = e->flags;
+  for (long long i = 0; i < nb_blocks; i++) {
+    size_t len = ext_read_block(e, backward ? nb_blocks - 1 - i : i);
+    if (len == 0) return -1;
+    for (size_t j = 0; j < len; j++) {
+      size_t k = backward ? len - 1 - j : j;
+      uint32_t u = (uint32_t)e->buf[2 * k], v = (uint32_t)e->buf[2 * k + 1];
+      if (u >= (uint32_t)e->n || v >= (uint32_t)e->n || comp[u] >= 0 || comp[v] >= 0) continue;
+      switch (step) {
+      case EXT_TRIM:
+      case EXT_TRIM_COLOR:
+        if (u != v) {
+          flags[u] |= EXT_HAS_OUT;
+          flags[v] |= EXT_HAS_IN;
+        }
+        if (step == EXT_TRIM) break;
+        // fallthrough
+      case EXT_COLOR:
+        if (e->min_color ? color[u] < color[v] : color[u] > color[v]) {
+          color[v] = color[u];
+          changed++;
+        }
+        break;
+      default:
+        if (color[u] == color[v] && (flags[v] & EXT_VISITED) && !(flags[u] & EXT_VISITED)) {
+          flags[u] |= EXT_VISITED;
+          changed++;
+        }
+        break;
+      }
+    }
+  }
+  return changed;
+}
+
+// Passe suivante, dans le sens opposé à la précédente ; -1 si la lecture
+// échoue, -2 si le nombre maximal de passes est atteint
+static long long ext_next_pass(t_ext_scc * e, int step) {
+  if (ext_max_passes > 0 && e->passes >= ext_max_passes) return -2;
+  long long changed = ext_pass(e, step, e->backward);
+  e->backward = !e->backward;
+  e->passes++;
+  return changed;
+}
+
+// Après une passe EXT_TRIM ou EXT_TRIM_COLOR : les sommets restants sans arc
+// entrant ou sans arc sortant forment seuls leur CFC. Remet les indicateurs à
+// zéro ; retourne le nombre de sommets retirés.
+static int ext_trim(t_ext_scc * e) {
+  int removed = 0;
+  for (int v = 0; v < e->n; v++) {
+    if (e->comp[v] < 0 && (e->flags[v] & (EXT_HAS_IN | EXT_HAS_OUT)) != (EXT_HAS_IN | EXT_HAS_OUT)) {
+      e->comp[v] = v;
+      removed++;
+    }
+    e->flags[v] = 0;
+  }
+  return removed;
+}
+
+int graph_scc_external(const char * edges_path, int size, int * comp, size_t mem, int * nb_passes) {
+  assert(edges_path != NULL && comp != NULL);
+  t_ext_scc e = { open(edges_path, O_RDONLY), NULL, 0, 0, size, comp, NULL, NULL, 0, 0, 0 };
+  if (e.fd < 0) {
+    fprintf(stderr, "Impossible d'ouvrir le fichier %s\n", edges_path);
+    return -1;
+  }
+  char header[EXT_HEADER_SIZE] = { 0 };
+  int32_t n = 0;
+  int64_t m = -1;
+  if (pread(e.fd, header, sizeof(header), 0) == (ssize_t)sizeof(header)) {
+    memcpy(&n, header + 4, sizeof(n));
+    memcpy(&m, header + 8, sizeof(m));
+  }
+  if (memcmp(header, BINARY_MAGIC, 4) != 0 || n != size || m < 0) {
+    fprintf(stderr, "Mode externe : en-tête de %s invalide ou autre nombre de sommets\n", edges_path);
+    close(e.fd);
+    return -1;
+  }
+  e.nb_edges = m;
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(e.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  size_t bytes = ext_mem(mem);
+  bytes = bytes < EXT_MIN_BLOCK ? EXT_MIN_BLOCK : bytes > EXT_MAX_BLOCK ? EXT_MAX_BLOCK : bytes;
+  e.block = bytes / (2 * sizeof(int32_t));
+  e.buf = malloc(e.block * 2 * sizeof(int32_t));
+  e.color = malloc((size_t)size * sizeof(int));
+  e.flags = calloc((size_t)size, 1);
+  if (e.buf == NULL || e.color == NULL || e.flags == NULL) {
+    fprintf(stderr, "Mode externe : mémoire insuffisante\n");
+    free(e.buf);
+    free(e.color);
+    free(e.flags);
+    close(e.fd);
+    return -1;
+  }
+
+  for (int v = 0; v < size; v++) comp[v] = -1;
+  int left = size;
+  long long r = 0;
+  // Élagage, répété tant qu'il retire au moins 1/16 des sommets restants
+  while (left > 0) {
+    r = ext_next_pass(&e, EXT_TRIM);
+    if (r < 0) break;
+    int removed = ext_trim(&e);
+    left -= removed;
+    if (removed == 0 || removed < left / 16) break;
+  }
+
+  while (left > 0 && r >= 0) {
+    for (int v = 0; v < size; v++) e.color[v] = v;
+    r = ext_next_pass(&e, EXT_TRIM_COLOR);
+    if (r < 0) break;
+    left -= ext_trim(&e);
+    if (left == 0) break;
+    while (r > 0) r = ext_next_pass(&e, EXT_COLOR);
+    if (r < 0) break;
+    for (int v = 0; v < size; v++) e.flags[v] = comp[v] < 0 && e.color[v] == v ? EXT_VISITED : 0;
+    do {
+      r = ext_next_pass(&e, EXT_BACK);
+    } while (r > 0);
+    if (r < 0) break;
+    for (int v = 0; v < size; v++) {
+      if (comp[v] < 0 && (e.flags[v] & EXT_VISITED)) {
+        comp[v] = e.color[v];
+        left--;
+      }
+      e.flags[v] = 0;
+    }
+    e.min_color = !e.min_color;
+  }
+  t_bool ok = r >= 0;
+
+  // Numéros dans l'ordre du plus petit sommet de chaque CFC
+  int nb = 0;
+  if (ok) {
+    for (int v = 0; v < size; v++) e.color[v] = -1;
+    for (int v = 0; v < size; v++) {
+      int root = comp[v];
+      if (e.color[root] < 0) e.color[root] = nb++;
+      comp[v] = e.color[root];
+    }
+  } else if (r == -2) {
+    fprintf(stderr, "Mode externe : arrêt après %d lectures de %s, %d sommets sans CFC "
+            "(graphe des CFC trop profond, voir graph_set_external_max_passes)\n", e.passes, edges_path, left);
+  } else {
+    fprintf(stderr, "Mode externe : lecture de %s impossible\n", edges_path);
+  }
+  if (nb_passes != NULL) *nb_passes = e.passes;
+  free(e.buf);
+  free(e.color);
+  free(e.flags);
+  close(e.fd);
+  return ok ? nb : -1;
 }
@@ -9,27 +9,311 @@ typedef int t_vertex;  // Sommet du graphe
 // Type de graphe opaque
 typedef struct graph t_graph;
 
-// Informations de base
-t_graph * graph_new(int size, t_bool with_names, t_bool use_matrix);
+// Représentation interne (paramètre repr de la création et des lectures)
+#define GRAPH_LIST 0          // listes d'adjacence
+#define GRAPH_MATRIX 1        // matrice d'adjacence
+#define GRAPH_CSR 2           // tableau compact des successeurs (CSR), avec tampons de modifications
+#define GRAPH_AUTO (-1)       // choix selon le nombre de sommets et d'arêtes (listes pour graph_new)
+#define GRAPH_REPR_INVALID (-2)
+
+// Informations de base (graph_new retourne NULL, avec un message, si la mémoire manque)
+t_graph * graph_new(int size, t_bool with_names, int repr);
 void graph_free(t_graph * g);
 int graph_size(const t_graph * g);
 t_bool graph_has_names(const t_graph * g);
 const char * graph_vertex_name(const t_graph * g, t_vertex v);
 t_vertex graph_vertex_from_name(const t_graph * g, const char * name);
+// Copie le nom de v dans buf (cap octets, tronqué et toujours terminé), sans
+// tampon partagé : à utiliser pour garder un nom pendant d'autres appels à
+// graph_vertex_name. Retourne la longueur du nom, -1 sans nom. Un nom lu
+// compte moins de GRAPH_NAME_MAX octets.
+#define GRAPH_NAME_MAX 100
+int graph_vertex_name_copy(const t_graph * g, t_vertex v, char * buf, size_t cap);
+
+// Noms : réserve simple (pointeurs stables), ou dictionnaire compressé — noms
+// triés, codés par préfixe par groupes de 16 avec un point de reprise chacun.
+// graph_compress_names passe g au dictionnaire (retourne 0 sans noms ou faute
+// de mémoire) ; graph_set_name_dict (ou GRAPH_NAME_DICT=1) le fait à chaque
+// lecture au format 2. Avec le dictionnaire, graph_vertex_from_name est une
+// recherche dichotomique, et graph_vertex_name décode dans un tampon du fil
+// appelant, valable jusqu'à son 8e appel suivant dans ce fil : un appelant qui
+// garde un nom pendant d'autres appels le copie (graph_vertex_name_copy).
+// graph_vertices_with_prefix place dans out (graph_size(g) cases, ou NULL pour
+// compter) les sommets dont le nom commence par prefix, par numéro croissant, et
+// retourne leur nombre ; avec le dictionnaire, sans examiner les autres noms.
+t_bool graph_compress_names(t_graph * g);
+void graph_set_name_dict(t_bool on);
+int graph_vertices_with_prefix(const t_graph * g, const char * prefix, t_vertex * out);
+
+// Représentation effective de g, celle que GRAPH_AUTO choisit pour size sommets
+// et nb_edges arêtes (GRAPH_MATRIX ou GRAPH_CSR), et noms "list", "matrix", "csr", "auto"
+int graph_representation(const t_graph * g);
+int graph_choose_representation(int size, long long nb_edges);
+const char * graph_representation_name(int repr);
+int graph_representation_from_name(const char * name); // GRAPH_REPR_INVALID si inconnu
+
+// Mémoire en octets : adjacency pour les arêtes (et leurs poids), index pour les
+// tableaux par sommet (têtes de listes, lignes, positions CSR, suppressions,
+// verrous), names pour la réserve de noms (partagée : comptée par chaque graphe),
+// total y compris la structure elle-même. graph_estimate_memory prévoit la même
+// chose avant création, pour un graphe non pondéré de nb_edges arêtes.
+typedef struct {
+  size_t adjacency;
+  size_t index;
+  size_t names;
+  size_t total;
+} t_graph_memory;
+t_graph_memory graph_memory_usage(const t_graph * g);
+t_graph_memory graph_estimate_memory(int repr, int size, long long nb_edges, t_bool with_names);
+// Budget mémoire des lectures (0 : aucun). Par défaut GRAPH_MEMORY_BUDGET (octets,
+// suffixes k, M, G acceptés), sinon la mémoire physique. Avant de créer le graphe,
+// une lecture dont l'estimation dépasse le budget passe en CSR, ou échoue avec un
+// message si même le CSR ne tient pas. Sans nombre d'arêtes connu d'avance
+// (formats 1 et 2), seule la part par sommet est vérifiée avant la lecture ; le
+// total l'est ensuite pour GRAPH_AUTO et GRAPH_CSR.
+void graph_set_memory_budget(size_t bytes);
+size_t graph_memory_budget(void);
+// Taille en octets avec suffixe k, M ou G facultatif (comme GRAPH_MEMORY_BUDGET) ; -1 si illisible
+long long graph_parse_bytes(const char * s);
 
 // Opérations sur les arêtes
 void graph_add_edge(t_graph * g, t_vertex from, t_vertex to);
 t_bool graph_has_edge(const t_graph * g, t_vertex from, t_vertex to);
+// Arêtes pondérées : graph_add_edge ajoute une arête de poids 1 ; une arête
+// ajoutée plusieurs fois garde son plus petit poids (w >= 0). Les poids ne
+// prennent de place qu'à partir du premier différent de 1 (listes : aucune).
+// graph_edge_weight retourne -1 si l'arête n'existe pas.
+void graph_add_weighted_edge(t_graph * g, t_vertex from, t_vertex to, float w);
+float graph_edge_weight(const t_graph * g, t_vertex from, t_vertex to);
+t_bool graph_is_weighted(const t_graph * g);
+// Retourne 1 si l'arête existait. En CSR, ajouts et suppressions sont notés à
+// part et fusionnés plus tard (automatiquement, ou par graph_compact) ; les
+// parcours voient toujours l'état courant, mais g ne doit pas être modifié
+// pendant un parcours de g.
+t_bool graph_remove_edge(t_graph * g, t_vertex from, t_vertex to);
+void graph_compact(t_graph * g);
 
 // Parcours / graphe transposé
 void graph_for_each_succ(const t_graph * g, t_vertex u, void (*f)(t_vertex v, void * ctx), void * ctx);
+void graph_for_each_succ_weighted(const t_graph * g, t_vertex u,
+                                  void (*f)(t_vertex v, float w, void * ctx), void * ctx);
+// Curseur sur les successeurs de u, sans rappel ni allocation (même ordre que
+// graph_for_each_succ) : un parcours en profondeur peut garder un curseur par
+// sommet de sa pile explicite. Champs internes ; g ne doit pas être modifié
+// pendant l'utilisation d'un curseur. graph_cursor_next place le successeur
+// suivant dans *v, ou retourne 0 quand il n'y en a plus.
+typedef struct {
+  const void * node;
+  int col;
+  long long i;
+} t_graph_cursor;
+void graph_cursor_init(const t_graph * g, t_vertex u, t_graph_cursor * c);
+t_bool graph_cursor_next(const t_graph * g, t_vertex u, t_graph_cursor * c, t_vertex * v);
 t_graph * graph_reverse(const t_graph * g);
 void graph_show(const t_graph * g);
 
-// Lecture de graphe (format 1 : numéros ; format 2 : noms)
-t_graph * graph_read_format1_file(FILE * in, t_bool use_matrix);
-t_graph * graph_read_format2_file(FILE * in, t_bool use_matrix);
-t_graph * graph_read_format1(const char * filename, t_bool use_matrix);
-t_graph * graph_read_format2(const char * filename, t_bool use_matrix);
+// Composantes fortement connexes : comp[v] reçoit le numéro de CFC de v
+// (tableau de graph_size(g) cases) ; retourne le nombre de CFC
+int graph_scc(const t_graph * g, int * comp);
+
+// Élagage des CFC triviales (temps linéaire) : retire de proche en proche les
+// sommets sans arc entrant ou sans arc sortant restant ; rev est le transposé de g.
+// comp[v] reçoit le numéro de la CFC singleton d'un sommet élagué, -1 pour les
+// sommets du cœur, listés par ordre croissant dans core (graph_size(g) cases).
+// Les CFC du cœur, calculées par n'importe quelle méthode (par exemple graph_scc
+// sur graph_induced_subgraph(g, ws, core, nb_core), dont le sommet i est core[i]),
+// sont ensuite placées par graph_trim_merge entre sources et puits : core_comp[i]
+// est la CFC de core[i] parmi nb_core_scc ; retourne le nombre total de CFC.
+typedef struct {
+  int nb_sources;  // élagués faute d'arc entrant : CFC 0 .. nb_sources-1
+  int nb_sinks;    // élagués faute d'arc sortant : CFC suivantes, avant graph_trim_merge
+  int nb_core;     // sommets restants
+} t_trim;
+t_trim graph_trim(const t_graph * g, const t_graph * rev, int * comp, t_vertex * core);
+int graph_trim_merge(const t_trim * t, int * comp, int n, const t_vertex * core,
+                     const int * core_comp, int nb_core_scc);
+
+// Composantes faiblement connexes (sens des arcs ignoré), par union-find
+// parallèle (nb_threads <= 0 : un fil par processeur). comp[v] reçoit le numéro
+// de composante de v, numérotées dans l'ordre de leur plus petit sommet : le
+// résultat ne dépend pas du nombre de fils. sizes (graph_size(g) cases, ou NULL)
+// reçoit la taille de chaque composante ; retourne le nombre de composantes.
+int graph_wcc(const t_graph * g, int * comp, int * sizes, int nb_threads);
+
+// PageRank par tirage sur le transposé rev (graph_reverse(g), ou NULL pour qu'il
+// soit construit et rendu ici), par nb_threads fils (<= 0 : un par processeur)
+// sur des tranches de sommets. rank (graph_size(g) cases) reçoit des rangs de
+// somme 1 ; la masse des sommets sans successeur est répartie sur tous. Arrêt
+// quand la somme des |écarts| entre deux itérations passe sous tolerance.
+// Retourne le nombre d'itérations, ou -1 si tolerance n'est pas atteinte en
+// max_iter itérations (rank reçoit alors la dernière). damping dans [0, 1],
+// souvent 0.85 ; à 1, vecteur propre de la marche aléatoire (centralité).
+// graph_top_k place dans out les k plus grands de score[0..n-1], du plus grand au
+// plus petit (à égalité, le plus petit numéro d'abord), et retourne min(k, n).
+int graph_pagerank(const t_graph * g, const t_graph * rev, double damping, double tolerance,
+                   int max_iter, int nb_threads, double * rank);
+int graph_top_k(const double * score, int n, int k, t_vertex * out);
+
+// Tri topologique (Kahn, O(V + E), sans récursion). Retourne 1 et place dans
+// order (graph_size(g) cases) tous les sommets, chaque arc allant vers l'avant ;
+// sinon retourne 0 et order reçoit un circuit de *len sommets :
+// order[0] -> order[1] -> ... -> order[*len - 1] -> order[0].
+t_bool graph_toposort(const t_graph * g, t_vertex * order, int * len);
+
+// Fermeture transitive : matrice de bits (une ligne de bits par CFC),
+// bitmatrix_get(bm, u, v) vaut 1 s'il existe un chemin non vide de u à v
+typedef struct bitmatrix t_bitmatrix;
+t_bitmatrix * graph_transitive_closure(const t_graph * g);
+t_bool bitmatrix_get(const t_bitmatrix * bm, t_vertex from, t_vertex to);
+int bitmatrix_size(const t_bitmatrix * bm);
+void bitmatrix_free(t_bitmatrix * bm);
+
+// Parcours en largeur depuis plusieurs sources à la fois (64 par passe) :
+// dist[i * graph_size(g) + v] reçoit la distance de sources[i] à v, ou -1
+void graph_ms_bfs(const t_graph * g, const t_vertex * sources, int nb_sources, int * dist);
+
+// Plus court chemin pondéré (Dijkstra avec un tas à base). L'espace de travail,
+// pour des graphes de size sommets, sert à plusieurs requêtes sans remise à zéro
+// (aussi pour graph_khop et graph_induced_subgraph ; un seul fil à la fois).
+// Retourne la longueur du chemin de from à to, ou -1 s'il n'existe pas ; path
+// (graph_size(g) cases, ou NULL) reçoit ses sommets de from à to, *len leur nombre.
+typedef struct path_ws t_path_ws;
+t_path_ws * graph_path_ws_new(int size);
+void graph_path_ws_free(t_path_ws * ws);
+double graph_shortest_path(const t_graph * g, t_path_ws * ws, t_vertex from, t_vertex to,
+                           t_vertex * path, int * len);
+
+// Voisinage de center à au plus hops arcs (parcours en largeur borné) : arcs de
+// g et, si rev (transposé de g) n'est pas NULL, arcs de rev, c'est-à-dire arcs
+// entrants de g. out (graph_size(g) cases) reçoit les sommets atteints dans
+// l'ordre du parcours, center en premier ; retourne leur nombre.
+int graph_khop(const t_graph * g, const t_graph * rev, t_path_ws * ws, t_vertex center, int hops,
+               t_vertex * out);
+// Sous-graphe induit par vertices[0..n-1] (sans répétition) : son sommet i est
+// vertices[i], avec le même nom ; arêtes et poids entre ces sommets, même
+// représentation que g. Le coût dépend de la taille du résultat, pas de g.
+t_graph * graph_induced_subgraph(const t_graph * g, t_path_ws * ws, const t_vertex * vertices, int n);
+
+// Écriture du résultat de graph_scc (comp, nb_comp CFC) par un grand tampon.
+// top > 0 ne garde que les top plus grandes CFC, écrites par taille décroissante ;
+// sinon toutes, dans l'ordre de leur numéro. Retourne 0 si l'écriture échoue.
+typedef enum {
+  GRAPH_SCC_TEXT,   // une CFC par ligne, sommets (noms ou numéros) séparés par un espace
+  GRAPH_SCC_CSV,    // en-tête "vertex,component" puis une ligne par sommet
+  GRAPH_SCC_JSON,   // {"nb_vertices":..,"nb_components":..,"components":[{"id","size","vertices"}]}
+  GRAPH_SCC_BINARY  // graph_size(g) int32 natifs : numéro de CFC du sommet, -1 s'il est écarté par top
+} t_scc_format;
+t_bool graph_write_scc(FILE * out, const t_graph * g, const int * comp, int nb_comp,
+                       t_scc_format format, int top);
+// Histogramme des tailles de CFC par puissances de 2 (nombre de CFC et de sommets par classe)
+t_bool graph_write_scc_histogram(FILE * out, const int * comp, int n, int nb_comp);
+
+// Cache des CFC sur disque, projeté en mémoire (mmap) à la relecture. key identifie
+// l'entrée, en général l'empreinte de graph_file_digest (64 bits, non
+// cryptographique, sur tout le contenu du fichier) mêlée aux options de lecture.
+// graph_scc_cache_save enregistre le résultat de graph_scc pour g : numéros de
+// CFC, graphe des CFC (successeurs distincts et triés de chaque CFC), noms des
+// sommets et, jusqu'à GRAPH_CACHE_CLOSURE_MAX CFC, la fermeture transitive.
+// graph_scc_cache_open retourne NULL si le fichier manque, est abîmé ou porte une
+// autre clé (en-tête, tailles et contenu des sections sont vérifiés à
+// l'ouverture) ; ses tableaux restent valides jusqu'à graph_scc_cache_close.
+#define GRAPH_CACHE_CLOSURE_MAX 4096
+typedef struct scc_cache t_scc_cache;
+t_bool graph_file_digest(const char * filename, unsigned long long * digest);
+t_bool graph_scc_cache_save(const char * path, unsigned long long key, const t_graph * g,
+                            const int * comp, int nb_comp);
+t_scc_cache * graph_scc_cache_open(const char * path, unsigned long long key);
+void graph_scc_cache_close(t_scc_cache * c);
+int graph_scc_cache_size(const t_scc_cache * c);
+int graph_scc_cache_nb_comp(const t_scc_cache * c);
+const int * graph_scc_cache_comp(const t_scc_cache * c);
+const char * graph_scc_cache_name(const t_scc_cache * c, t_vertex v); // NULL sans noms
+int graph_scc_cache_succ(const t_scc_cache * c, int comp, const int ** succ);
+int graph_scc_cache_reaches(const t_scc_cache * c, t_vertex from, t_vertex to); // -1 sans fermeture
+// Comme graph_write_scc, à partir du cache
+t_bool graph_scc_cache_write(FILE * out, const t_scc_cache * c, t_scc_format format, int top);
+
+// Lecture de graphe (format 1 : numéros ; format 2 : noms). Chaque ligne d'arête
+// peut porter un poids en troisième colonne (nombre >= 0, 1 s'il est absent).
+t_graph * graph_read_format1_file(FILE * in, int repr);
+t_graph * graph_read_format2_file(FILE * in, int repr);
+t_graph * graph_read_format1(const char * filename, int repr);
+t_graph * graph_read_format2(const char * filename, int repr);
+
+// Chargement en pipeline des formats 1 et 2 : un fil lit et analyse le flux
+// pendant que le fil appelant insère les arêtes (aussi activé par GRAPH_PIPELINE=1).
+// Sans effet si graph.c est compilé avec -DGRAPH_NO_THREADS.
+void graph_set_pipelined_load(t_bool on);
+
+// Construction concurrente : entre graph_begin_concurrent et graph_end_concurrent,
+// plusieurs fils peuvent appeler graph_add_edge_concurrent sur le même graphe
+// (doublons écartés correctement). Aucune autre opération sur g pendant ce temps ;
+// graph_end_concurrent, appelé quand tous les fils ont fini leurs insertions,
+// publie le graphe complet. graph_read_format1_files lit plusieurs fichiers au
+// format 1 en parallèle (nb_threads <= 0 : un fil par processeur) et en fait
+// l'union ; le nombre de sommets est le plus grand des en-têtes.
+void graph_begin_concurrent(t_graph * g);
+void graph_add_edge_concurrent(t_graph * g, t_vertex from, t_vertex to);
+void graph_add_weighted_edge_concurrent(t_graph * g, t_vertex from, t_vertex to, float w);
+void graph_end_concurrent(t_graph * g);
+t_graph * graph_read_format1_files(const char * const * filenames, int nb_files, int repr, int nb_threads);
+
+// Format binaire (numéros) : "GRB1", nombre de sommets (int32), nombre d'arêtes
+// (int64), puis les arêtes en paires (from, to) d'int32, dans l'ordre natif de la
+// machine. Ce format ne porte pas de poids.
+t_graph * graph_read_binary_file(FILE * in, int repr);
+t_graph * graph_read_binary(const char * filename, int repr);
+t_bool graph_write_binary_header(FILE * out, int size, long long nb_edges);
+t_bool graph_write_binary(const t_graph * g, const char * filename);
+
+// Mode externe, pour les graphes dont les arêtes ne tiennent pas en mémoire.
+// graph_external_sort lit filename (format 1, 2, ou 3 pour le binaire ; NULL ou
+// "-" : stdin) et écrit dans edges_path, au format binaire, ses arêtes distinctes
+// triées par (origine, destination) : séries de mem octets triées en mémoire,
+// écrites à côté (edges_path.run<i>) puis fusionnées. Il retourne un graphe CSR
+// sans arête, qui ne porte que le nombre de sommets et les noms (pour
+// graph_write_scc), ou NULL si la lecture ou l'écriture échoue.
+// graph_scc_external calcule les CFC du fichier edges_path (size sommets) en ne
+// gardant en mémoire que O(size) : deux entiers et un octet par sommet, plus un
+// bloc d'arêtes lu séquentiellement (mem octets, entre 64 Ko et 16 Mo). Même
+// partition que graph_scc, mais les CFC sont numérotées dans l'ordre de leur
+// plus petit sommet. Retourne le nombre de CFC, -1 en cas d'échec ; *nb_passes
+// (si non NULL) reçoit le nombre de lectures complètes du fichier.
+// mem = 0 : la moitié du budget mémoire (256 Mo sans budget).
+// Nombre de lectures : chaque tour de coloration (au moins 3 lectures, plus
+// une par changement de sens des numéros le long d'un chemin) retire toutes les
+// CFC sources restantes ; il y a donc au plus d tours, d le nombre de CFC du plus
+// long chemin du graphe des CFC. Une longue chaîne de CFC non triviales coûte
+// ainsi O(d) lectures du fichier (les CFC triviales sont élaguées à part).
+// Au-delà de max_passes lectures (graph_set_external_max_passes, défaut
+// GRAPH_EXTERNAL_MAX_PASSES, <= 0 : sans limite), graph_scc_external échoue
+// avec un message.
+#define GRAPH_EXTERNAL_MAX_PASSES 1000
+t_graph * graph_external_sort(const char * filename, int format, const char * edges_path, size_t mem);
+int graph_scc_external(const char * edges_path, int size, int * comp, size_t mem, int * nb_passes);
+void graph_set_external_max_passes(int max_passes);
+
+// Instrumentation : compteurs et temps par phase, compilés seulement avec
+// -DGRAPH_STATS et activés à l'exécution par la variable d'environnement
+// GRAPH_STATS=1 ; le résumé est alors affiché sur stderr à la fin du programme.
+// Sans -DGRAPH_STATS, ces appels disparaissent à la compilation.
+typedef enum {
+  GRAPH_PHASE_PARSE,   // lecture des lignes (fgets, sscanf)
+  GRAPH_PHASE_LOOKUP,  // recherche des sommets par leur nom
+  GRAPH_PHASE_BUILD,   // insertion des arêtes
+  GRAPH_PHASE_REVERSE, // graph_reverse
+  GRAPH_PHASE_ALGO,    // algorithme du programme appelant
+  GRAPH_NB_PHASES
+} t_graph_phase;
+
+#ifdef GRAPH_STATS
+void graph_stats_phase_begin(t_graph_phase p);
+void graph_stats_phase_end(t_graph_phase p);
+void graph_stats_report(FILE * out);
+#else
+#define graph_stats_phase_begin(p) ((void)0)
+#define graph_stats_phase_end(p) ((void)0)
+#define graph_stats_report(out) ((void)0)
+#endif
 
 #endif // GRAPH_H
@@ -0,0 +1,185 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "graph.h"
+
+/*
+  Classement des sommets d'un graphe par PageRank
+
+  Le graphe est lu (format 1, 2 ou binaire), son transposé construit une fois,
+  puis graph_pagerank itère en parallèle sur des tranches de sommets jusqu'à ce
+  que la somme des écarts entre deux itérations passe sous le seuil. Les k
+  sommets de plus haut rang sont écrits, avec leur nom au format 2 :
+    <place> <rang> <sommet>
+  Sur stderr : nombre d'itérations, temps, et débit en arcs traités par seconde
+  (nombre d'arcs × itérations / temps du calcul).
+
+  Compilation :
+    gcc -Wall -Wextra -std=c11 -O2 -pthread graph_rank.c graph.c -o graph_rank
+
+  Essai :
+    ./graph_rank -i Fichiers/graphes/noms/GD06-Java.txt -k 10
+*/
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-i <fichier>] [-o <fichier>] [-f 1|2|bin] [-repr list|matrix|csr|auto] [-k n]\n"
+          "          [-d damping] [-tol seuil] [-max-iter n] [-t n]\n"
+          "  -i <fichier> : graphe en entree (defaut: stdin, format 1 ou 2)\n"
+          "  -o <fichier> : classement en sortie (defaut: stdout)\n"
+          "  -f 1|2|bin   : format du graphe (defaut: 1 ou 2 d'apres la premiere ligne)\n"
+          "  -repr <r>    : representation interne (defaut: csr)\n"
+          "  -k n         : nombre de sommets ecrits, 0 pour tous (defaut: 20)\n"
+          "  -d damping   : probabilite de suivre un arc (defaut: 0.85)\n"
+          "  -tol seuil   : arret quand la somme des ecarts passe sous le seuil (defaut: 1e-9)\n"
+          "  -max-iter n  : nombre maximal d'iterations (defaut: 100)\n"
+          "  -t n         : fils de calcul (defaut: un par processeur)\n",
+          prog);
+}
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Format 1 ou 2 d'après la première ligne non vide ; stdin est lu au format 1
+   sauf -f 2 (comme fil_rouge_2) */
+static int detect_format(const char *filename) {
+  if (filename == NULL || strcmp(filename, "-") == 0) return 1;
+  FILE *f = fopen(filename, "r");
+  if (!f) return 1;
+  char line[512];
+  int format = 1;
+  while (fgets(line, (int)sizeof(line), f)) {
+    char *p = line;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (*p == '\0') continue;
+    int n = 0;
+    char tag = '\0';
+    if (sscanf(p, "%d %c", &n, &tag) >= 2 && (tag == 'n' || tag == 'N')) format = 2;
+    break;
+  }
+  fclose(f);
+  return format;
+}
+
+static long long count_edges(const t_graph *g) {
+  long long m = 0;
+  for (t_vertex u = 0; u < graph_size(g); u++) {
+    t_graph_cursor c;
+    t_vertex v;
+    graph_cursor_init(g, u, &c);
+    while (graph_cursor_next(g, u, &c, &v)) m++;
+  }
+  return m;
+}
+
+static int parse_int(const char *s, int *out) {
+  char *end = NULL;
+  long v = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || v < 0 || v > 1000000000L) return 0;
+  *out = (int)v;
+  return 1;
+}
+
+static int parse_double(const char *s, double *out) {
+  char *end = NULL;
+  *out = strtod(s, &end);
+  return end != s && *end == '\0';
+}
+
+int main(int argc, char **argv) {
+  const char *in_path = NULL, *out_path = NULL;
+  int format = 0, repr = GRAPH_CSR;
+  int k = 20, max_iter = 100, nb_threads = 0;
+  double damping = 0.85, tolerance = 1e-9;
+
+  for (int i = 1; i < argc; i++) {
+    int ok = 1;
+    if (!strcmp(argv[i], "-i") && i + 1 < argc) in_path = argv[++i];
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc) out_path = argv[++i];
+    else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      const char *f = argv[++i];
+      if (!strcmp(f, "1")) format = 1;
+      else if (!strcmp(f, "2")) format = 2;
+      else if (!strcmp(f, "bin")) format = 3;
+      else ok = 0;
+    } else if (!strcmp(argv[i], "-repr") && i + 1 < argc) {
+      repr = graph_representation_from_name(argv[++i]);
+      ok = repr != GRAPH_REPR_INVALID;
+    } else if (!strcmp(argv[i], "-k") && i + 1 < argc) ok = parse_int(argv[++i], &k);
+    else if (!strcmp(argv[i], "-max-iter") && i + 1 < argc) ok = parse_int(argv[++i], &max_iter) && max_iter > 0;
+    else if (!strcmp(argv[i], "-t") && i + 1 < argc) ok = parse_int(argv[++i], &nb_threads);
+    else if (!strcmp(argv[i], "-d") && i + 1 < argc) ok = parse_double(argv[++i], &damping) && damping >= 0 && damping <= 1;
+    else if (!strcmp(argv[i], "-tol") && i + 1 < argc) ok = parse_double(argv[++i], &tolerance) && tolerance >= 0;
+    else ok = 0;
+    if (!ok) { usage(argv[0]); return EXIT_FAILURE; }
+  }
+
+  if (format == 0) format = detect_format(in_path);
+  t_graph *g = format == 3 ? graph_read_binary(in_path, repr)
+             : format == 2 ? graph_read_format2(in_path, repr)
+             : graph_read_format1(in_path, repr);
+  if (!g) { fprintf(stderr, "Erreur: lecture du graphe impossible.\n"); return EXIT_FAILURE; }
+  if (repr == GRAPH_AUTO) fprintf(stderr, "Representation choisie : %s\n", graph_representation_name(graph_representation(g)));
+
+  int n = graph_size(g);
+  double *rank = malloc((size_t)(n > 0 ? n : 1) * sizeof(*rank));
+  t_vertex *top = malloc((size_t)(n > 0 ? n : 1) * sizeof(*top));
+  if (!rank || !top) {
+    fprintf(stderr, "Erreur: mémoire insuffisante.\n");
+    free(rank);
+    free(top);
+    graph_free(g);
+    return EXIT_FAILURE;
+  }
+
+  graph_stats_phase_begin(GRAPH_PHASE_REVERSE);
+  t_graph *rev = graph_reverse(g);
+  graph_stats_phase_end(GRAPH_PHASE_REVERSE);
+
+  graph_stats_phase_begin(GRAPH_PHASE_ALGO);
+  double t0 = now_s();
+  int iters = graph_pagerank(g, rev, damping, tolerance, max_iter, nb_threads, rank);
+  double t = now_s() - t0;
+  graph_stats_phase_end(GRAPH_PHASE_ALGO);
+
+  long long m = count_edges(g);
+  int done = iters < 0 ? max_iter : iters;
+  if (iters < 0) fprintf(stderr, "PageRank : seuil non atteint en %d iterations\n", max_iter);
+  else fprintf(stderr, "PageRank : %d iterations\n", iters);
+  fprintf(stderr, "%d sommets, %lld arcs, %.6f s (%.6f s par iteration), %.3g arcs/s\n",
+          n, m, t, done > 0 ? t / done : 0.0, t > 0 ? (double)m * done / t : 0.0);
+
+  FILE *out = stdout;
+  if (out_path && strcmp(out_path, "-") != 0) {
+    out = fopen(out_path, "w");
+    if (!out) {
+      perror(out_path);
+      free(top);
+      free(rank);
+      graph_free(rev);
+      graph_free(g);
+      return EXIT_FAILURE;
+    }
+  }
+  int nb = graph_top_k(rank, n, k > 0 ? k : n, top);
+  for (int i = 0; i < nb; i++) {
+    const char *name = graph_vertex_name(g, top[i]);
+    if (name) fprintf(out, "%d %.9f %s\n", i + 1, rank[top[i]], name);
+    else fprintf(out, "%d %.9f %d\n", i + 1, rank[top[i]], top[i]);
+  }
+
+  if (out != stdout) fclose(out);
+  free(top);
+  free(rank);
+  graph_free(rev);
+  graph_free(g);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,865 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "graph.h"
+
+/*
+  Serveur de requêtes sur un graphe chargé une seule fois (Linux)
+
+  Le graphe est lu au démarrage, ses CFC calculées, puis le serveur répond sur
+  une socket Unix locale à un protocole ligne par ligne (une requête, une ligne
+  de réponse « OK ... », « NONE » ou « ERR ... ») :
+    PATH <s> <t>      : un plus court chemin de s à t et sa longueur (somme des
+                        poids, 1 par arc sans troisième colonne : nombre d'arcs)
+    REACH <s> <t>     : YES si t est accessible depuis s, NO sinon
+    SCC <v>           : numéro de la CFC de v et sa taille
+    NAME <v>          : nom du sommet numéro v
+    ID <nom>          : numéro du sommet nommé
+    RELOAD [<fichier>]: recharge le graphe (par défaut le même fichier)
+    STATS [<requete>] : nombre de requêtes et percentiles de latence
+    QUIT              : ferme la connexion
+  Un sommet est donné par son nom (graphe au format 2) ou par son numéro.
+
+  Architecture :
+    - le fil principal fait tourner une boucle epoll : connexions, lectures,
+      écritures, signaux (signalfd) et fin des requêtes (eventfd) ;
+    - chaque ligne complète part dans une file partagée par un groupe de fils
+      de travail, qui lisent le graphe sans verrou (il n'est jamais modifié) ;
+    - une connexion n'a qu'une requête en cours : les réponses gardent l'ordre
+      des requêtes, et les suivantes attendent dans la socket.
+
+  Rechargement (RELOAD, ou signal SIGHUP) : le nouveau graphe est construit à
+  côté de l'ancien, puis remplace l'instantané courant. Chaque requête garde une
+  référence sur l'instantané qu'elle a pris : l'ancien n'est libéré qu'après la
+  dernière requête en cours.
+
+  Latences : mesurées de la réception de la ligne à la réponse prête (attente
+  dans la file comprise), dans un histogramme logarithmique par type de requête
+  (4 cases par puissance de 2, soit ±10 %). STATS les donne ; elles sont aussi
+  affichées sur stderr à l'arrêt (SIGINT, SIGTERM).
+
+  Compilation :
+    gcc -Wall -Wextra -std=c11 -O2 -pthread graph_server.c graph.c -o graph_server
+
+  Essai :
+    ./graph_server -i Fichiers/graphes/noms/GD06-Java.txt -s /tmp/graphe.sock &
+    echo "PATH java.lang.Object java.lang.String" | nc -U -q1 /tmp/graphe.sock
+*/
+
+#define LINE_MAX_LEN 4096
+#define MAX_EVENTS 64
+#define LAT_SUB 4                   // cases par puissance de 2
+#define LAT_BUCKETS (64 * LAT_SUB)
+#define MAX_WORKERS 1024
+
+/* =========================
+   Requêtes et latences
+   ========================= */
+
+enum { CMD_PATH, CMD_REACH, CMD_SCC, CMD_NAME, CMD_ID, CMD_RELOAD, CMD_STATS, CMD_OTHER, NB_CMDS };
+static const char *CMD_NAMES[NB_CMDS] = { "PATH", "REACH", "SCC", "NAME", "ID", "RELOAD", "STATS", "autres" };
+
+struct latency {
+  atomic_ullong count[LAT_BUCKETS];
+  atomic_ullong total_ns;
+  atomic_ullong max_ns;
+};
+
+static struct latency latencies[NB_CMDS];
+
+/* Case de ns : 4 * partie entière de log2, plus les 2 bits suivants */
+static int lat_bucket(uint64_t ns) {
+  if (ns < LAT_SUB) return (int)ns;
+  int e = 63 - __builtin_clzll(ns);
+  return e * LAT_SUB + (int)((ns >> (e - 2)) & (LAT_SUB - 1));
+}
+
+/* Borne haute (exclue) de la case b, en ns */
+static double lat_bucket_limit(int b) {
+  if (b < LAT_SUB) return b + 1;
+  int e = b / LAT_SUB, sub = b % LAT_SUB;
+  return (double)(1ULL << e) * (1.0 + (sub + 1) / (double)LAT_SUB);
+}
+
+static void lat_record(int cmd, uint64_t ns) {
+  struct latency *l = &latencies[cmd];
+  atomic_fetch_add_explicit(&l->count[lat_bucket(ns)], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&l->total_ns, ns, memory_order_relaxed);
+  unsigned long long m = atomic_load_explicit(&l->max_ns, memory_order_relaxed);
+  while (ns > m && !atomic_compare_exchange_weak_explicit(&l->max_ns, &m, ns, memory_order_relaxed,
+                                                          memory_order_relaxed)) {
+  }
+}
+
+/* Percentiles de la requête cmd (NB_CMDS : toutes) dans buf ; n = 0 si aucune */
+static void lat_format(int cmd, char *buf, size_t cap) {
+  unsigned long long count[LAT_BUCKETS] = { 0 }, n = 0, total = 0, max = 0;
+  for (int c = 0; c < NB_CMDS; c++) {
+    if (cmd != NB_CMDS && c != cmd) continue;
+    for (int b = 0; b < LAT_BUCKETS; b++) {
+      count[b] += atomic_load_explicit(&latencies[c].count[b], memory_order_relaxed);
+    }
+    total += atomic_load_explicit(&latencies[c].total_ns, memory_order_relaxed);
+    unsigned long long m = atomic_load_explicit(&latencies[c].max_ns, memory_order_relaxed);
+    if (m > max) max = m;
+  }
+  for (int b = 0; b < LAT_BUCKETS; b++) n += count[b];
+  if (n == 0) {
+    snprintf(buf, cap, "n=0");
+    return;
+  }
+
+  static const double Q[] = { 0.5, 0.9, 0.99, 0.999 };
+  static const char *Q_NAMES[] = { "p50", "p90", "p99", "p999" };
+  size_t len = (size_t)snprintf(buf, cap, "n=%llu mean=%.1fus", n, total / 1e3 / (double)n);
+  unsigned long long seen = 0;
+  int b = 0;
+  for (int q = 0; q < 4 && len < cap; q++) {
+    unsigned long long rank = (unsigned long long)(Q[q] * (double)n);
+    if (rank >= n) rank = n - 1;
+    while (seen + count[b] <= rank) seen += count[b++];
+    double v = lat_bucket_limit(b);
+    if (v > (double)max) v = (double)max;
+    len += (size_t)snprintf(buf + len, cap - len, " %s=%.1fus", Q_NAMES[q], v / 1e3);
+  }
+  if (len < cap) snprintf(buf + len, cap - len, " max=%.1fus", max / 1e3);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* =========================
+   Instantanés du graphe
+   ========================= */
+
+struct snapshot {
+  t_graph *g;
+  int *comp;            // CFC de chaque sommet
+  int *comp_size;       // taille de chaque CFC
+  int nb_comp;
+  t_vertex *names;      // table de hachage nom -> sommet (-1 : case vide), NULL sans noms
+  size_t names_mask;
+  unsigned gen;         // numéro de chargement
+  char *path;           // fichier lu
+  atomic_int refs;      // le serveur tant qu'il est courant, plus les requêtes en cours
+};
+
+static pthread_mutex_t snap_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct snapshot *current;
+static pthread_mutex_t reload_lock = PTHREAD_MUTEX_INITIALIZER; // un rechargement à la fois
+static unsigned next_gen = 1;
+
+static int server_format = 0;   // 0 : détecté (1 ou 2), 1, 2, 3 (binaire)
+static int server_repr = GRAPH_AUTO;
+
+static uint64_t name_hash(const char *s) {
+  uint64_t h = 1469598103934665603ULL; // FNV-1a
+  for (; *s; s++) h = (h ^ (unsigned char)*s) * 1099511628211ULL;
+  return h;
+}
+
+static t_vertex snapshot_find_name(const struct snapshot *s, const char *name) {
+  if (s->names == NULL) return -1;
+  for (size_t i = name_hash(name) & s->names_mask;; i = (i + 1) & s->names_mask) {
+    t_vertex v = s->names[i];
+    if (v < 0 || strcmp(graph_vertex_name(s->g, v), name) == 0) return v; // noms de la table non NULL
+  }
+}
+
+static void snapshot_free(struct snapshot *s) {
+  graph_free(s->g);
+  free(s->comp);
+  free(s->comp_size);
+  free(s->names);
+  free(s->path);
+  free(s);
+}
+
+static struct snapshot *snapshot_acquire(void) {
+  pthread_mutex_lock(&snap_lock);
+  struct snapshot *s = current;
+  atomic_fetch_add(&s->refs, 1);
+  pthread_mutex_unlock(&snap_lock);
+  return s;
+}
+
+static void snapshot_release(struct snapshot *s) {
+  if (atomic_fetch_sub(&s->refs, 1) == 1) snapshot_free(s);
+}
+
+/* Format 1 ou 2 d'après la première ligne non vide (comme fil_rouge_2) */
+static int detect_format(const char *filename) {
+  FILE *f = fopen(filename, "r");
+  if (!f) return 1;
+  char line[512];
+  int format = 1;
+  while (fgets(line, (int)sizeof(line), f)) {
+    char *p = line;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (*p == '\0') continue;
+    int n = 0;
+    char tag = '\0';
+    if (sscanf(p, "%d %c", &n, &tag) >= 2 && (tag == 'n' || tag == 'N')) format = 2;
+    break;
+  }
+  fclose(f);
+  return format;
+}
+
+/* Lit path et calcule ce que les requêtes utilisent ; NULL (message sur
+   stderr) si la lecture échoue */
+static struct snapshot *snapshot_load(const char *path) {
+  int format = server_format != 0 ? server_format : detect_format(path);
+  t_graph *g = format == 3 ? graph_read_binary(path, server_repr)
+             : format == 2 ? graph_read_format2(path, server_repr)
+             : graph_read_format1(path, server_repr);
+  if (!g) return NULL;
+
+  int n = graph_size(g);
+  struct snapshot *s = calloc(1, sizeof(*s));
+  if (!s) { graph_free(g); return NULL; }
+  s->g = g;
+  s->path = strdup(path);
+  s->comp = malloc((size_t)n * sizeof(*s->comp));
+  s->comp_size = calloc((size_t)n, sizeof(*s->comp_size));
+  if (!s->path || !s->comp || !s->comp_size) { snapshot_free(s); return NULL; }
+  s->nb_comp = graph_scc(g, s->comp);
+  for (int v = 0; v < n; v++) s->comp_size[s->comp[v]]++;
+
+  if (graph_has_names(g)) {
+    size_t cap = 16;
+    while (cap < 2 * (size_t)n) cap *= 2;
+    s->names = malloc(cap * sizeof(*s->names));
+    if (!s->names) { snapshot_free(s); return NULL; }
+    memset(s->names, -1, cap * sizeof(*s->names));
+    s->names_mask = cap - 1;
+    for (t_vertex v = 0; v < n; v++) {
+      // Copie : avec le dictionnaire de noms, graph_vertex_name réutilise ses
+      // tampons, et le sondage ci-dessous l'appelle pour chaque collision
+      char name[GRAPH_NAME_MAX];
+      if (graph_vertex_name_copy(g, v, name, sizeof(name)) < 0) continue;
+      size_t i = name_hash(name) & s->names_mask;
+      while (s->names[i] >= 0 && strcmp(graph_vertex_name(g, s->names[i]), name) != 0) {
+        i = (i + 1) & s->names_mask;
+      }
+      if (s->names[i] < 0) s->names[i] = v; // en cas de doublon, le premier sommet gagne
+    }
+  }
+  atomic_init(&s->refs, 1);
+  return s;
+}
+
+/* Recharge path (NULL : le fichier courant) et remplace l'instantané courant ;
+   les requêtes en cours gardent l'ancien. Retourne le nouvel instantané
+   (référence prise), ou NULL avec la raison dans err. */
+static struct snapshot *reload(const char *path, char *err, size_t cap) {
+  if (pthread_mutex_trylock(&reload_lock) != 0) {
+    snprintf(err, cap, "rechargement deja en cours");
+    return NULL;
+  }
+  char *file = NULL;
+  if (path == NULL) {
+    struct snapshot *old = snapshot_acquire();
+    file = strdup(old->path);
+    snapshot_release(old);
+  } else {
+    file = strdup(path);
+  }
+  uint64_t t0 = now_ns();
+  struct snapshot *s = file ? snapshot_load(file) : NULL;
+  if (!s) {
+    snprintf(err, cap, "lecture de %s impossible", file ? file : "?");
+    free(file);
+    pthread_mutex_unlock(&reload_lock);
+    return NULL;
+  }
+  free(file);
+  s->gen = next_gen++;
+  atomic_fetch_add(&s->refs, 1); // pour l'appelant
+
+  pthread_mutex_lock(&snap_lock);
+  struct snapshot *old = current;
+  current = s;
+  pthread_mutex_unlock(&snap_lock);
+  snapshot_release(old);
+  pthread_mutex_unlock(&reload_lock);
+  fprintf(stderr, "Graphe %u : %s, %d sommets, %d CFC, charge en %.3f s\n", s->gen, s->path,
+          graph_size(s->g), s->nb_comp, (now_ns() - t0) / 1e9);
+  return s;
+}
+
+/* =========================
+   Connexions et files
+   ========================= */
+
+struct conn {
+  int fd;
+  char in[LINE_MAX_LEN];  // octets reçus, pas encore traités
+  size_t in_len;
+  char *out;              // réponse à envoyer
+  size_t out_len, out_pos, out_cap;
+  char line[LINE_MAX_LEN]; // requête confiée aux fils de travail
+  uint64_t t0;             // réception de la requête
+  t_bool busy;             // requête en cours chez les fils de travail
+  t_bool eof;              // le client n'envoie plus rien
+  t_bool quit;             // fermer une fois la réponse envoyée
+  t_bool watched;          // descripteur inscrit dans epoll
+  struct conn *next;       // chaînage dans la file de travail ou des requêtes finies
+};
+
+struct queue {
+  struct conn *head, *tail;
+};
+
+static void queue_push(struct queue *q, struct conn *c) {
+  c->next = NULL;
+  if (q->tail) q->tail->next = c;
+  else q->head = c;
+  q->tail = c;
+}
+
+static struct conn *queue_pop(struct queue *q) {
+  struct conn *c = q->head;
+  if (c) {
+    q->head = c->next;
+    if (!q->head) q->tail = NULL;
+  }
+  return c;
+}
+
+static pthread_mutex_t work_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static struct queue work;
+static t_bool stopping = 0;
+
+static pthread_mutex_t done_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct queue done;
+static int done_fd = -1;  // eventfd : réveille la boucle quand une requête finit
+
+/* Ajoute à la réponse de c (printf) */
+static void conn_printf(struct conn *c, const char *fmt, ...) {
+  for (;;) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = c->out_cap - c->out_len;
+    int k = vsnprintf(c->out + c->out_len, room, fmt, ap);
+    va_end(ap);
+    if (k < 0) return;
+    if ((size_t)k < room) {
+      c->out_len += (size_t)k;
+      return;
+    }
+    size_t cap = c->out_cap * 2 + (size_t)k;
+    char *out = realloc(c->out, cap);
+    if (!out) {
+      // Réponse tronquée plutôt que perdue : on la remplace par une erreur
+      c->out_len = 0;
+      snprintf(c->out, c->out_cap, "ERR memoire insuffisante\n");
+      c->out_len = strlen(c->out);
+      return;
+    }
+    c->out = out;
+    c->out_cap = cap;
+  }
+}
+
+/* =========================
+   Fils de travail
+   ========================= */
+
+struct worker {
+  pthread_t thread;
+  t_path_ws *ws;        // espace des recherches de chemin, pour ws_size sommets
+  int ws_size;
+  t_vertex *path;
+};
+
+/* Sommet donné par son nom ou son numéro ; -1 si inconnu */
+static t_vertex parse_vertex(const struct snapshot *s, const char *tok) {
+  t_vertex v = snapshot_find_name(s, tok);
+  if (v >= 0) return v;
+  char *end;
+  long x = strtol(tok, &end, 10);
+  if (end == tok || *end != '\0' || x < 0 || x >= graph_size(s->g)) return -1;
+  return (t_vertex)x;
+}
+
+static void print_vertex(struct conn *c, const struct snapshot *s, t_vertex v) {
+  const char *name = graph_vertex_name(s->g, v);
+  if (name) conn_printf(c, "%s", name);
+  else conn_printf(c, "%d", v);
+}
+
+static void worker_prepare(struct worker *w, int size) {
+  if (w->ws_size == size) return;
+  graph_path_ws_free(w->ws);
+  free(w->path);
+  w->ws = graph_path_ws_new(size);
+  w->path = malloc((size_t)size * sizeof(*w->path));
+  w->ws_size = w->ws && w->path ? size : 0;
+}
+
+/* Traite la requête de c et écrit sa réponse ; retourne le type de requête */
+static int handle(struct worker *w, struct conn *c) {
+  char *argv[3] = { NULL, NULL, NULL };
+  int argc = 0;
+  char *save = NULL;
+  for (char *p = strtok_r(c->line, " \t", &save); p && argc < 3; p = strtok_r(NULL, " \t", &save)) {
+    argv[argc++] = p;
+  }
+  if (argc == 0) {
+    conn_printf(c, "ERR requete vide\n");
+    return CMD_OTHER;
+  }
+  int cmd = CMD_OTHER;
+  for (int k = 0; k < CMD_OTHER; k++) {
+    if (strcmp(argv[0], CMD_NAMES[k]) == 0) cmd = k;
+  }
+
+  if (cmd == CMD_RELOAD) {
+    char err[256];
+    struct snapshot *s = reload(argv[1], err, sizeof(err));
+    if (!s) conn_printf(c, "ERR %s\n", err);
+    else {
+      conn_printf(c, "OK %u %d sommets %d CFC\n", s->gen, graph_size(s->g), s->nb_comp);
+      snapshot_release(s);
+    }
+    return cmd;
+  }
+  if (cmd == CMD_STATS) {
+    int which = NB_CMDS;
+    if (argc > 1) {
+      for (int k = 0; k < NB_CMDS; k++) {
+        if (strcmp(argv[1], CMD_NAMES[k]) == 0) which = k;
+      }
+      if (which == NB_CMDS) {
+        conn_printf(c, "ERR requete inconnue : %s\n", argv[1]);
+        return cmd;
+      }
+    }
+    char buf[256];
+    lat_format(which, buf, sizeof(buf));
+    conn_printf(c, "OK %s\n", buf);
+    return cmd;
+  }
+  if (cmd == CMD_OTHER) {
+    conn_printf(c, "ERR requete inconnue : %s\n", argv[0]);
+    return cmd;
+  }
+
+  int need = (cmd == CMD_PATH || cmd == CMD_REACH) ? 3 : 2;
+  if (argc != need) {
+    conn_printf(c, "ERR %s attend %d argument%s\n", argv[0], need - 1, need > 2 ? "s" : "");
+    return cmd;
+  }
+
+  struct snapshot *s = snapshot_acquire();
+  if (cmd == CMD_ID) {
+    t_vertex v = snapshot_find_name(s, argv[1]);
+    if (v >= 0) conn_printf(c, "OK %d\n", v);
+    else conn_printf(c, "NONE\n");
+    snapshot_release(s);
+    return cmd;
+  }
+
+  t_vertex u = parse_vertex(s, argv[1]);
+  t_vertex v = need == 3 ? parse_vertex(s, argv[2]) : 0;
+  if (u < 0 || v < 0) {
+    conn_printf(c, "ERR sommet inconnu : %s\n", u < 0 ? argv[1] : argv[2]);
+  } else if (cmd == CMD_NAME) {
+    const char *name = graph_vertex_name(s->g, u);
+    if (name) conn_printf(c, "OK %s\n", name);
+    else conn_printf(c, "NONE\n");
+  } else if (cmd == CMD_SCC) {
+    conn_printf(c, "OK %d %d\n", s->comp[u], s->comp_size[s->comp[u]]);
+  } else if (cmd == CMD_REACH && s->comp[u] == s->comp[v]) {
+    conn_printf(c, "YES\n");
+  } else if (cmd == CMD_REACH && s->comp[u] > s->comp[v]) {
+    // Numéros dans l'ordre topologique du graphe des CFC : pas de retour en arrière
+    conn_printf(c, "NO\n");
+  } else {
+    worker_prepare(w, graph_size(s->g));
+    if (w->ws_size == 0) {
+      conn_printf(c, "ERR memoire insuffisante\n");
+    } else {
+      int len = 0;
+      double d = graph_shortest_path(s->g, w->ws, u, v, cmd == CMD_PATH ? w->path : NULL, &len);
+      if (cmd == CMD_REACH) {
+        conn_printf(c, d >= 0 ? "YES\n" : "NO\n");
+      } else if (d < 0) {
+        conn_printf(c, "NONE\n");
+      } else {
+        conn_printf(c, "OK %g ", d);
+        for (int k = 0; k < len; k++) {
+          if (k > 0) conn_printf(c, " -> ");
+          print_vertex(c, s, w->path[k]);
+        }
+        conn_printf(c, "\n");
+      }
+    }
+  }
+  snapshot_release(s);
+  return cmd;
+}
+
+static void *worker_main(void *arg) {
+  struct worker *w = arg;
+  for (;;) {
+    pthread_mutex_lock(&work_lock);
+    while (!work.head && !stopping) pthread_cond_wait(&work_cond, &work_lock);
+    struct conn *c = queue_pop(&work);
+    pthread_mutex_unlock(&work_lock);
+    if (!c) break;
+
+    int cmd = handle(w, c);
+    lat_record(cmd, now_ns() - c->t0);
+
+    pthread_mutex_lock(&done_lock);
+    queue_push(&done, c);
+    pthread_mutex_unlock(&done_lock);
+    uint64_t one = 1;
+    if (write(done_fd, &one, sizeof(one)) < 0) perror("eventfd");
+  }
+  graph_path_ws_free(w->ws);
+  free(w->path);
+  return NULL;
+}
+
+/* =========================
+   Boucle d'événements
+   ========================= */
+
+static int epfd = -1;
+
+/* Rechargement demandé par SIGHUP : requête interne, sans descripteur */
+static struct conn sighup_conn = { .fd = -1 };
+
+static void conn_close(struct conn *c) {
+  if (c->watched) epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+  close(c->fd);
+  free(c->out);
+  free(c);
+}
+
+/* Écriture s'il reste une réponse à envoyer, lecture si la connexion attend
+   une requête ; pendant une requête (la réponse appartient alors au fil de
+   travail), le descripteur sort d'epoll, sinon une fermeture du client le
+   signalerait en boucle. Les requêtes suivantes attendent dans la socket. */
+static void conn_watch(struct conn *c) {
+  struct epoll_event ev = { 0 };
+  ev.data.ptr = c;
+  if (c->busy) ev.events = 0;
+  else if (c->out_pos < c->out_len) ev.events = EPOLLOUT;
+  else if (!c->busy && !c->eof) ev.events = EPOLLIN;
+  if (ev.events == 0) {
+    if (c->watched) epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    c->watched = 0;
+  } else {
+    epoll_ctl(epfd, c->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, c->fd, &ev);
+    c->watched = 1;
+  }
+}
+
+/* Envoie ce qui peut l'être ; retourne 0 si l'écriture a échoué */
+static t_bool conn_flush(struct conn *c) {
+  while (c->out_pos < c->out_len) {
+    ssize_t k = write(c->fd, c->out + c->out_pos, c->out_len - c->out_pos);
+    if (k < 0 && errno == EINTR) continue;
+    if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+    if (k <= 0) return 0;
+    c->out_pos += (size_t)k;
+  }
+  c->out_pos = c->out_len = 0;
+  return 1;
+}
+
+/* Confie la première ligne complète reçue aux fils de travail ; retourne 0
+   s'il n'y en a pas (ou si c'est QUIT) */
+static t_bool conn_dispatch(struct conn *c) {
+  char *nl = memchr(c->in, '\n', c->in_len);
+  if (!nl) {
+    if (c->in_len < sizeof(c->in)) return 0;
+    conn_printf(c, "ERR ligne trop longue\n");
+    c->quit = 1;
+    return 1;
+  }
+  size_t len = (size_t)(nl - c->in);
+  memcpy(c->line, c->in, len);
+  c->line[len] = '\0';
+  if (len > 0 && c->line[len - 1] == '\r') c->line[len - 1] = '\0';
+  c->in_len -= len + 1;
+  memmove(c->in, nl + 1, c->in_len);
+
+  if (strcmp(c->line, "QUIT") == 0) {
+    c->quit = 1;
+    return 0;
+  }
+  c->t0 = now_ns();
+  c->busy = 1;
+  pthread_mutex_lock(&work_lock);
+  queue_push(&work, c);
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&work_lock);
+  return 1;
+}
+
+/* Fait avancer c : envoi de la réponse, puis requête suivante déjà reçue */
+static void conn_progress(struct conn *c) {
+  while (!c->busy) {
+    if (!conn_flush(c)) { conn_close(c); return; }
+    if (c->out_pos < c->out_len) break;
+    if (c->quit || !conn_dispatch(c)) {
+      if (c->quit || c->eof) { conn_close(c); return; }
+      break;
+    }
+  }
+  conn_watch(c);
+}
+
+static void conn_read(struct conn *c) {
+  while (c->in_len < sizeof(c->in)) {
+    ssize_t k = read(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len);
+    if (k < 0 && errno == EINTR) continue;
+    if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    if (k <= 0) {
+      c->eof = 1; // on répond encore aux lignes complètes déjà reçues
+      break;
+    }
+    c->in_len += (size_t)k;
+  }
+  conn_progress(c);
+}
+
+static void conn_accept(int lfd) {
+  for (;;) {
+    int fd = accept(lfd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept");
+      return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    struct conn *c = calloc(1, sizeof(*c));
+    if (c) {
+      c->fd = fd;
+      c->out_cap = 256;
+      c->out = malloc(c->out_cap);
+    }
+    if (!c || !c->out) {
+      if (c) free(c->out);
+      free(c);
+      close(fd);
+      continue;
+    }
+    conn_watch(c);
+  }
+}
+
+/* Requêtes finies : envoi des réponses, puis requête suivante de chaque connexion */
+static void drain_done(void) {
+  uint64_t k;
+  if (read(done_fd, &k, sizeof(k)) < 0 && errno != EAGAIN) perror("eventfd");
+  pthread_mutex_lock(&done_lock);
+  struct conn *list = done.head;
+  done.head = done.tail = NULL;
+  pthread_mutex_unlock(&done_lock);
+  while (list) {
+    struct conn *c = list;
+    list = c->next;
+    c->busy = 0;
+    if (c == &sighup_conn) {
+      fprintf(stderr, "Rechargement : %.*s", (int)c->out_len, c->out);
+      c->out_len = 0;
+    } else {
+      conn_progress(c);
+    }
+  }
+}
+
+static void sighup_reload(void) {
+  if (sighup_conn.busy) {
+    fprintf(stderr, "Rechargement deja en cours\n");
+    return;
+  }
+  if (!sighup_conn.out) {
+    sighup_conn.out_cap = 256;
+    sighup_conn.out = malloc(sighup_conn.out_cap);
+    if (!sighup_conn.out) return;
+  }
+  strcpy(sighup_conn.in, "RELOAD\n");
+  sighup_conn.in_len = strlen(sighup_conn.in);
+  conn_dispatch(&sighup_conn);
+}
+
+static int parse_int(const char *s, int *out) {
+  char *end = NULL;
+  long v = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || v < 0 || v > 1000000000L) return 0;
+  *out = (int)v;
+  return 1;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s -i <fichier> -s <socket> [-f 1|2|bin] [-repr list|matrix|csr|auto] [-t n]\n"
+          "  -i <fichier> : graphe a servir (rechargeable par RELOAD ou SIGHUP)\n"
+          "  -s <socket>  : chemin de la socket Unix d'ecoute\n"
+          "  -f 1|2|bin   : format du graphe (defaut: 1 ou 2 d'apres la premiere ligne)\n"
+          "  -repr <r>    : representation interne (defaut: auto)\n"
+          "  -t n         : fils de travail, 1 a 1024 (defaut: un par processeur)\n"
+          "Requetes (une par ligne) : PATH s t, REACH s t, SCC v, NAME v, ID nom,\n"
+          "  RELOAD [fichier], STATS [requete], QUIT\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  const char *in_path = NULL, *sock_path = NULL;
+  int nb_threads = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-i") && i + 1 < argc) in_path = argv[++i];
+    else if (!strcmp(argv[i], "-s") && i + 1 < argc) sock_path = argv[++i];
+    else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      if (!parse_int(argv[++i], &nb_threads) || nb_threads < 1 || nb_threads > MAX_WORKERS) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      const char *f = argv[++i];
+      if (!strcmp(f, "1")) server_format = 1;
+      else if (!strcmp(f, "2")) server_format = 2;
+      else if (!strcmp(f, "bin")) server_format = 3;
+      else { usage(argv[0]); return EXIT_FAILURE; }
+    } else if (!strcmp(argv[i], "-repr") && i + 1 < argc) {
+      server_repr = graph_representation_from_name(argv[++i]);
+      if (server_repr == GRAPH_REPR_INVALID) { usage(argv[0]); return EXIT_FAILURE; }
+    } else { usage(argv[0]); return EXIT_FAILURE; }
+  }
+  if (!in_path || !sock_path) { usage(argv[0]); return EXIT_FAILURE; }
+  if (nb_threads <= 0) nb_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nb_threads <= 0) nb_threads = 1;
+
+  uint64_t t0 = now_ns();
+  current = snapshot_load(in_path);
+  if (!current) { fprintf(stderr, "Erreur: lecture du graphe impossible.\n"); return EXIT_FAILURE; }
+  current->gen = next_gen++;
+  fprintf(stderr, "Graphe %u : %s, %d sommets, %d CFC, charge en %.3f s\n", current->gen, in_path,
+          graph_size(current->g), current->nb_comp, (now_ns() - t0) / 1e9);
+
+  // Signaux lus par la boucle (signalfd) plutôt que par des gestionnaires
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGHUP);
+  sigaddset(&mask, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &mask, NULL); // hérité par les fils de travail
+  int sfd = signalfd(-1, &mask, SFD_NONBLOCK);
+
+  struct sockaddr_un addr = { 0 };
+  addr.sun_family = AF_UNIX;
+  if (strlen(sock_path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Chemin de socket trop long : %s\n", sock_path);
+    return EXIT_FAILURE;
+  }
+  strcpy(addr.sun_path, sock_path);
+  int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(sock_path);
+  if (lfd < 0 || bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(lfd, 128) != 0) {
+    perror(sock_path);
+    return EXIT_FAILURE;
+  }
+  fcntl(lfd, F_SETFL, fcntl(lfd, F_GETFL) | O_NONBLOCK);
+
+  done_fd = eventfd(0, EFD_NONBLOCK);
+  epfd = epoll_create1(0);
+  if (sfd < 0 || done_fd < 0 || epfd < 0) {
+    perror("epoll");
+    return EXIT_FAILURE;
+  }
+  // Descripteurs du serveur : data.ptr vers ces repères, les connexions vers leur struct conn
+  static int listen_tag, signal_tag, done_tag;
+  int fds[3] = { lfd, sfd, done_fd };
+  void *tags[3] = { &listen_tag, &signal_tag, &done_tag };
+  for (int k = 0; k < 3; k++) {
+    struct epoll_event ev = { 0 };
+    ev.events = EPOLLIN;
+    ev.data.ptr = tags[k];
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fds[k], &ev);
+  }
+
+  struct worker *workers = calloc((size_t)nb_threads, sizeof(*workers));
+  if (!workers) { perror("calloc"); return EXIT_FAILURE; }
+  int started = 0;
+  while (started < nb_threads && pthread_create(&workers[started].thread, NULL, worker_main, &workers[started]) == 0) {
+    started++;
+  }
+  if (started == 0) { fprintf(stderr, "Aucun fil de travail\n"); return EXIT_FAILURE; }
+  fprintf(stderr, "En ecoute sur %s (%d fils de travail)\n", sock_path, started);
+
+  t_bool run = 1;
+  while (run) {
+    struct epoll_event events[MAX_EVENTS];
+    int nb = epoll_wait(epfd, events, MAX_EVENTS, -1);
+    if (nb < 0 && errno == EINTR) continue;
+    if (nb < 0) { perror("epoll_wait"); break; }
+    for (int e = 0; e < nb; e++) {
+      void *p = events[e].data.ptr;
+      if (p == &listen_tag) {
+        conn_accept(lfd);
+      } else if (p == &done_tag) {
+        drain_done();
+      } else if (p == &signal_tag) {
+        struct signalfd_siginfo si;
+        while (read(sfd, &si, sizeof(si)) == (ssize_t)sizeof(si)) {
+          if (si.ssi_signo == SIGHUP) sighup_reload();
+          else if (si.ssi_signo != SIGPIPE) run = 0;
+        }
+      } else {
+        struct conn *c = p;
+        if (events[e].events & EPOLLOUT) conn_progress(c);
+        else conn_read(c); // EPOLLIN, EPOLLHUP, EPOLLERR : la lecture constate la fin
+      }
+    }
+  }
+
+  // Arrêt : les fils finissent la file, puis bilan des latences
+  pthread_mutex_lock(&work_lock);
+  stopping = 1;
+  pthread_cond_broadcast(&work_cond);
+  pthread_mutex_unlock(&work_lock);
+  for (int t = 0; t < started; t++) pthread_join(workers[t].thread, NULL);
+  free(workers);
+  free(sighup_conn.out);
+
+  for (int cmd = 0; cmd <= NB_CMDS; cmd++) {
+    char buf[256];
+    lat_format(cmd, buf, sizeof(buf));
+    if (strcmp(buf, "n=0") != 0) fprintf(stderr, "%-7s %s\n", cmd == NB_CMDS ? "total" : CMD_NAMES[cmd], buf);
+  }
+  close(lfd);
+  unlink(sock_path);
+  snapshot_release(current);
+  return EXIT_SUCCESS;
+}